@@ -0,0 +1,209 @@
+// ============================================================================
+// Amazon FPGA Hardware Development Kit
+//
+// Copyright 2024 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Amazon Software License (the "License"). You may not use
+// this file except in compliance with the License. A copy of the License is
+// located at
+//
+//    http://aws.amazon.com/asl/
+//
+// or in the "license" file accompanying this file. This file is distributed on
+// an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, express or
+// implied. See the License for the specific language governing permissions and
+// limitations under the License.
+// ============================================================================
+
+//====================================================================================
+// AXI4-Lite performance monitor (simulation only)
+//
+// Passive: every port is an input, so it can be bound to any AXI-Lite slave
+// without touching the design, e.g.
+//
+//   bind cl_top axil_perf_mon #(.NAME("ocl")) ocl_perf_mon (
+//     .clk(clk_main_a0), .rst_n(rst_main_n_sync),
+//     .awvalid(ocl_cl_awvalid), .awready(cl_ocl_awready), ... );
+//
+// Write latency runs from the cycle AWVALID rises to the B handshake, read
+// latency from ARVALID rising to the R handshake. Outstanding transactions
+// are matched in order, so multiple-outstanding masters are handled.
+// Latencies go into power-of-two bins (bin k: 2^k to 2^(k+1)-1 cycles).
+// Stall cycles count VALID high with READY low per channel. Bandwidth is
+// data beats times bytes per beat over the cycles between the first and
+// last handshake, converted to MB/s with the clk period measured between
+// its first two rising edges. The summary is printed from a final block as
+// PERF lines.
+//====================================================================================
+
+module axil_perf_mon
+  #(
+    parameter string NAME = "axil",
+    parameter int DATA_WIDTH = 32,
+    parameter int LAT_BINS = 16
+  )
+  (
+    input logic clk,
+    input logic rst_n,
+
+    input logic awvalid,
+    input logic awready,
+    input logic wvalid,
+    input logic wready,
+    input logic bvalid,
+    input logic bready,
+    input logic arvalid,
+    input logic arready,
+    input logic rvalid,
+    input logic rready
+  );
+
+  typedef struct {
+    longint count;
+    longint sum;
+    longint min;
+    longint max;
+    longint bins [LAT_BINS];
+  } lat_stats_t;
+
+  longint     cycle;
+  longint     first_hs;
+  longint     last_hs;
+  longint     wr_beats;
+  longint     rd_beats;
+  longint     stall_aw, stall_w, stall_b, stall_ar, stall_r;
+  longint     aw_since;
+  longint     ar_since;
+  bit         aw_waiting;
+  bit         ar_waiting;
+  longint     wr_start_q[$];
+  longint     rd_start_q[$];
+  lat_stats_t wr_lat;
+  lat_stats_t rd_lat;
+  realtime    clk_period;   // measured, 0 until clk has toggled twice
+
+  function automatic void lat_init(ref lat_stats_t s);
+    s.count = 0;
+    s.sum = 0;
+    s.min = -1;
+    s.max = 0;
+    foreach (s.bins[i]) s.bins[i] = 0;
+  endfunction
+
+  function automatic int lat_bin(longint v);
+    int b = 0;
+    while (b < LAT_BINS - 1 && v >= (longint'(2) << b))
+      b++;
+    return b;
+  endfunction
+
+  function automatic void lat_add(ref lat_stats_t s, input longint v);
+    s.count++;
+    s.sum += v;
+    if (s.min < 0 || v < s.min) s.min = v;
+    if (v > s.max) s.max = v;
+    s.bins[lat_bin(v)]++;
+  endfunction
+
+  function automatic void hs_seen();
+    if (first_hs < 0) first_hs = cycle;
+    last_hs = cycle;
+  endfunction
+
+  initial begin
+    cycle = 0;
+    first_hs = -1;
+    last_hs = -1;
+    wr_beats = 0;
+    rd_beats = 0;
+    stall_aw = 0; stall_w = 0; stall_b = 0; stall_ar = 0; stall_r = 0;
+    aw_waiting = 0;
+    ar_waiting = 0;
+    lat_init(wr_lat);
+    lat_init(rd_lat);
+  end
+
+  // clk as the bench actually drives it, rather than an assumed frequency
+  initial begin
+    realtime t;
+    clk_period = 0;
+    @(posedge clk);
+    t = $realtime;
+    @(posedge clk);
+    clk_period = $realtime - t;
+  end
+
+  always @(posedge clk) begin
+    if (rst_n) begin
+      // Start of a request: VALID seen without an earlier unaccepted one
+      if (awvalid && !aw_waiting) aw_since = cycle;
+      if (arvalid && !ar_waiting) ar_since = cycle;
+      aw_waiting = awvalid && !awready;
+      ar_waiting = arvalid && !arready;
+
+      if (awvalid && !awready) stall_aw++;
+      if (wvalid && !wready)   stall_w++;
+      if (bvalid && !bready)   stall_b++;
+      if (arvalid && !arready) stall_ar++;
+      if (rvalid && !rready)   stall_r++;
+
+      if (awvalid && awready) begin
+        wr_start_q.push_back(aw_since);
+        hs_seen();
+      end
+      if (wvalid && wready) begin
+        wr_beats++;
+        hs_seen();
+      end
+      if (bvalid && bready && wr_start_q.size() != 0)
+        lat_add(wr_lat, cycle - wr_start_q.pop_front());
+      if (arvalid && arready) begin
+        rd_start_q.push_back(ar_since);
+        hs_seen();
+      end
+      if (rvalid && rready) begin
+        rd_beats++;
+        hs_seen();
+        if (rd_start_q.size() != 0)
+          lat_add(rd_lat, cycle - rd_start_q.pop_front());
+      end
+    end
+    cycle++;
+  end
+
+  function automatic void lat_report(string dir, const ref lat_stats_t s);
+    string bins;
+    if (s.count == 0) begin
+      $display("PERF axil %s %s latency: none", NAME, dir);
+      return;
+    end
+    bins = "";
+    foreach (s.bins[i]) begin
+      if (s.bins[i] == 0)
+        continue;
+      if (i == LAT_BINS - 1)
+        bins = {bins, $sformatf(" %0d+:%0d", 1 << i, s.bins[i])};
+      else
+        bins = {bins, $sformatf(" %0d-%0d:%0d", i == 0 ? 0 : (1 << i), (2 << i) - 1, s.bins[i])};
+    end
+    $display("PERF axil %s %s latency cycles: n=%0d min=%0d mean=%0.2f max=%0d bins%s",
+             NAME, dir, s.count, s.min, real'(s.sum) / s.count, s.max, bins);
+  endfunction
+
+  final begin
+    longint span;
+    real bytes;
+    span = last_hs >= first_hs && first_hs >= 0 ? last_hs - first_hs + 1 : 0;
+    bytes = real'(wr_beats + rd_beats) * (DATA_WIDTH / 8);
+    $display("PERF axil %s summary: %0d writes, %0d reads over %0d cycles", NAME,
+             wr_lat.count, rd_lat.count, span);
+    lat_report("write", wr_lat);
+    lat_report("read", rd_lat);
+    $display("PERF axil %s stall cycles: aw=%0d w=%0d b=%0d ar=%0d r=%0d", NAME,
+             stall_aw, stall_w, stall_b, stall_ar, stall_r);
+    if (span > 0 && clk_period > 0)
+      $display("PERF axil %s bandwidth: %0.4f bytes/cycle = %0.2f MB/s", NAME,
+               bytes / span, bytes / (span * (clk_period / 1ns)) * 1000.0);
+  end
+
+endmodule // axil_perf_mon
@@ -0,0 +1,91 @@
+// ============================================================================
+// Amazon FPGA Hardware Development Kit
+//
+// Copyright 2024 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Amazon Software License (the "License"). You may not use
+// this file except in compliance with the License. A copy of the License is
+// located at
+//
+//    http://aws.amazon.com/asl/
+//
+// or in the "license" file accompanying this file. This file is distributed on
+// an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, express or
+// implied. See the License for the specific language governing permissions and
+// limitations under the License.
+// ============================================================================
+
+//====================================================================================
+// Add-one reference kernel for the cl_top kernel slot
+//
+// Kernel slot contract (every kernel selected by cl_top's KERNEL parameter
+// follows it, so the OCL front end never changes):
+//
+//   s_axis_*  one beat per job: NUM_LANES 32-bit words, lane i in
+//             tdata[32*i +: 32] (input register i). tlast is set on the beat.
+//             tuser carries the job arguments sampled with the inputs:
+//             [31:0] JOB_OPCODE (OCL 0x50), [63:32] JOB_OPERAND (OCL 0x54).
+//             Kernels without arguments ignore it.
+//   m_axis_*  one result beat per job, same packing, written to the output
+//             registers on the handshake. That handshake is the job's done.
+//             tdata must hold the result from the cycle before tvalid
+//             rises: cl_top's reduction and compaction register it then.
+//   kernel_id    [15:0] kernel ID, [31:16] version (OCL 0x48)
+//   kernel_caps  [7:0] lanes, [15:8] cycles from input to result handshake
+//                with no backpressure, [31:16] feature flags (OCL 0x4C)
+//
+// cl_kernel_pipe.sv holds the flow control every kernel shares: one job at
+// a time, with s_axis_tready low from the accepted beat until its result
+// has been taken. Every lane gets +1 on the accepting edge, and the result
+// is presented LATENCY cycles later.
+//====================================================================================
+
+module cl_kernel_add_one
+  #(
+    parameter int NUM_LANES = 8,
+    parameter int LATENCY = 4    // Input handshake to result handshake, >= 2
+  )
+  (
+    input  logic clk,
+    input  logic rst_n,
+
+    input  logic [32*NUM_LANES-1:0] s_axis_tdata,
+    input  logic [63:0]             s_axis_tuser,
+    input  logic                    s_axis_tlast,
+    input  logic                    s_axis_tvalid,
+    output logic                    s_axis_tready,
+
+    output logic [32*NUM_LANES-1:0] m_axis_tdata,
+    output logic                    m_axis_tlast,
+    output logic                    m_axis_tvalid,
+    input  logic                    m_axis_tready,
+
+    output logic [31:0]             kernel_id,
+    output logic [31:0]             kernel_caps
+  );
+
+  localparam logic [15:0] ID = 16'h0001;
+  localparam logic [15:0] VERSION = 16'h0001;
+
+  logic [LATENCY-1:0] stage_v;
+  logic               s_hs;
+
+  assign kernel_id = {VERSION, ID};
+  assign kernel_caps = {16'h0, 8'(LATENCY), 8'(NUM_LANES)};
+
+  cl_kernel_pipe #(.LATENCY(LATENCY)) u_pipe (
+    .clk(clk), .rst_n(rst_n),
+    .s_axis_tlast(s_axis_tlast), .s_axis_tvalid(s_axis_tvalid), .s_axis_tready(s_axis_tready),
+    .m_axis_tlast(m_axis_tlast), .m_axis_tvalid(m_axis_tvalid), .m_axis_tready(m_axis_tready),
+    .s_hs(s_hs), .stage_v(stage_v));
+
+  always_ff @(posedge clk) begin
+    if (!rst_n)
+      m_axis_tdata <= '0;
+    else if (s_hs) begin
+      for (int i = 0; i < NUM_LANES; i++)
+        m_axis_tdata[32*i +: 32] <= s_axis_tdata[32*i +: 32] + 1;
+    end
+  end
+
+endmodule // cl_kernel_add_one
@@ -0,0 +1,162 @@
+// ============================================================================
+// Amazon FPGA Hardware Development Kit
+//
+// Copyright 2024 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Amazon Software License (the "License"). You may not use
+// this file except in compliance with the License. A copy of the License is
+// located at
+//
+//    http://aws.amazon.com/asl/
+//
+// or in the "license" file accompanying this file. This file is distributed on
+// an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, express or
+// implied. See the License for the specific language governing permissions and
+// limitations under the License.
+// ============================================================================
+
+//====================================================================================
+// Opcode-selected ALU kernel for the cl_top kernel slot
+//
+// Applies one operation with a scalar operand K to every lane of the job
+// beat in parallel. The opcode and K arrive on s_axis_tuser (JOB_OPCODE and
+// JOB_OPERAND, see cl_kernel_add_one.sv for the slot contract):
+//
+//   0 add   x + K             5 shl    x << K[4:0]
+//   1 sub   x - K             6 shr    x >> K[4:0] (logical)
+//   2 and   x & K             7 sra    x >>> K[4:0] (arithmetic)
+//   3 or    x | K             8 adds   x + K, unsigned saturating
+//   4 xor   x ^ K             9 addss  x + K, signed saturating
+//
+// Opcodes 10-15 pass the lanes through unchanged. The reset arguments (add,
+// K = 1) make the kernel behave as add-one. cl_top_alu.h is the C reference.
+//
+// Two datapath stages when LATENCY leaves room for them: the accepting edge
+// registers each lane's raw result (the 33-bit sum, a shift or a logic op)
+// with its saturation flag, and the next edge applies the saturation. With
+// LATENCY 2 both happen on the accepting edge. Flow control is
+// cl_kernel_pipe.sv's.
+//====================================================================================
+
+module cl_kernel_alu
+  #(
+    parameter int NUM_LANES = 8,
+    parameter int LATENCY = 4    // Input handshake to result handshake, >= 2
+  )
+  (
+    input  logic clk,
+    input  logic rst_n,
+
+    input  logic [32*NUM_LANES-1:0] s_axis_tdata,
+    input  logic [63:0]             s_axis_tuser,
+    input  logic                    s_axis_tlast,
+    input  logic                    s_axis_tvalid,
+    output logic                    s_axis_tready,
+
+    output logic [32*NUM_LANES-1:0] m_axis_tdata,
+    output logic                    m_axis_tlast,
+    output logic                    m_axis_tvalid,
+    input  logic                    m_axis_tready,
+
+    output logic [31:0]             kernel_id,
+    output logic [31:0]             kernel_caps
+  );
+
+  localparam logic [15:0] ID = 16'h0002;
+  localparam logic [15:0] VERSION = 16'h0001;
+  localparam logic [15:0] FLAGS = 16'h0001;   // Honors the job opcode/operand
+
+  typedef enum logic [3:0] {
+    OP_ADD       = 4'h0,
+    OP_SUB       = 4'h1,
+    OP_AND       = 4'h2,
+    OP_OR        = 4'h3,
+    OP_XOR       = 4'h4,
+    OP_SHL       = 4'h5,
+    OP_SHR       = 4'h6,
+    OP_SRA       = 4'h7,
+    OP_ADD_SAT   = 4'h8,
+    OP_ADD_SAT_S = 4'h9
+  } alu_op_t;
+
+  localparam bit SPLIT = LATENCY > 2;   // room for the saturation stage
+
+  logic [LATENCY-1:0] stage_v;
+  logic               s_hs;
+  logic [3:0]         job_op;
+  logic [31:0]        job_k;
+  logic [3:0]         op_q;
+  logic [33:0]        raw_d [0:NUM_LANES-1];   // {saturate, negative, raw result}
+  logic [33:0]        raw_q [0:NUM_LANES-1];
+  logic [33:0]        raw [0:NUM_LANES-1];     // what the saturation stage sees
+
+  assign kernel_id = {VERSION, ID};
+  assign kernel_caps = {FLAGS, 8'(LATENCY), 8'(NUM_LANES)};
+
+  assign job_op = s_axis_tuser[3:0];
+  assign job_k = s_axis_tuser[63:32];
+
+  cl_kernel_pipe #(.LATENCY(LATENCY)) u_pipe (
+    .clk(clk), .rst_n(rst_n),
+    .s_axis_tlast(s_axis_tlast), .s_axis_tvalid(s_axis_tvalid), .s_axis_tready(s_axis_tready),
+    .m_axis_tlast(m_axis_tlast), .m_axis_tvalid(m_axis_tvalid), .m_axis_tready(m_axis_tready),
+    .s_hs(s_hs), .stage_v(stage_v));
+
+  // Everything but the saturation. Returns {saturate, saturate negative,
+  // result}; the saturating adds return the wrapped sum.
+  function automatic logic [33:0] alu_raw(input logic [3:0] op, input logic [31:0] x,
+                                          input logic [31:0] k);
+    logic [32:0] sum;
+    sum = {1'b0, x} + {1'b0, k};
+    case (op)
+      OP_ADD:     alu_raw = {2'b00, sum[31:0]};
+      OP_SUB:     alu_raw = {2'b00, x - k};
+      OP_AND:     alu_raw = {2'b00, x & k};
+      OP_OR:      alu_raw = {2'b00, x | k};
+      OP_XOR:     alu_raw = {2'b00, x ^ k};
+      OP_SHL:     alu_raw = {2'b00, x << k[4:0]};
+      OP_SHR:     alu_raw = {2'b00, x >> k[4:0]};
+      OP_SRA:     alu_raw = {2'b00, 32'($signed(x) >>> k[4:0])};
+      OP_ADD_SAT: alu_raw = {sum[32], 1'b0, sum[31:0]};
+      // Overflow when both operands share a sign the sum does not
+      OP_ADD_SAT_S: alu_raw = {x[31] == k[31] && sum[31] != x[31], x[31], sum[31:0]};
+      default:    alu_raw = {2'b00, x};
+    endcase
+  endfunction
+
+  function automatic logic [31:0] alu_sat(input logic [3:0] op, input logic [33:0] r);
+    if (!r[33])
+      alu_sat = r[31:0];
+    else if (op == OP_ADD_SAT)
+      alu_sat = 32'hFFFFFFFF;
+    else
+      alu_sat = r[32] ? 32'h80000000 : 32'h7FFFFFFF;
+  endfunction
+
+  always_comb begin
+    for (int i = 0; i < NUM_LANES; i++) begin
+      raw_d[i] = alu_raw(job_op, s_axis_tdata[32*i +: 32], job_k);
+      raw[i] = SPLIT ? raw_q[i] : raw_d[i];
+    end
+  end
+
+  always_ff @(posedge clk) begin
+    if (!rst_n) begin
+      for (int i = 0; i < NUM_LANES; i++)
+        raw_q[i] <= '0;
+      op_q <= 4'h0;
+      m_axis_tdata <= '0;
+    end
+    else begin
+      if (s_hs) begin
+        raw_q <= raw_d;
+        op_q <= job_op;
+      end
+      if (SPLIT ? stage_v[0] : s_hs) begin
+        for (int i = 0; i < NUM_LANES; i++)
+          m_axis_tdata[32*i +: 32] <= alu_sat(SPLIT ? op_q : job_op, raw[i]);
+      end
+    end
+  end
+
+endmodule // cl_kernel_alu
@@ -0,0 +1,75 @@
+// ============================================================================
+// Amazon FPGA Hardware Development Kit
+//
+// Copyright 2024 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Amazon Software License (the "License"). You may not use
+// this file except in compliance with the License. A copy of the License is
+// located at
+//
+//    http://aws.amazon.com/asl/
+//
+// or in the "license" file accompanying this file. This file is distributed on
+// an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, express or
+// implied. See the License for the specific language governing permissions and
+// limitations under the License.
+// ============================================================================
+
+//====================================================================================
+// Flow control shared by the cl_top slot kernels
+//
+// One job in flight: s_axis_tready is low from the accepted beat until its
+// result has been taken, and the result is presented LATENCY cycles after
+// the input handshake, held while m_axis_tready is low. stage_v tracks the
+// job: bit k is set in the (k+1)-th cycle after the input handshake. A
+// kernel registers its datapath stage k on s_hs (k = 0) or stage_v[k-1],
+// and must have the result on m_axis_tdata by stage_v[LATENCY-2], a cycle
+// before it is presented (see cl_kernel_add_one.sv for the slot contract).
+//====================================================================================
+
+module cl_kernel_pipe
+  #(
+    parameter int LATENCY = 4    // Input handshake to result handshake, >= 2
+  )
+  (
+    input  logic               clk,
+    input  logic               rst_n,
+
+    input  logic               s_axis_tlast,
+    input  logic               s_axis_tvalid,
+    output logic               s_axis_tready,
+
+    output logic               m_axis_tlast,
+    output logic               m_axis_tvalid,
+    input  logic               m_axis_tready,
+
+    output logic               s_hs,        // input beat accepted this cycle
+    output logic [LATENCY-1:0] stage_v      // one-hot position of the job in flight
+  );
+
+  generate
+    if (LATENCY < 2) begin : g_latency
+      $error("cl_kernel_pipe: LATENCY must be 2 or more, not %0d", LATENCY);
+    end
+  endgenerate
+
+  assign s_hs = s_axis_tvalid && s_axis_tready;
+  assign s_axis_tready = ~|stage_v;
+  assign m_axis_tvalid = stage_v[LATENCY-1];
+
+  always_ff @(posedge clk) begin
+    if (!rst_n) begin
+      stage_v <= '0;
+      m_axis_tlast <= 1'b0;
+    end
+    else begin
+      // Hold the result until the front end takes it
+      if (!(m_axis_tvalid && !m_axis_tready))
+        stage_v <= (stage_v << 1) | LATENCY'(s_hs);
+
+      if (s_hs)
+        m_axis_tlast <= s_axis_tlast;
+    end
+  end
+
+endmodule // cl_kernel_pipe
@@ -0,0 +1,166 @@
+// ============================================================================
+// Amazon FPGA Hardware Development Kit
+//
+// Copyright 2024 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Amazon Software License (the "License"). You may not use
+// this file except in compliance with the License. A copy of the License is
+// located at
+//
+//    http://aws.amazon.com/asl/
+//
+// or in the "license" file accompanying this file. This file is distributed on
+// an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, express or
+// implied. See the License for the specific language governing permissions and
+// limitations under the License.
+// ============================================================================
+
+//====================================================================================
+// Streaming prefix-sum (scan) kernel for the cl_top kernel slot
+//
+// Each job beat is scanned, all lanes at once, and offset by a carry the
+// kernel keeps from one job to the next, so consecutive jobs scan one array
+// of any length, 8 words per job:
+//
+//   inclusive  y[i] = carry + x[0] + ... + x[i]
+//   exclusive  y[i] = carry + x[0] + ... + x[i-1]
+//
+// after which the carry becomes carry + x[0] + ... + x[7]. JOB_OPCODE bit 0
+// selects exclusive; bit 1 loads the carry from JOB_OPERAND before the job,
+// starting a new array or resuming one from a carry the host kept. The
+// carry is 0 out of reset. Sums wrap modulo 2^32; a batch shorter than 8
+// words is padded with zeros, which leaves the carry unchanged.
+// cl_top_scan.h is the C reference.
+//
+// The scan is log2(NUM_LANES) adder levels plus the carry add, spread over
+// up to LATENCY-1 register stages so the result settles a cycle before it
+// is presented (4 levels in 3 stages at the default LATENCY). The carry
+// moves on in the last stage; the next job cannot be accepted before then.
+// Flow control is cl_kernel_pipe.sv's (see cl_kernel_add_one.sv for the
+// slot contract).
+//====================================================================================
+
+module cl_kernel_scan
+  #(
+    parameter int NUM_LANES = 8,
+    parameter int LATENCY = 4    // Input handshake to result handshake, >= 2
+  )
+  (
+    input  logic clk,
+    input  logic rst_n,
+
+    input  logic [32*NUM_LANES-1:0] s_axis_tdata,
+    input  logic [63:0]             s_axis_tuser,
+    input  logic                    s_axis_tlast,
+    input  logic                    s_axis_tvalid,
+    output logic                    s_axis_tready,
+
+    output logic [32*NUM_LANES-1:0] m_axis_tdata,
+    output logic                    m_axis_tlast,
+    output logic                    m_axis_tvalid,
+    input  logic                    m_axis_tready,
+
+    output logic [31:0]             kernel_id,
+    output logic [31:0]             kernel_caps
+  );
+
+  localparam logic [15:0] ID = 16'h0003;
+  localparam logic [15:0] VERSION = 16'h0001;
+  localparam logic [15:0] FLAGS = 16'h0002;   // Scan: carry across jobs
+
+  localparam int LEVELS = $clog2(NUM_LANES) + 1;   // adder levels, then the carry
+  localparam int STAGES = (LATENCY - 1 < LEVELS) ? LATENCY - 1 : LEVELS;
+
+  logic [LATENCY-1:0]      stage_v;
+  logic [LATENCY:0]        stage_en;   // stage k registers on stage_en[k]
+  logic                    s_hs;
+  logic                    job_exclusive;
+  logic                    job_load;
+  logic [31:0]             carry;
+  logic [31:0]             carry_in;
+  // Per stage: the lanes (partial prefix sums, the result after the last
+  // stage), the carry the job started from, and exclusive
+  logic [32*NUM_LANES-1:0] lane_d [0:STAGES-1];
+  logic [32*NUM_LANES-1:0] lane_q [0:STAGES-1];
+  logic [31:0]             base_d [0:STAGES-1];
+  logic [31:0]             base_q [0:STAGES-1];
+  logic                    excl_d [0:STAGES-1];
+  logic                    excl_q [0:STAGES-1];
+  logic [31:0]             total;      // carry after the job
+
+  assign kernel_id = {VERSION, ID};
+  assign kernel_caps = {FLAGS, 8'(LATENCY), 8'(NUM_LANES)};
+
+  assign job_exclusive = s_axis_tuser[0];
+  assign job_load = s_axis_tuser[1];
+  assign carry_in = job_load ? s_axis_tuser[63:32] : carry;
+
+  cl_kernel_pipe #(.LATENCY(LATENCY)) u_pipe (
+    .clk(clk), .rst_n(rst_n),
+    .s_axis_tlast(s_axis_tlast), .s_axis_tvalid(s_axis_tvalid), .s_axis_tready(s_axis_tready),
+    .m_axis_tlast(m_axis_tlast), .m_axis_tvalid(m_axis_tvalid), .m_axis_tready(m_axis_tready),
+    .s_hs(s_hs), .stage_v(stage_v));
+
+  assign stage_en = {stage_v, s_hs};
+  assign m_axis_tdata = lane_q[STAGES-1];
+
+  // One Hillis-Steele level: lane i adds lane i - d
+  function automatic logic [32*NUM_LANES-1:0] scan_level(input logic [32*NUM_LANES-1:0] v,
+                                                         input int d);
+    scan_level = v;
+    for (int i = d; i < NUM_LANES; i++)
+      scan_level[32*i +: 32] = v[32*i +: 32] + v[32*(i-d) +: 32];
+  endfunction
+
+  // Adder level l runs in stage l * STAGES / LEVELS; the carry add, level
+  // LEVELS - 1, always lands in the last stage. The exclusive prefix is the
+  // inclusive one of the lane below.
+  always_comb begin
+    total = 32'h0;
+    for (int k = 0; k < STAGES; k++) begin
+      if (k == 0) begin
+        lane_d[k] = s_axis_tdata;
+        base_d[k] = carry_in;
+        excl_d[k] = job_exclusive;
+      end
+      else begin
+        lane_d[k] = lane_q[k-1];
+        base_d[k] = base_q[k-1];
+        excl_d[k] = excl_q[k-1];
+      end
+      for (int l = 0; l < LEVELS - 1; l++) begin
+        if (l * STAGES / LEVELS == k)
+          lane_d[k] = scan_level(lane_d[k], 1 << l);
+      end
+      if (k == STAGES - 1) begin
+        total = base_d[k] + lane_d[k][32*(NUM_LANES-1) +: 32];
+        for (int i = NUM_LANES - 1; i >= 0; i--)
+          lane_d[k][32*i +: 32] = base_d[k] + (!excl_d[k] ? lane_d[k][32*i +: 32] :
+                                               i == 0 ? 32'h0 : lane_d[k][32*(i-1) +: 32]);
+      end
+    end
+  end
+
+  always_ff @(posedge clk) begin
+    if (!rst_n) begin
+      for (int k = 0; k < STAGES; k++) begin
+        lane_q[k] <= '0;
+        base_q[k] <= 32'h0;
+        excl_q[k] <= 1'b0;
+      end
+      carry <= 32'h0;
+    end
+    else begin
+      for (int k = 0; k < STAGES; k++) begin
+        if (stage_en[k]) begin
+          lane_q[k] <= lane_d[k];
+          base_q[k] <= base_d[k];
+          excl_q[k] <= excl_d[k];
+        end
+      end
+      if (stage_en[STAGES-1])
+        carry <= total;
+    end
+  end
+
+endmodule // cl_kernel_scan
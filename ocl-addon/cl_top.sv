@@ -22,7 +22,8 @@
 module cl_top
     #(
       parameter EN_DDR = 0,
-      parameter EN_HBM = 0
+      parameter EN_HBM = 0,
+      parameter KERNEL = 2    // Kernel in the compute slot, by kernel ID (1: add-one, 2: ALU)
     )
     (
       `include "cl_ports.vh"
@@ -30,6 +31,7 @@ module cl_top
 
 `include "cl_id_defines.vh" // CL ID defines required for all examples
 `include "cl_top_defines.vh"
+`include "cl_top_log.svh"
 
 //=============================================================================
 // GLOBALS
@@ -38,11 +40,10 @@ module cl_top
   logic rst_main_n_sync;  
   logic pre_sync_rst_n;
 
+  `CL_LOG_INIT
+
   always_comb begin
      cl_sh_flr_done    = 'b1;
-     cl_sh_status0     = 'b0;
-     cl_sh_status1     = 'b0;
-     cl_sh_status2     = 'b0;
      cl_sh_id0         = `CL_SH_ID0;
      cl_sh_id1         = `CL_SH_ID1;
      cl_sh_status_vled = 'b0;
@@ -140,34 +141,231 @@ always @(posedge clk_main_a0)
 // OCL - Simple Add-One Implementation
 //=============================================================================
 
-  localparam ADDR_WIDTH = 8;
+  localparam ADDR_WIDTH = 12;
   localparam NUM_REGS = 8;  // Simple: 8 input + 8 output registers
+  localparam HIST_BINS = 16; // Power-of-two latency bins
+  localparam TRACE_DEPTH = 1024;  // OCL trace buffer entries
+  localparam TRACE_PTR_W = $clog2(TRACE_DEPTH);
+
+  // Kernel IDs for the KERNEL parameter
+  localparam KERNEL_ADD_ONE = 1;
+  localparam KERNEL_ALU = 2;
+  localparam KERNEL_SCAN = 3;
+  localparam KERNEL_LATENCY = 4;  // Kernel input to result handshake (cl_top_model.h assumes 4)
   
   // Register map for Simple Add-One
   // 0x00-0x1C: Input data registers (8 × 32-bit)
   // 0x20-0x3C: Output data registers (8 × 32-bit)
   // 0x40: Control register (bit 0: start)
   // 0x44: Status register (bit 0: done)
+  // 0x48: Kernel ID (RO: [15:0] ID, [31:16] version)
+  // 0x4C: Kernel capabilities (RO: [7:0] lanes, [15:8] latency cycles,
+  //       [31:16] feature flags)
+  // 0x50: Job opcode ([3:0]; ALU kernel: reset 0 = add; scan kernel: bit 0
+  //       exclusive, bit 1 load the carry from the operand)
+  // 0x54: Job operand (scalar K for every lane; reset 1)
+  // 0x58: Predicate control ([2:0] op: 0 always, 1 eq, 2 ne, 3 lt, 4 le,
+  //       5 gt, 6 ge, 7 never; bit 3: signed)
+  // 0x5C: Predicate value (x op value)
+  // 0x60: Reduction control (bit 0: accumulate, bit 1: clear, bit 2: reduce
+  //       the result beat instead of the inputs, [15:8] lane mask; reset 0xFF00)
+  // 0x64/0x68: Reduction sum low/high (RO, 64-bit)
+  // 0x6C: Reduction min (RO)
+  // 0x70: Reduction max (RO)
+  // 0x74: Reduction count of words matching the predicate (RO)
+  // 0x78: Reduction count of words reduced (RO)
+  // 0x7C: Compaction control (bit 0: enable, bit 1: compact the result beat
+  //       instead of the inputs, [15:8] lane mask; reset 0xFF00)
+  // 0x80: Perf - jobs completed (write any value to clear all perf counters)
+  // 0x84: Perf - compute busy cycles
+  // 0x88: Perf - OCL write transactions
+  // 0x8C: Perf - OCL read transactions
+  // 0x90: Compaction count of words in the output bank after the last job (RO)
+  // 0xC0/0xC4: Cycle counter low/high (reading 0xC0 snapshots all 64 bits)
+  // 0xC8/0xCC: Cycle the last job started, low/high
+  // 0xD0/0xD4: Cycle the last job completed, low/high
+  // 0xD8/0xDC: Cycle of the last OCL write before the last job started, low/high
+  // 0x100-0x13C: Latency histogram, start to done (16 × 32-bit bins)
+  // 0x140-0x17C: Latency histogram, done to next status read (16 × 32-bit bins)
+  // 0x180: Histogram control (write bit 0: clear both histograms)
+  //
+  // 0x200: Trace control (bit 0: enable, bit 1: clear, bit 2: stop when full,
+  //        bit 3: wait for trigger)
+  // 0x204: Trace event mask (bit 0: AW, 1: W, 2: B, 3: AR, 4: R)
+  // 0x208: Trace address match
+  // 0x20C: Trace address mask (bits compared against match, 0 = any address)
+  // 0x210: Trace trigger address (AW or AR to it starts recording)
+  // 0x214: Trace status (RO: [10:0] entries, [25:16] write pointer,
+  //        bit 30: wrapped, bit 31: triggered)
+  // 0x218: Trace read pointer
+  // 0x21C-0x228: Trace entry at read pointer (timestamp, events/addresses,
+  //        wdata, rdata); reading 0x228 advances the read pointer
+  //
+  // Engine status, job counters and error flags are also exported out of band
+  // on cl_sh_status0/1/2 and the SDA slave (see SDA below).
+  //
+  // The reduction engine folds the masked lanes of every job into the
+  // results when the job completes, replacing them unless accumulate is set.
+  // Min and max read 0 until a word has been reduced. Signed predicates also
+  // make min/max signed and sign-extend words into the sum.
+  //
+  // With compaction enabled, a job writes only the masked lanes matching the
+  // predicate to the output bank, packed from 0x20 up in lane order, and
+  // zeros after them; the compaction count says how many there are. With it
+  // disabled the whole result beat is written and the count reads 8.
+  //
+  // Histogram bin k counts latencies of 2^k to 2^(k+1)-1 cycles; bin 0 also
+  // holds 0 and bin 15 everything from 2^15 up. Bins saturate at 2^32-1.
+  //
+  // The trace buffer records one entry per cycle with a filtered OCL
+  // handshake. Accesses to the trace registers themselves are never recorded.
   
   logic [31:0] input_regs [0:NUM_REGS-1];   // 8 × 32-bit input registers
   logic [31:0] output_regs [0:NUM_REGS-1];  // 8 × 32-bit output registers
   logic [31:0] control_reg;
   logic [31:0] status_reg;
+  logic [3:0]  job_opcode;
+  logic [31:0] job_operand;
+  logic [3:0]  pred_ctrl;
+  logic [31:0] pred_value;
+  logic        red_accumulate;
+  logic        red_results;
+  logic [7:0]  red_mask;
+  logic        red_clear;
+  logic        cmp_enable;
+  logic        cmp_results;
+  logic [7:0]  cmp_mask;
+
+  // Free-running performance counters (wrap at 2^32)
+  logic [31:0] perf_jobs;
+  logic [31:0] perf_busy_cycles;
+  logic [31:0] perf_ocl_writes;
+  logic [31:0] perf_ocl_reads;
+  logic        perf_clear;
+
+  // Out-of-band monitoring state (never cleared by OCL)
+  logic [31:0] mon_jobs_started;
+  logic [31:0] mon_jobs_done;
+  logic [2:0]  mon_errors;          // sticky, write 1 to clear over SDA
+  logic [2:0]  mon_errors_clear;
+  logic        err_rd_unmapped;     // OCL read of an unmapped address
+  logic        err_wr_unmapped;     // OCL write to an unmapped address
+  logic        err_start_busy;      // start written while a job is running or unacknowledged
+  logic [31:0] mon_status;
+
+  // 64-bit cycle timestamps (never cleared except by reset)
+  logic [63:0] cycle_count;
+  logic [63:0] cycle_snap;
+  logic [63:0] last_wr_cycle;
+  logic [63:0] job_start_cycle;
+  logic [63:0] job_done_cycle;
+  logic [63:0] job_doorbell_cycle;
+
+  // On-card latency histograms
+  logic [31:0] hist_svc [0:HIST_BINS-1];    // job start -> add_done
+  logic [31:0] hist_react [0:HIST_BINS-1];  // add_done -> next status read
+  logic [31:0] svc_cycles;
+  logic [31:0] react_cycles;
+  logic        react_pending;
+  logic        hist_clear;
+
+  // OCL transaction trace buffer
+  (* ram_style = "block" *)
+  logic [127:0] trace_mem [0:TRACE_DEPTH-1];
+  logic [127:0] trace_rd_q;
+  logic [31:0]  trace_ctrl;
+  logic [4:0]   trace_evmask;
+  logic [11:0]  trace_amatch;
+  logic [11:0]  trace_amask;
+  logic [11:0]  trace_trig_addr;
+  logic         trace_clear;
+  logic         trace_rd_load;
+  logic [TRACE_PTR_W-1:0] trace_rd_load_val;
+  logic [TRACE_PTR_W-1:0] trace_wr_ptr;
+  logic [TRACE_PTR_W-1:0] trace_rd_ptr;
+  logic [TRACE_PTR_W:0]   trace_count;
+  logic         trace_wrapped;
+  logic         trace_triggered;
+  logic [31:0]  trace_status;
+
+`ifndef SYNTHESIS
+  // Simulation backdoor. Tasks stage data and bump a request count; the
+  // owning always_ff applies it on the next clock, so every register keeps a
+  // single driver. Dumps only read, so they write the arrays out directly.
+  logic [31:0]  bd_input_stage [0:NUM_REGS-1];
+  logic [127:0] bd_trace_stage [0:TRACE_DEPTH-1];
+  int           bd_input_req = 0;
+  int           bd_input_ack;
+  int           bd_trace_req = 0;
+  int           bd_trace_ack;
+
+  // Load the input bank from a $readmemh file (NUM_REGS words)
+  task backdoor_load_inputs(input string file);
+    $readmemh(file, bd_input_stage);
+    bd_input_req++;
+    wait (bd_input_ack == bd_input_req);
+  endtask
+
+  task backdoor_write_inputs(input logic [31:0] data [0:NUM_REGS-1]);
+    bd_input_stage = data;
+    bd_input_req++;
+    wait (bd_input_ack == bd_input_req);
+  endtask
+
+  // Load the trace BRAM from a $readmemh file (128-bit entries)
+  task backdoor_load_trace(input string file);
+    $readmemh(file, bd_trace_stage);
+    bd_trace_req++;
+    wait (bd_trace_ack == bd_trace_req);
+  endtask
+
+  // Dump the banks or the trace BRAM to a $writememh file
+  task backdoor_dump_inputs(input string file);
+    $writememh(file, input_regs);
+  endtask
+
+  task backdoor_dump_outputs(input string file);
+    $writememh(file, output_regs);
+  endtask
+
+  task backdoor_dump_trace(input string file);
+    $writememh(file, trace_mem);
+  endtask
+`endif
   
-  // Simple Add-One logic
-  logic [3:0] add_counter;
+  // Engine front end. A job is one AXI-Stream beat carrying the input bank
+  // (sampled when start is accepted) into the kernel slot; the kernel's
+  // result beat is written to the output bank and completes the job.
   logic       add_computing;
   logic       add_done;
   logic       add_start;
-  
+  logic       job_start;    // start accepted this cycle
+  logic       job_done;     // result beat taken this cycle
+
+  logic [32*NUM_REGS-1:0] kin_tdata;
+  logic [63:0]            kin_tuser;
+  logic                   kin_tvalid;
+  logic                   kin_tready;
+  logic [32*NUM_REGS-1:0] kout_tdata;
+  logic                   kout_tlast;
+  logic                   kout_tvalid;
+  logic                   kout_tready;
+  logic [31:0]            kernel_id;
+  logic [31:0]            kernel_caps;
+  logic [31:0]            cmp_q_data [0:NUM_REGS-1];   // packed survivors (see compaction)
+
   assign add_start = control_reg[0];
-  
-  // Add-One state machine
+  assign job_start = add_start && !add_computing && !add_done;
+  assign job_done = kout_tvalid && kout_tready;
+  assign kout_tready = add_computing;
+
   always_ff @(posedge clk_main_a0) begin
     if (!rst_main_n_sync) begin
-      add_counter <= 4'h0;
       add_computing <= 1'b0;
       add_done <= 1'b0;
+      kin_tvalid <= 1'b0;
+      kin_tdata <= '0;
+      kin_tuser <= '0;
       
       // Initialize output registers
       for (int i = 0; i < NUM_REGS; i++) begin
@@ -175,29 +373,206 @@ always @(posedge clk_main_a0)
       end
     end
     else begin
-      if (add_start && !add_computing && !add_done) begin
+      if (kin_tvalid && kin_tready)
+        kin_tvalid <= 1'b0;
+
+      if (job_start) begin
         // Start computation
         add_computing <= 1'b1;
         add_done <= 1'b0;
-        add_counter <= 4'h0;
-        $display("[%t] ADD-ONE: Starting computation", $realtime);
+        kin_tvalid <= 1'b1;
+        for (int i = 0; i < NUM_REGS; i++) begin
+          kin_tdata[32*i +: 32] <= input_regs[i];
+        end
+        kin_tuser <= {job_operand, 28'h0, job_opcode};
+        `CL_LOG(`CL_LOG_MEDIUM, ("[%t] ENGINE: Starting kernel 0x%08x", $realtime, kernel_id))
       end
-      else if (add_computing) begin
-        add_counter <= add_counter + 1;
-        if (add_counter == 4'h4) begin // 4 cycles delay
-          // Finish computation - add 1 to each input
-          add_computing <= 1'b0;
-          add_done <= 1'b1;
-          for (int i = 0; i < NUM_REGS; i++) begin
-            output_regs[i] <= input_regs[i] + 1;
-          end
-          $display("[%t] ADD-ONE: Computation complete", $realtime);
+      else if (job_done) begin
+        add_computing <= 1'b0;
+        add_done <= 1'b1;
+        for (int i = 0; i < NUM_REGS; i++) begin
+          output_regs[i] <= cmp_enable ? cmp_q_data[i] : kout_tdata[32*i +: 32];
         end
+        `CL_LOG(`CL_LOG_MEDIUM, ("[%t] ENGINE: Computation complete", $realtime))
       end
       else if (add_done && !add_start) begin
         // Reset done when start goes low
         add_done <= 1'b0;
-        $display("[%t] ADD-ONE: Reset done flag", $realtime);
+        `CL_LOG(`CL_LOG_MEDIUM, ("[%t] ENGINE: Reset done flag", $realtime))
+      end
+    end
+  end
+
+  // Kernel slot, see cl_kernel_add_one.sv for the interface contract
+  generate
+    if (KERNEL == KERNEL_ADD_ONE) begin : g_kernel
+      cl_kernel_add_one #(.NUM_LANES(NUM_REGS), .LATENCY(KERNEL_LATENCY)) u_kernel (
+        .clk(clk_main_a0), .rst_n(rst_main_n_sync),
+        .s_axis_tdata(kin_tdata), .s_axis_tuser(kin_tuser), .s_axis_tlast(1'b1),
+        .s_axis_tvalid(kin_tvalid), .s_axis_tready(kin_tready),
+        .m_axis_tdata(kout_tdata), .m_axis_tlast(kout_tlast),
+        .m_axis_tvalid(kout_tvalid), .m_axis_tready(kout_tready),
+        .kernel_id(kernel_id), .kernel_caps(kernel_caps));
+    end
+    else if (KERNEL == KERNEL_ALU) begin : g_kernel
+      cl_kernel_alu #(.NUM_LANES(NUM_REGS), .LATENCY(KERNEL_LATENCY)) u_kernel (
+        .clk(clk_main_a0), .rst_n(rst_main_n_sync),
+        .s_axis_tdata(kin_tdata), .s_axis_tuser(kin_tuser), .s_axis_tlast(1'b1),
+        .s_axis_tvalid(kin_tvalid), .s_axis_tready(kin_tready),
+        .m_axis_tdata(kout_tdata), .m_axis_tlast(kout_tlast),
+        .m_axis_tvalid(kout_tvalid), .m_axis_tready(kout_tready),
+        .kernel_id(kernel_id), .kernel_caps(kernel_caps));
+    end
+    else if (KERNEL == KERNEL_SCAN) begin : g_kernel
+      cl_kernel_scan #(.NUM_LANES(NUM_REGS), .LATENCY(KERNEL_LATENCY)) u_kernel (
+        .clk(clk_main_a0), .rst_n(rst_main_n_sync),
+        .s_axis_tdata(kin_tdata), .s_axis_tuser(kin_tuser), .s_axis_tlast(1'b1),
+        .s_axis_tvalid(kin_tvalid), .s_axis_tready(kin_tready),
+        .m_axis_tdata(kout_tdata), .m_axis_tlast(kout_tlast),
+        .m_axis_tvalid(kout_tvalid), .m_axis_tready(kout_tready),
+        .kernel_id(kernel_id), .kernel_caps(kernel_caps));
+    end
+    else begin : g_kernel_unknown
+      $error("cl_top: no kernel with ID %0d", KERNEL);
+    end
+  endgenerate
+
+  // Reduction engine. The masked lanes of the job's input beat (or, with
+  // red_results, of the kernel's result beat, which holds from the cycle
+  // before the result handshake) are reduced to a partial every busy cycle;
+  // the partial of the last busy cycle is folded into the results on done,
+  // so reducing adds no cycles to a job. Needs a kernel latency of 2 or more.
+  generate
+    if (KERNEL_LATENCY < 2) begin : g_red_latency
+      $error("cl_top: the reduction engine needs a kernel latency of 2 or more, not %0d",
+             KERNEL_LATENCY);
+    end
+  endgenerate
+
+`ifndef SYNTHESIS
+  // A kernel that reports less than it was built with would still break it,
+  // and stream compaction (below) the same way
+  always @(posedge clk_main_a0) begin
+    if (job_start && kernel_caps[15:8] < 8'd2)
+      $error("[%t] cl_top: kernel 0x%08x reports latency %0d, reduction and compaction need 2 or more",
+             $realtime, kernel_id, kernel_caps[15:8]);
+  end
+`endif
+
+  logic [31:0] red_x;
+  logic [63:0] red_t_sum [0:NUM_REGS-1];     // per-lane terms, then the tree's nodes
+  logic [31:0] red_t_min [0:NUM_REGS-1];
+  logic [31:0] red_t_max [0:NUM_REGS-1];
+  logic [3:0]  red_t_count [0:NUM_REGS-1];
+  logic [3:0]  red_t_words [0:NUM_REGS-1];
+  logic [63:0] red_p_sum;
+  logic [31:0] red_p_min;
+  logic [31:0] red_p_max;
+  logic [3:0]  red_p_count;
+  logic [3:0]  red_p_words;
+  logic [63:0] red_q_sum;
+  logic [31:0] red_q_min;
+  logic [31:0] red_q_max;
+  logic [3:0]  red_q_count;
+  logic [3:0]  red_q_words;
+  logic [63:0] red_sum;
+  logic [31:0] red_min;
+  logic [31:0] red_max;
+  logic [31:0] red_count;
+  logic [31:0] red_words;
+
+  function automatic logic pred_less(input logic signed_cmp, input logic [31:0] a,
+                                     input logic [31:0] b);
+    pred_less = signed_cmp ? ($signed(a) < $signed(b)) : (a < b);
+  endfunction
+
+  // cl_top_reduce.h is the C reference
+  function automatic logic pred_match(input logic [3:0] ctrl, input logic [31:0] value,
+                                      input logic [31:0] x);
+    case (ctrl[2:0])
+      3'd0: pred_match = 1'b1;
+      3'd1: pred_match = x == value;
+      3'd2: pred_match = x != value;
+      3'd3: pred_match = pred_less(ctrl[3], x, value);
+      3'd4: pred_match = !pred_less(ctrl[3], value, x);
+      3'd5: pred_match = pred_less(ctrl[3], value, x);
+      3'd6: pred_match = !pred_less(ctrl[3], x, value);
+      default: pred_match = 1'b0;
+    endcase
+  endfunction
+
+  // Log-depth tree over the lanes: each level folds node i + d into node i,
+  // so the partial is log2(NUM_REGS) adders and compares deep rather than a
+  // NUM_REGS-long chain. A masked-off lane is an empty node (no words, min
+  // and max 0) that loses every compare.
+  always_comb begin
+    red_x = '0;
+    for (int i = 0; i < NUM_REGS; i++) begin
+      red_x = red_results ? kout_tdata[32*i +: 32] : kin_tdata[32*i +: 32];
+      red_t_sum[i] = !red_mask[i] ? 64'h0 :
+                     pred_ctrl[3] ? {{32{red_x[31]}}, red_x} : {32'h0, red_x};
+      red_t_min[i] = red_mask[i] ? red_x : 32'h0;
+      red_t_max[i] = red_mask[i] ? red_x : 32'h0;
+      red_t_count[i] = 4'(red_mask[i] && pred_match(pred_ctrl, pred_value, red_x));
+      red_t_words[i] = 4'(red_mask[i]);
+    end
+    for (int d = 1; d < NUM_REGS; d = d * 2) begin
+      for (int i = 0; i + d < NUM_REGS; i = i + 2 * d) begin
+        if (red_t_words[i+d] != 0) begin
+          if (red_t_words[i] == 0 || pred_less(pred_ctrl[3], red_t_min[i+d], red_t_min[i]))
+            red_t_min[i] = red_t_min[i+d];
+          if (red_t_words[i] == 0 || pred_less(pred_ctrl[3], red_t_max[i], red_t_max[i+d]))
+            red_t_max[i] = red_t_max[i+d];
+        end
+        red_t_sum[i] = red_t_sum[i] + red_t_sum[i+d];
+        red_t_count[i] = red_t_count[i] + red_t_count[i+d];
+        red_t_words[i] = red_t_words[i] + red_t_words[i+d];
+      end
+    end
+    red_p_sum = red_t_sum[0];
+    red_p_min = red_t_min[0];
+    red_p_max = red_t_max[0];
+    red_p_count = red_t_count[0];
+    red_p_words = red_t_words[0];
+  end
+
+  always_ff @(posedge clk_main_a0) begin
+    if (!rst_main_n_sync || red_clear) begin
+      red_q_sum <= 64'h0;
+      red_q_min <= 32'h0;
+      red_q_max <= 32'h0;
+      red_q_count <= 4'h0;
+      red_q_words <= 4'h0;
+      red_sum <= 64'h0;
+      red_min <= 32'h0;
+      red_max <= 32'h0;
+      red_count <= 32'h0;
+      red_words <= 32'h0;
+    end
+    else begin
+      if (add_computing) begin
+        red_q_sum <= red_p_sum;
+        red_q_min <= red_p_min;
+        red_q_max <= red_p_max;
+        red_q_count <= red_p_count;
+        red_q_words <= red_p_words;
+      end
+
+      if (job_done) begin
+        red_sum <= (red_accumulate ? red_sum : 64'h0) + red_q_sum;
+        red_count <= (red_accumulate ? red_count : 32'h0) + 32'(red_q_count);
+        red_words <= (red_accumulate ? red_words : 32'h0) + 32'(red_q_words);
+        if (!red_accumulate || red_words == 0) begin
+          red_min <= red_q_min;
+          red_max <= red_q_max;
+        end
+        else if (red_q_words != 0) begin
+          if (pred_less(pred_ctrl[3], red_q_min, red_min))
+            red_min <= red_q_min;
+          if (pred_less(pred_ctrl[3], red_max, red_q_max))
+            red_max <= red_q_max;
+        end
+        `CL_LOG(`CL_LOG_MEDIUM, ("[%t] REDUCE: %0d words, %0d matching", $realtime, red_q_words, red_q_count))
       end
     end
   end
@@ -224,6 +599,263 @@ always @(posedge clk_main_a0)
   read_state_t rd_state;
   logic [ADDR_WIDTH-1:0] wr_addr;
   logic [ADDR_WIDTH-1:0] rd_addr;
+
+  // OCL handshakes
+  logic aw_hs, w_hs, b_hs, ar_hs, r_hs;
+
+  assign aw_hs = ocl_cl_awvalid && cl_ocl_awready;
+  assign w_hs  = ocl_cl_wvalid && cl_ocl_wready;
+  assign b_hs  = ocl_cl_bready && cl_ocl_bvalid;
+  assign ar_hs = ocl_cl_arvalid && cl_ocl_arready;
+  assign r_hs  = ocl_cl_rready && cl_ocl_rvalid;
+
+  // floor(log2(v)), clamped to the last histogram bin
+  function automatic logic [3:0] hist_bin(input logic [31:0] v);
+    hist_bin = 4'd0;
+    for (int b = 1; b < 32; b++) begin
+      if (v[b])
+        hist_bin = (b >= HIST_BINS) ? 4'(HIST_BINS-1) : 4'(b);
+    end
+  endfunction
+
+  logic [3:0] svc_bin;
+  logic [3:0] react_bin;
+
+  assign svc_bin = hist_bin(svc_cycles + 1);
+  assign react_bin = hist_bin(react_cycles);
+
+  // Latency histograms
+  always_ff @(posedge clk_main_a0) begin
+    if (!rst_main_n_sync || hist_clear) begin
+      for (int i = 0; i < HIST_BINS; i++) begin
+        hist_svc[i] <= 32'h0;
+        hist_react[i] <= 32'h0;
+      end
+      svc_cycles <= 32'h0;
+      react_cycles <= 32'h0;
+      react_pending <= 1'b0;
+    end
+    else begin
+      // Start to done: counted from the cycle start is accepted
+      if (job_start)
+        svc_cycles <= 32'h0;
+      else if (add_computing)
+        svc_cycles <= svc_cycles + 1;
+
+      if (job_done) begin
+        if (hist_svc[svc_bin] != 32'hFFFFFFFF)
+          hist_svc[svc_bin] <= hist_svc[svc_bin] + 1;
+        react_cycles <= 32'h0;
+        react_pending <= 1'b1;
+      end
+      // Done to the host's next status read (AR handshake on 0x44)
+      else if (react_pending) begin
+        if (ar_hs && ocl_cl_araddr[ADDR_WIDTH-1:0] == 12'h044) begin
+          if (hist_react[react_bin] != 32'hFFFFFFFF)
+            hist_react[react_bin] <= hist_react[react_bin] + 1;
+          react_pending <= 1'b0;
+        end
+        else if (react_cycles != 32'hFFFFFFFF) begin
+          react_cycles <= react_cycles + 1;
+        end
+      end
+    end
+  end
+
+  // Stream compaction. A lane survives when it is in the mask and its word
+  // (from the input beat, or the result beat with cmp_results) matches the
+  // predicate. Its slot in the packed beat is the number of survivors below
+  // it, an exclusive prefix popcount; each packed slot then selects the one
+  // survivor that landed there. The packed beat is registered while the
+  // job is busy and goes to the output bank in place of the result beat on
+  // done, so the job is no longer; the register only holds the final
+  // result beat if the kernel latency is 2 or more.
+  generate
+    if (KERNEL_LATENCY < 2) begin : g_cmp_latency
+      $error("cl_top: stream compaction needs a kernel latency of 2 or more, not %0d",
+             KERNEL_LATENCY);
+    end
+  endgenerate
+
+  logic [31:0]         cmp_x [0:NUM_REGS-1];
+  logic [NUM_REGS-1:0] cmp_keep;
+  logic [3:0]          cmp_pos [0:NUM_REGS-1];   // survivors in the lanes below
+  logic [31:0]         cmp_p_data [0:NUM_REGS-1];
+  logic [3:0]          cmp_p_count;
+  logic [3:0]          cmp_q_count;
+  logic [31:0]         cmp_count;
+
+  always_comb begin
+    for (int i = 0; i < NUM_REGS; i++) begin
+      cmp_x[i] = cmp_results ? kout_tdata[32*i +: 32] : kin_tdata[32*i +: 32];
+      cmp_keep[i] = cmp_mask[i] && pred_match(pred_ctrl, pred_value, cmp_x[i]);
+    end
+    // Log-depth scan of the keep bits shifted up a lane, top down so each
+    // level reads the previous level's values
+    for (int i = 0; i < NUM_REGS; i++)
+      cmp_pos[i] = (i == 0) ? 4'h0 : 4'(cmp_keep[i-1]);
+    for (int d = 1; d < NUM_REGS; d = d * 2) begin
+      for (int i = NUM_REGS - 1; i >= d; i--)
+        cmp_pos[i] = cmp_pos[i] + cmp_pos[i-d];
+    end
+    cmp_p_count = cmp_pos[NUM_REGS-1] + 4'(cmp_keep[NUM_REGS-1]);
+    // At most one survivor claims a slot, so the select is an OR
+    for (int j = 0; j < NUM_REGS; j++) begin
+      cmp_p_data[j] = 32'h0;
+      for (int i = j; i < NUM_REGS; i++) begin
+        if (cmp_keep[i] && cmp_pos[i] == 4'(j))
+          cmp_p_data[j] = cmp_p_data[j] | cmp_x[i];
+      end
+    end
+  end
+
+  always_ff @(posedge clk_main_a0) begin
+    if (!rst_main_n_sync) begin
+      for (int i = 0; i < NUM_REGS; i++)
+        cmp_q_data[i] <= 32'h0;
+      cmp_q_count <= 4'h0;
+      cmp_count <= 32'h0;
+    end
+    else begin
+      if (add_computing) begin
+        cmp_q_data <= cmp_p_data;
+        cmp_q_count <= cmp_p_count;
+      end
+      if (job_done) begin
+        cmp_count <= cmp_enable ? 32'(cmp_q_count) : 32'(NUM_REGS);
+        `CL_LOG(`CL_LOG_MEDIUM, ("[%t] COMPACT: %0d words kept (enable %0d)", $realtime, cmp_q_count, cmp_enable))
+      end
+    end
+  end
+
+  // Performance counters
+  always_ff @(posedge clk_main_a0) begin
+    if (!rst_main_n_sync || perf_clear) begin
+      perf_jobs <= 32'h0;
+      perf_busy_cycles <= 32'h0;
+      perf_ocl_writes <= 32'h0;
+      perf_ocl_reads <= 32'h0;
+    end
+    else begin
+      if (job_done)
+        perf_jobs <= perf_jobs + 1;
+      if (add_computing)
+        perf_busy_cycles <= perf_busy_cycles + 1;
+      if (b_hs)
+        perf_ocl_writes <= perf_ocl_writes + 1;
+      if (r_hs)
+        perf_ocl_reads <= perf_ocl_reads + 1;
+    end
+  end
+
+  // Cycle timestamps. The doorbell is the last OCL write accepted before a
+  // job starts, normally the write of the start bit itself.
+  always_ff @(posedge clk_main_a0) begin
+    if (!rst_main_n_sync) begin
+      cycle_count <= 64'h0;
+      cycle_snap <= 64'h0;
+      last_wr_cycle <= 64'h0;
+      job_start_cycle <= 64'h0;
+      job_done_cycle <= 64'h0;
+      job_doorbell_cycle <= 64'h0;
+    end
+    else begin
+      cycle_count <= cycle_count + 1;
+
+      if (ar_hs && ocl_cl_araddr[ADDR_WIDTH-1:0] == 12'h0C0)
+        cycle_snap <= cycle_count;
+
+      if (w_hs)
+        last_wr_cycle <= cycle_count;
+
+      if (job_start) begin
+        job_start_cycle <= cycle_count;
+        job_doorbell_cycle <= last_wr_cycle;
+      end
+
+      if (job_done)
+        job_done_cycle <= cycle_count;
+    end
+  end
+
+  // OCL transaction trace
+  logic [11:0] trace_waddr;
+  logic [11:0] trace_raddr;
+  logic [4:0]  trace_ev;
+  logic        trace_wmatch;
+  logic        trace_rmatch;
+  logic        trace_record;
+
+  always_comb begin
+    // Address of the write / read transaction each handshake belongs to
+    trace_waddr = aw_hs ? ocl_cl_awaddr[ADDR_WIDTH-1:0] : wr_addr;
+    trace_raddr = ar_hs ? ocl_cl_araddr[ADDR_WIDTH-1:0] : rd_addr;
+
+    trace_wmatch = ((trace_waddr & trace_amask) == (trace_amatch & trace_amask)) &&
+                   (trace_waddr[11:8] != 4'h2);
+    trace_rmatch = ((trace_raddr & trace_amask) == (trace_amatch & trace_amask)) &&
+                   (trace_raddr[11:8] != 4'h2);
+
+    trace_ev[0] = aw_hs && trace_wmatch;
+    trace_ev[1] = w_hs  && trace_wmatch;
+    trace_ev[2] = b_hs  && trace_wmatch;
+    trace_ev[3] = ar_hs && trace_rmatch;
+    trace_ev[4] = r_hs  && trace_rmatch;
+    trace_ev = trace_ev & trace_evmask;
+
+    trace_record = trace_ctrl[0] && (|trace_ev) &&
+                   (trace_triggered || !trace_ctrl[3]) &&
+                   !(trace_ctrl[2] && trace_wrapped);
+
+    trace_status = 32'h0;
+    trace_status[TRACE_PTR_W:0] = trace_count;
+    trace_status[16 +: TRACE_PTR_W] = trace_wr_ptr;
+    trace_status[30] = trace_wrapped;
+    trace_status[31] = trace_triggered;
+  end
+
+  always_ff @(posedge clk_main_a0) begin
+    if (!rst_main_n_sync || trace_clear) begin
+      trace_wr_ptr <= '0;
+      trace_rd_ptr <= '0;
+      trace_count <= '0;
+      trace_wrapped <= 1'b0;
+      trace_triggered <= 1'b0;
+    end
+    else begin
+      if (trace_ctrl[0] && trace_ctrl[3] && !trace_triggered &&
+          ((aw_hs && ocl_cl_awaddr[ADDR_WIDTH-1:0] == trace_trig_addr) ||
+           (ar_hs && ocl_cl_araddr[ADDR_WIDTH-1:0] == trace_trig_addr)))
+        trace_triggered <= 1'b1;
+
+      if (trace_record) begin
+        trace_wr_ptr <= trace_wr_ptr + 1;
+        if (trace_count != TRACE_DEPTH)
+          trace_count <= trace_count + 1;
+        if (trace_wr_ptr == TRACE_PTR_W'(TRACE_DEPTH-1))
+          trace_wrapped <= 1'b1;
+      end
+
+      if (trace_rd_load)
+        trace_rd_ptr <= trace_rd_load_val;
+      else if (r_hs && rd_addr == 12'h228)
+        trace_rd_ptr <= trace_rd_ptr + 1;
+    end
+  end
+
+  // Block RAM: one write port for recording, one read port for draining
+  always_ff @(posedge clk_main_a0) begin
+    if (trace_record)
+      trace_mem[trace_wr_ptr] <= {cycle_count[31:0], 3'b0, trace_ev, trace_waddr, trace_raddr,
+                                  ocl_cl_wdata, cl_ocl_rdata};
+    trace_rd_q <= trace_mem[trace_rd_ptr];
+`ifndef SYNTHESIS
+    if (bd_trace_ack != bd_trace_req) begin
+      trace_mem <= bd_trace_stage;
+      bd_trace_ack <= bd_trace_req;
+    end
+`endif
+  end
   
   // Write Channel
   always_ff @(posedge clk_main_a0) begin
@@ -234,14 +866,49 @@ always @(posedge clk_main_a0)
       cl_ocl_bvalid <= 1'b0;
       cl_ocl_bresp <= 2'b00;
       wr_addr <= '0;
+      perf_clear <= 1'b0;
+      hist_clear <= 1'b0;
+      red_clear <= 1'b0;
+      trace_clear <= 1'b0;
+      trace_rd_load <= 1'b0;
+      trace_rd_load_val <= '0;
+      trace_ctrl <= 32'h0;
+      trace_evmask <= 5'h1F;
+      trace_amatch <= 12'h0;
+      trace_amask <= 12'h0;
+      trace_trig_addr <= 12'h0;
+      err_wr_unmapped <= 1'b0;
+      err_start_busy <= 1'b0;
       
       // Initialize registers
       for (int i = 0; i < NUM_REGS; i++) begin
         input_regs[i] <= 32'h0;
       end
       control_reg <= 32'h0;
+      job_opcode <= 4'h0;
+      job_operand <= 32'h1;
+      pred_ctrl <= 4'h0;
+      pred_value <= 32'h0;
+      red_accumulate <= 1'b0;
+      red_results <= 1'b0;
+      red_mask <= 8'hFF;
+      cmp_enable <= 1'b0;
+      cmp_results <= 1'b0;
+      cmp_mask <= 8'hFF;
+`ifndef SYNTHESIS
+      bd_input_ack <= bd_input_req;
+`endif
     end
     else begin
+      perf_clear <= 1'b0;  // single-cycle pulses
+      hist_clear <= 1'b0;
+      red_clear <= 1'b0;
+      trace_clear <= 1'b0;
+      trace_rd_load <= 1'b0;
+      trace_ctrl[1] <= 1'b0;
+      err_wr_unmapped <= 1'b0;
+      err_start_busy <= 1'b0;
+
       case (wr_state)
         WRITE_IDLE: begin
           cl_ocl_awready <= 1'b1;
@@ -252,7 +919,7 @@ always @(posedge clk_main_a0)
             wr_addr <= ocl_cl_awaddr[ADDR_WIDTH-1:0];
             cl_ocl_awready <= 1'b0;
             wr_state <= WRITE_DATA;
-            $display("[%t] AXI WRITE: Address = 0x%02x", $realtime, ocl_cl_awaddr[ADDR_WIDTH-1:0]);
+            `CL_LOG(`CL_LOG_HIGH, ("[%t] AXI WRITE: Address = 0x%03x", $realtime, ocl_cl_awaddr[ADDR_WIDTH-1:0]))
           end
         end
         
@@ -260,18 +927,92 @@ always @(posedge clk_main_a0)
           cl_ocl_wready <= 1'b1;
           
           if (ocl_cl_wvalid && cl_ocl_wready) begin
-            $display("[%t] AXI WRITE: Data = 0x%08x to addr 0x%02x", $realtime, ocl_cl_wdata, wr_addr);
+            `CL_LOG(`CL_LOG_HIGH, ("[%t] AXI WRITE: Data = 0x%08x to addr 0x%03x", $realtime, ocl_cl_wdata, wr_addr))
             
             // Decode address and write to appropriate register
-            if (wr_addr >= 8'h00 && wr_addr <= 8'h1C) begin
+            if (wr_addr >= 12'h000 && wr_addr <= 12'h01C) begin
               // Input registers (0x00-0x1C, 8 registers)
               input_regs[wr_addr[4:2]] <= ocl_cl_wdata;
-              $display("[%t] WRITE: Input reg[%0d] = 0x%08x", $realtime, wr_addr[4:2], ocl_cl_wdata);
+              `CL_LOG(`CL_LOG_MEDIUM, ("[%t] WRITE: Input reg[%0d] = 0x%08x", $realtime, wr_addr[4:2], ocl_cl_wdata))
             end
-            else if (wr_addr == 8'h40) begin
+            else if (wr_addr == 12'h040) begin
               // Control register
               control_reg <= ocl_cl_wdata;
-              $display("[%t] WRITE: Control reg = 0x%08x", $realtime, ocl_cl_wdata);
+              err_start_busy <= ocl_cl_wdata[0] && (add_computing || add_done);
+              `CL_LOG(`CL_LOG_MEDIUM, ("[%t] WRITE: Control reg = 0x%08x", $realtime, ocl_cl_wdata))
+            end
+            else if (wr_addr == 12'h050) begin
+              job_opcode <= ocl_cl_wdata[3:0];
+              `CL_LOG(`CL_LOG_MEDIUM, ("[%t] WRITE: Job opcode = %0d", $realtime, ocl_cl_wdata[3:0]))
+            end
+            else if (wr_addr == 12'h054) begin
+              job_operand <= ocl_cl_wdata;
+              `CL_LOG(`CL_LOG_MEDIUM, ("[%t] WRITE: Job operand = 0x%08x", $realtime, ocl_cl_wdata))
+            end
+            else if (wr_addr == 12'h058) begin
+              pred_ctrl <= ocl_cl_wdata[3:0];
+              `CL_LOG(`CL_LOG_MEDIUM, ("[%t] WRITE: Predicate control = 0x%x", $realtime, ocl_cl_wdata[3:0]))
+            end
+            else if (wr_addr == 12'h05C) begin
+              pred_value <= ocl_cl_wdata;
+              `CL_LOG(`CL_LOG_MEDIUM, ("[%t] WRITE: Predicate value = 0x%08x", $realtime, ocl_cl_wdata))
+            end
+            else if (wr_addr == 12'h060) begin
+              // Reduction control; bit 1 is a self-clearing clear request
+              red_accumulate <= ocl_cl_wdata[0];
+              red_clear <= ocl_cl_wdata[1];
+              red_results <= ocl_cl_wdata[2];
+              red_mask <= ocl_cl_wdata[15:8];
+              `CL_LOG(`CL_LOG_MEDIUM, ("[%t] WRITE: Reduction control = 0x%08x", $realtime, ocl_cl_wdata))
+            end
+            else if (wr_addr == 12'h07C) begin
+              cmp_enable <= ocl_cl_wdata[0];
+              cmp_results <= ocl_cl_wdata[1];
+              cmp_mask <= ocl_cl_wdata[15:8];
+              `CL_LOG(`CL_LOG_MEDIUM, ("[%t] WRITE: Compaction control = 0x%08x", $realtime, ocl_cl_wdata))
+            end
+            else if (wr_addr == 12'h080) begin
+              // Clear performance counters
+              perf_clear <= 1'b1;
+              `CL_LOG(`CL_LOG_MEDIUM, ("[%t] WRITE: Perf counters cleared", $realtime))
+            end
+            else if (wr_addr == 12'h180) begin
+              // Histogram control
+              hist_clear <= ocl_cl_wdata[0];
+              `CL_LOG(`CL_LOG_MEDIUM, ("[%t] WRITE: Histogram control = 0x%08x", $realtime, ocl_cl_wdata))
+            end
+            else if (wr_addr == 12'h200) begin
+              // Trace control; bit 1 is a self-clearing clear request
+              trace_ctrl <= ocl_cl_wdata;
+              trace_clear <= ocl_cl_wdata[1];
+              `CL_LOG(`CL_LOG_MEDIUM, ("[%t] WRITE: Trace control = 0x%08x", $realtime, ocl_cl_wdata))
+            end
+            else if (wr_addr == 12'h204) begin
+              trace_evmask <= ocl_cl_wdata[4:0];
+            end
+            else if (wr_addr == 12'h208) begin
+              trace_amatch <= ocl_cl_wdata[11:0];
+            end
+            else if (wr_addr == 12'h20C) begin
+              trace_amask <= ocl_cl_wdata[11:0];
+            end
+            else if (wr_addr == 12'h210) begin
+              trace_trig_addr <= ocl_cl_wdata[11:0];
+            end
+            else if (wr_addr == 12'h218) begin
+              trace_rd_load <= 1'b1;
+              trace_rd_load_val <= ocl_cl_wdata[TRACE_PTR_W-1:0];
+            end
+            else if (!(wr_addr >= 12'h020 && wr_addr <= 12'h03C) &&
+                     !(wr_addr >= 12'h044 && wr_addr <= 12'h04C) &&
+                     !(wr_addr >= 12'h064 && wr_addr <= 12'h078) &&
+                     !(wr_addr >= 12'h080 && wr_addr <= 12'h090) &&
+                     !(wr_addr >= 12'h0C0 && wr_addr <= 12'h0DC) &&
+                     !(wr_addr >= 12'h100 && wr_addr <= 12'h17C) &&
+                     !(wr_addr >= 12'h200 && wr_addr <= 12'h228)) begin
+              // Read-only registers ignore writes silently; anything else is unmapped
+              err_wr_unmapped <= 1'b1;
+              `CL_LOG(`CL_LOG_LOW, ("[%t] WRITE: Unknown address 0x%03x, ignored", $realtime, wr_addr))
             end
             
             cl_ocl_wready <= 1'b0;
@@ -289,6 +1030,14 @@ always @(posedge clk_main_a0)
           end
         end
       endcase
+
+`ifndef SYNTHESIS
+      // Backdoor load wins over a frontdoor write in the same cycle
+      if (bd_input_ack != bd_input_req) begin
+        input_regs <= bd_input_stage;
+        bd_input_ack <= bd_input_req;
+      end
+`endif
     end
   end
   
@@ -301,6 +1050,7 @@ always @(posedge clk_main_a0)
       cl_ocl_rdata <= 32'h0;
       cl_ocl_rresp <= 2'b00;
       rd_addr <= '0;
+      err_rd_unmapped <= 1'b0;
     end
     else begin
       case (rd_state)
@@ -312,38 +1062,168 @@ always @(posedge clk_main_a0)
             rd_addr <= ocl_cl_araddr[ADDR_WIDTH-1:0];
             cl_ocl_arready <= 1'b0;
             rd_state <= READ_DATA;
-            $display("[%t] AXI READ: Address = 0x%02x", $realtime, ocl_cl_araddr[ADDR_WIDTH-1:0]);
+            `CL_LOG(`CL_LOG_HIGH, ("[%t] AXI READ: Address = 0x%03x", $realtime, ocl_cl_araddr[ADDR_WIDTH-1:0]))
           end
         end
         
         READ_DATA: begin
           cl_ocl_rvalid <= 1'b1;
           cl_ocl_rresp <= 2'b00; // OKAY response
+          err_rd_unmapped <= 1'b0;
           
           // Decode address and read from appropriate register
-          if (rd_addr >= 8'h00 && rd_addr <= 8'h1C) begin
+          if (rd_addr >= 12'h000 && rd_addr <= 12'h01C) begin
             // Input registers (read-back)
             cl_ocl_rdata <= input_regs[rd_addr[4:2]];
-            $display("[%t] READ: Input reg[%0d] = 0x%08x", $realtime, rd_addr[4:2], input_regs[rd_addr[4:2]]);
+            `CL_LOG(`CL_LOG_MEDIUM, ("[%t] READ: Input reg[%0d] = 0x%08x", $realtime, rd_addr[4:2], input_regs[rd_addr[4:2]]))
           end
-          else if (rd_addr >= 8'h20 && rd_addr <= 8'h3C) begin
+          else if (rd_addr >= 12'h020 && rd_addr <= 12'h03C) begin
             // Output registers
               cl_ocl_rdata <= output_regs[rd_addr[4:2] - 3'd8]; // Subtract offset for 0x20 base
-              $display("[%t] READ: Output reg[%0d] = 0x%08x", $realtime, rd_addr[4:2], output_regs[rd_addr[4:2] - 3'd8]);
+              `CL_LOG(`CL_LOG_MEDIUM, ("[%t] READ: Output reg[%0d] = 0x%08x", $realtime, rd_addr[4:2], output_regs[rd_addr[4:2] - 3'd8]))
           end
-          else if (rd_addr == 8'h40) begin
+          else if (rd_addr == 12'h040) begin
             // Control register
             cl_ocl_rdata <= control_reg;
-            $display("[%t] READ: Control reg = 0x%08x", $realtime, control_reg);
+            `CL_LOG(`CL_LOG_MEDIUM, ("[%t] READ: Control reg = 0x%08x", $realtime, control_reg))
           end
-          else if (rd_addr == 8'h44) begin
+          else if (rd_addr == 12'h044) begin
             // Status register
             cl_ocl_rdata <= status_reg;
-            $display("[%t] READ: Status reg = 0x%08x", $realtime, status_reg);
+            `CL_LOG(`CL_LOG_MEDIUM, ("[%t] READ: Status reg = 0x%08x", $realtime, status_reg))
+          end
+          else if (rd_addr == 12'h048) begin
+            cl_ocl_rdata <= kernel_id;
+          end
+          else if (rd_addr == 12'h04C) begin
+            cl_ocl_rdata <= kernel_caps;
+          end
+          else if (rd_addr == 12'h050) begin
+            cl_ocl_rdata <= {28'b0, job_opcode};
+          end
+          else if (rd_addr == 12'h054) begin
+            cl_ocl_rdata <= job_operand;
+          end
+          else if (rd_addr == 12'h058) begin
+            cl_ocl_rdata <= {28'b0, pred_ctrl};
+          end
+          else if (rd_addr == 12'h05C) begin
+            cl_ocl_rdata <= pred_value;
+          end
+          else if (rd_addr == 12'h060) begin
+            cl_ocl_rdata <= {16'b0, red_mask, 5'b0, red_results, 1'b0, red_accumulate};
+          end
+          else if (rd_addr == 12'h064) begin
+            cl_ocl_rdata <= red_sum[31:0];
+          end
+          else if (rd_addr == 12'h068) begin
+            cl_ocl_rdata <= red_sum[63:32];
+          end
+          else if (rd_addr == 12'h06C) begin
+            cl_ocl_rdata <= red_min;
+          end
+          else if (rd_addr == 12'h070) begin
+            cl_ocl_rdata <= red_max;
+          end
+          else if (rd_addr == 12'h074) begin
+            cl_ocl_rdata <= red_count;
+            `CL_LOG(`CL_LOG_MEDIUM, ("[%t] READ: Reduction count = %0d", $realtime, red_count))
+          end
+          else if (rd_addr == 12'h078) begin
+            cl_ocl_rdata <= red_words;
+          end
+          else if (rd_addr == 12'h07C) begin
+            cl_ocl_rdata <= {16'b0, cmp_mask, 6'b0, cmp_results, cmp_enable};
+          end
+          else if (rd_addr == 12'h080) begin
+            cl_ocl_rdata <= perf_jobs;
+            `CL_LOG(`CL_LOG_MEDIUM, ("[%t] READ: Perf jobs = %0d", $realtime, perf_jobs))
+          end
+          else if (rd_addr == 12'h084) begin
+            cl_ocl_rdata <= perf_busy_cycles;
+            `CL_LOG(`CL_LOG_MEDIUM, ("[%t] READ: Perf busy cycles = %0d", $realtime, perf_busy_cycles))
+          end
+          else if (rd_addr == 12'h088) begin
+            cl_ocl_rdata <= perf_ocl_writes;
+            `CL_LOG(`CL_LOG_MEDIUM, ("[%t] READ: Perf OCL writes = %0d", $realtime, perf_ocl_writes))
+          end
+          else if (rd_addr == 12'h08C) begin
+            cl_ocl_rdata <= perf_ocl_reads;
+            `CL_LOG(`CL_LOG_MEDIUM, ("[%t] READ: Perf OCL reads = %0d", $realtime, perf_ocl_reads))
+          end
+          else if (rd_addr == 12'h090) begin
+            cl_ocl_rdata <= cmp_count;
+            `CL_LOG(`CL_LOG_MEDIUM, ("[%t] READ: Compaction count = %0d", $realtime, cmp_count))
+          end
+          else if (rd_addr == 12'h0C0) begin
+            cl_ocl_rdata <= cycle_snap[31:0];
+          end
+          else if (rd_addr == 12'h0C4) begin
+            cl_ocl_rdata <= cycle_snap[63:32];
+          end
+          else if (rd_addr == 12'h0C8) begin
+            cl_ocl_rdata <= job_start_cycle[31:0];
+          end
+          else if (rd_addr == 12'h0CC) begin
+            cl_ocl_rdata <= job_start_cycle[63:32];
+          end
+          else if (rd_addr == 12'h0D0) begin
+            cl_ocl_rdata <= job_done_cycle[31:0];
+          end
+          else if (rd_addr == 12'h0D4) begin
+            cl_ocl_rdata <= job_done_cycle[63:32];
+          end
+          else if (rd_addr == 12'h0D8) begin
+            cl_ocl_rdata <= job_doorbell_cycle[31:0];
+          end
+          else if (rd_addr == 12'h0DC) begin
+            cl_ocl_rdata <= job_doorbell_cycle[63:32];
+          end
+          else if (rd_addr >= 12'h100 && rd_addr <= 12'h13C) begin
+            cl_ocl_rdata <= hist_svc[rd_addr[5:2]];
+            `CL_LOG(`CL_LOG_MEDIUM, ("[%t] READ: Start-to-done bin[%0d] = %0d", $realtime, rd_addr[5:2], hist_svc[rd_addr[5:2]]))
+          end
+          else if (rd_addr >= 12'h140 && rd_addr <= 12'h17C) begin
+            cl_ocl_rdata <= hist_react[rd_addr[5:2]];
+            `CL_LOG(`CL_LOG_MEDIUM, ("[%t] READ: Done-to-read bin[%0d] = %0d", $realtime, rd_addr[5:2], hist_react[rd_addr[5:2]]))
+          end
+          else if (rd_addr == 12'h200) begin
+            cl_ocl_rdata <= trace_ctrl;
+          end
+          else if (rd_addr == 12'h204) begin
+            cl_ocl_rdata <= {27'b0, trace_evmask};
+          end
+          else if (rd_addr == 12'h208) begin
+            cl_ocl_rdata <= {20'b0, trace_amatch};
+          end
+          else if (rd_addr == 12'h20C) begin
+            cl_ocl_rdata <= {20'b0, trace_amask};
+          end
+          else if (rd_addr == 12'h210) begin
+            cl_ocl_rdata <= {20'b0, trace_trig_addr};
+          end
+          else if (rd_addr == 12'h214) begin
+            cl_ocl_rdata <= trace_status;
+          end
+          else if (rd_addr == 12'h218) begin
+            cl_ocl_rdata <= {{(32-TRACE_PTR_W){1'b0}}, trace_rd_ptr};
+          end
+          else if (rd_addr == 12'h21C) begin
+            cl_ocl_rdata <= trace_rd_q[127:96];
+          end
+          else if (rd_addr == 12'h220) begin
+            cl_ocl_rdata <= trace_rd_q[95:64];
+          end
+          else if (rd_addr == 12'h224) begin
+            cl_ocl_rdata <= trace_rd_q[63:32];
+          end
+          else if (rd_addr == 12'h228) begin
+            cl_ocl_rdata <= trace_rd_q[31:0];
           end
           else begin
             cl_ocl_rdata <= 32'hDEADBEEF; // Default value
-            $display("[%t] READ: Unknown address 0x%02x, returning 0xDEADBEEF", $realtime, rd_addr);
+            err_rd_unmapped <= 1'b1;
+            `CL_LOG(`CL_LOG_LOW, ("[%t] READ: Unknown address 0x%03x, returning 0xDEADBEEF", $realtime, rd_addr))
           end
           
           if (ocl_cl_rready && cl_ocl_rvalid) begin
@@ -359,23 +1239,184 @@ always @(posedge clk_main_a0)
 // SDA
 //=============================================================================
 
-  // Cause Protocol Violations
+  // Out-of-band engine status for the management PF (BAR4), so monitoring
+  // never competes with application traffic on OCL.
+  //
+  // SDA register map:
+  // 0x00: Engine status (bit 0: busy, 1: done, 2: start, 3: trace enabled,
+  //       [10:8]: error flags)
+  // 0x04: Jobs started since reset
+  // 0x08: Jobs completed since reset
+  // 0x0C: Error flags (bit 0: unmapped OCL read, 1: unmapped OCL write,
+  //       2: start while busy); sticky, write 1 to clear
+  // 0x10/0x14: Cycle counter low/high (reading 0x10 snapshots all 64 bits)
+  // 0x18: Perf - compute busy cycles
+  // 0x1C: Perf - OCL write transactions
+  // 0x20: Perf - OCL read transactions
+  //
+  // cl_sh_status0 mirrors the engine status, cl_sh_status1 the completed
+  // jobs and cl_sh_status2 the started jobs.
+
   always_comb begin
-    cl_sda_bresp   = 'b0;
-    cl_sda_rresp   = 'b0;
-    cl_sda_rvalid  = 'b0;
+    mon_status = 32'h0;
+    mon_status[0] = add_computing;
+    mon_status[1] = add_done;
+    mon_status[2] = add_start;
+    mon_status[3] = trace_ctrl[0];
+    mon_status[10:8] = mon_errors;
+  end
+
+  always_ff @(posedge clk_main_a0) begin
+    if (!rst_main_n_sync) begin
+      mon_jobs_started <= 32'h0;
+      mon_jobs_done <= 32'h0;
+      mon_errors <= 3'b0;
+    end
+    else begin
+      if (job_start)
+        mon_jobs_started <= mon_jobs_started + 1;
+      if (job_done)
+        mon_jobs_done <= mon_jobs_done + 1;
+      // Setting wins over a simultaneous clear
+      mon_errors <= (mon_errors & ~mon_errors_clear) |
+                    {err_start_busy, err_wr_unmapped, r_hs && err_rd_unmapped};
+    end
   end
 
-  // Remaining CL Output Ports
   always_comb begin
-    cl_sda_awready = 'b0;
-    cl_sda_wready  = 'b0;
+    cl_sh_status0 = mon_status;
+    cl_sh_status1 = mon_jobs_done;
+    cl_sh_status2 = mon_jobs_started;
+  end
 
-    cl_sda_bvalid = 'b0;
+  typedef enum logic [1:0] {
+    SDA_WRITE_IDLE,
+    SDA_WRITE_DATA,
+    SDA_WRITE_RESP
+  } sda_write_state_t;
+
+  typedef enum logic [1:0] {
+    SDA_READ_IDLE,
+    SDA_READ_DATA
+  } sda_read_state_t;
 
-    cl_sda_arready = 'b0;
+  sda_write_state_t sda_wr_state;
+  sda_read_state_t sda_rd_state;
+  logic [7:0]  sda_wr_addr;
+  logic [7:0]  sda_rd_addr;
+  logic [63:0] sda_cycle_snap;
 
-    cl_sda_rdata   = 'b0;
+  // Write Channel
+  always_ff @(posedge clk_main_a0) begin
+    if (!rst_main_n_sync) begin
+      sda_wr_state <= SDA_WRITE_IDLE;
+      cl_sda_awready <= 1'b0;
+      cl_sda_wready <= 1'b0;
+      cl_sda_bvalid <= 1'b0;
+      cl_sda_bresp <= 2'b00;
+      sda_wr_addr <= 8'h0;
+      mon_errors_clear <= 3'b0;
+    end
+    else begin
+      mon_errors_clear <= 3'b0;  // single-cycle pulse
+
+      case (sda_wr_state)
+        SDA_WRITE_IDLE: begin
+          cl_sda_awready <= 1'b1;
+          cl_sda_wready <= 1'b0;
+          cl_sda_bvalid <= 1'b0;
+
+          if (sda_cl_awvalid && cl_sda_awready) begin
+            sda_wr_addr <= sda_cl_awaddr[7:0];
+            cl_sda_awready <= 1'b0;
+            sda_wr_state <= SDA_WRITE_DATA;
+          end
+        end
+
+        SDA_WRITE_DATA: begin
+          cl_sda_wready <= 1'b1;
+
+          if (sda_cl_wvalid && cl_sda_wready) begin
+            if (sda_wr_addr == 8'h0C) begin
+              mon_errors_clear <= sda_cl_wdata[2:0];
+              `CL_LOG(`CL_LOG_MEDIUM, ("[%t] SDA WRITE: Clear error flags 0x%x", $realtime, sda_cl_wdata[2:0]))
+            end
+            cl_sda_wready <= 1'b0;
+            sda_wr_state <= SDA_WRITE_RESP;
+          end
+        end
+
+        SDA_WRITE_RESP: begin
+          cl_sda_bvalid <= 1'b1;
+          cl_sda_bresp <= 2'b00; // OKAY response
+
+          if (sda_cl_bready && cl_sda_bvalid) begin
+            cl_sda_bvalid <= 1'b0;
+            sda_wr_state <= SDA_WRITE_IDLE;
+          end
+        end
+      endcase
+    end
+  end
+
+  // Read Channel
+  always_ff @(posedge clk_main_a0) begin
+    if (!rst_main_n_sync) begin
+      sda_rd_state <= SDA_READ_IDLE;
+      cl_sda_arready <= 1'b0;
+      cl_sda_rvalid <= 1'b0;
+      cl_sda_rdata <= 32'h0;
+      cl_sda_rresp <= 2'b00;
+      sda_rd_addr <= 8'h0;
+      sda_cycle_snap <= 64'h0;
+    end
+    else begin
+      case (sda_rd_state)
+        SDA_READ_IDLE: begin
+          cl_sda_arready <= 1'b1;
+          cl_sda_rvalid <= 1'b0;
+
+          if (sda_cl_arvalid && cl_sda_arready) begin
+            sda_rd_addr <= sda_cl_araddr[7:0];
+            if (sda_cl_araddr[7:0] == 8'h10)
+              sda_cycle_snap <= cycle_count;
+            cl_sda_arready <= 1'b0;
+            sda_rd_state <= SDA_READ_DATA;
+          end
+        end
+
+        SDA_READ_DATA: begin
+          cl_sda_rvalid <= 1'b1;
+          cl_sda_rresp <= 2'b00; // OKAY response
+
+          if (sda_rd_addr == 8'h00)
+            cl_sda_rdata <= mon_status;
+          else if (sda_rd_addr == 8'h04)
+            cl_sda_rdata <= mon_jobs_started;
+          else if (sda_rd_addr == 8'h08)
+            cl_sda_rdata <= mon_jobs_done;
+          else if (sda_rd_addr == 8'h0C)
+            cl_sda_rdata <= {29'b0, mon_errors};
+          else if (sda_rd_addr == 8'h10)
+            cl_sda_rdata <= sda_cycle_snap[31:0];
+          else if (sda_rd_addr == 8'h14)
+            cl_sda_rdata <= sda_cycle_snap[63:32];
+          else if (sda_rd_addr == 8'h18)
+            cl_sda_rdata <= perf_busy_cycles;
+          else if (sda_rd_addr == 8'h1C)
+            cl_sda_rdata <= perf_ocl_writes;
+          else if (sda_rd_addr == 8'h20)
+            cl_sda_rdata <= perf_ocl_reads;
+          else
+            cl_sda_rdata <= 32'hDEADBEEF;
+
+          if (sda_cl_rready && cl_sda_rvalid) begin
+            cl_sda_rvalid <= 1'b0;
+            sda_rd_state <= SDA_READ_IDLE;
+          end
+        end
+      endcase
+    end
   end
 
 //=============================================================================
@@ -0,0 +1,98 @@
+/*
+ * Copyright 2015-2024 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Reference semantics of the ALU kernel (cl_kernel_alu.sv).
+//
+// cl_top_alu_apply() computes one lane exactly as the RTL does; the host
+// checks card results against it and the model uses it to produce them.
+// Plain C with no SDK dependency, like cl_top_model.h.
+
+#ifndef CL_TOP_ALU_H
+#define CL_TOP_ALU_H
+
+#include <stdint.h>
+#include <string.h>
+
+#include "cl_top_regs.h"
+
+static const char *const cl_top_alu_op_names[ALU_NUM_OPS] = {
+    "add", "sub", "and", "or", "xor", "shl", "shr", "sra", "adds", "addss",
+};
+
+static inline uint32_t cl_top_alu_apply(uint32_t op, uint32_t k, uint32_t x) {
+    uint32_t s;
+
+    switch (op & 0xF) {
+    case ALU_OP_ADD:    return x + k;
+    case ALU_OP_SUB:    return x - k;
+    case ALU_OP_AND:    return x & k;
+    case ALU_OP_OR:     return x | k;
+    case ALU_OP_XOR:    return x ^ k;
+    case ALU_OP_SHL:    return x << (k & 31);
+    case ALU_OP_SHR:    return x >> (k & 31);
+    case ALU_OP_SRA:    return (uint32_t)((int32_t)x >> (k & 31));
+    case ALU_OP_ADD_SAT:
+        s = x + k;
+        return s < x ? UINT32_MAX : s;
+    case ALU_OP_ADD_SAT_S:
+        s = x + k;
+        // Overflow when both operands share a sign the sum does not
+        if (~(x ^ k) & (x ^ s) & 0x80000000u) {
+            return (x & 0x80000000u) ? 0x80000000u : 0x7FFFFFFFu;
+        }
+        return s;
+    default:            return x;
+    }
+}
+
+// Every lane of in[] through one operation. The switch is hoisted out of
+// the loop so each case compiles to a vector loop.
+static inline void cl_top_alu_apply_n(uint32_t op, uint32_t k, const uint32_t *in, uint32_t *out,
+                                      int n) {
+#define CL_TOP_ALU_LOOP(expr)                   \
+    for (int i = 0; i < n; i++) {               \
+        uint32_t x = in[i];                     \
+        out[i] = (expr);                        \
+    }                                           \
+    break
+
+    switch (op & 0xF) {
+    case ALU_OP_ADD:    CL_TOP_ALU_LOOP(x + k);
+    case ALU_OP_SUB:    CL_TOP_ALU_LOOP(x - k);
+    case ALU_OP_AND:    CL_TOP_ALU_LOOP(x & k);
+    case ALU_OP_OR:     CL_TOP_ALU_LOOP(x | k);
+    case ALU_OP_XOR:    CL_TOP_ALU_LOOP(x ^ k);
+    case ALU_OP_SHL:    CL_TOP_ALU_LOOP(x << (k & 31));
+    case ALU_OP_SHR:    CL_TOP_ALU_LOOP(x >> (k & 31));
+    default:            CL_TOP_ALU_LOOP(cl_top_alu_apply(op, k, x));
+    }
+#undef CL_TOP_ALU_LOOP
+}
+
+static inline const char *cl_top_alu_op_name(uint32_t op) {
+    return op < ALU_NUM_OPS ? cl_top_alu_op_names[op] : "pass";
+}
+
+// Opcode for a name from cl_top_alu_op_names, or -1
+static inline int cl_top_alu_op_parse(const char *name) {
+    for (int i = 0; i < ALU_NUM_OPS; i++) {
+        if (strcmp(name, cl_top_alu_op_names[i]) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+#endif // CL_TOP_ALU_H
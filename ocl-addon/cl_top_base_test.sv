@@ -16,18 +16,115 @@
 // ============================================================================
 
 `include "common_base_test.svh"
+`include "cl_top_log.svh"
 
 module cl_top_base_test();
    import tb_type_defines_pkg::*;
 
+   `CL_LOG_INIT
+
+   // Host wall clock in milliseconds (cl_top_wall_clock.c), for comparing
+   // simulation cost
+   import "DPI-C" function longint cl_top_wall_ms();
+
+   // Performance monitors on both AXI-Lite slaves of the CL; summaries print
+   // at the end of every test
+   bind cl_top axil_perf_mon #(.NAME("ocl")) ocl_perf_mon (
+      .clk(clk_main_a0), .rst_n(rst_main_n_sync),
+      .awvalid(ocl_cl_awvalid), .awready(cl_ocl_awready),
+      .wvalid(ocl_cl_wvalid),   .wready(cl_ocl_wready),
+      .bvalid(cl_ocl_bvalid),   .bready(ocl_cl_bready),
+      .arvalid(ocl_cl_arvalid), .arready(cl_ocl_arready),
+      .rvalid(cl_ocl_rvalid),   .rready(ocl_cl_rready));
+
+   bind cl_top axil_perf_mon #(.NAME("sda")) sda_perf_mon (
+      .clk(clk_main_a0), .rst_n(rst_main_n_sync),
+      .awvalid(sda_cl_awvalid), .awready(cl_sda_awready),
+      .wvalid(sda_cl_wvalid),   .wready(cl_sda_wready),
+      .bvalid(cl_sda_bvalid),   .bready(sda_cl_bready),
+      .arvalid(sda_cl_arvalid), .arready(cl_sda_arready),
+      .rvalid(cl_sda_rvalid),   .rready(sda_cl_rready));
+
    // Simple Add-One register addresses
    `define INPUT_BASE    64'h00    // Input registers 0x00-0x1C (8 regs)
    `define OUTPUT_BASE   64'h20    // Output registers 0x20-0x3C (8 regs)
    `define CONTROL_REG   64'h40    // Control register
    `define STATUS_REG    64'h44    // Status register
+   `define KERNEL_ID_REG   64'h048 // Kernel ID ([15:0] ID, [31:16] version)
+   `define KERNEL_CAPS_REG 64'h04C // Kernel capabilities ([7:0] lanes, [15:8] latency)
+   `define KERNEL_ADD_ONE  16'h0001
+   `define KERNEL_ALU      16'h0002
+   `define KERNEL_SCAN     16'h0003
+   `define KERNEL_FLAG_ALU 32'h00010000 // Capabilities: honors the job opcode/operand
+   `define KERNEL_FLAG_SCAN 32'h00020000 // Capabilities: prefix sum, carry across jobs
+   `define JOB_OPCODE_REG  64'h050 // ALU opcode ([3:0]); scan: bit 0 exclusive, bit 1 load
+   `define JOB_OPERAND_REG 64'h054 // ALU scalar operand
+   `define PRED_CTRL_REG   64'h058 // Predicate ([2:0] op, bit 3 signed)
+   `define PRED_VALUE_REG  64'h05C // Predicate comparison value
+   `define RED_CTRL_REG    64'h060 // Reduction control (accumulate, clear, results, [15:8] mask)
+   `define RED_SUM_LO      64'h064 // Reduction results: sum low/high, min, max, count, words
+   `define RED_ACCUMULATE  32'h00000001
+   `define RED_CLEAR       32'h00000002
+   `define RED_RESULTS     32'h00000004
+   `define RED_MASK_ALL    32'h0000FF00
+   `define COMPACT_CTRL_REG 64'h07C // Compaction control (enable, results, [15:8] mask)
+   `define COMPACT_COUNT   64'h090 // Words kept by the last job
+   `define COMPACT_ENABLE  32'h00000001
+   `define COMPACT_RESULTS 32'h00000002
+   `define HWTS_CYCLE_LO   64'h0C0 // Free-running cycle counter (low/high)
+   `define HWTS_START_LO   64'h0C8 // Cycle the last job started (low/high)
+   `define HWTS_DONE_LO    64'h0D0 // Cycle the last job completed (low/high)
+   `define HWTS_DOORBELL_LO 64'h0D8 // Last OCL write before start (low/high)
+   `define HIST_SVC_BASE   64'h100 // Start-to-done histogram (16 bins)
+   `define HIST_REACT_BASE 64'h140 // Done-to-status-read histogram (16 bins)
+   `define HIST_CTRL       64'h180 // Histogram control (bit 0: clear)
+   `define SDA_STATUS      64'h00  // SDA: engine status
+   `define SDA_JOBS_STARTED 64'h04 // SDA: jobs started
+   `define SDA_JOBS_DONE   64'h08  // SDA: jobs completed
+   `define SDA_ERRORS      64'h0C  // SDA: sticky error flags (W1C)
    `define START_BIT     32'h00000001
    `define DONE_BIT      32'h00000001
 
+   // Default per-operation budgets (cycles); override them with
+   // +POKE_BUDGET=, +PEEK_BUDGET= and +BATCH_BUDGET=
+   `define POKE_BUDGET_DEFAULT    64
+   `define PEEK_BUDGET_DEFAULT    64
+   `define BATCH_BUDGET_DEFAULT   1024
+   `define PERF_SAMPLES           16
+
+   // Completion waits block on the engine's done flag instead of polling
+   `define DONE_TIMEOUT_CYCLES 10000
+
+   // Stress test: OCL pins of the CL are driven directly, bypassing the BFM
+   `define CL_PATH          tb.card.fpga.CL
+   `define STRESS_WRITES    256
+   `define STRESS_TIMEOUT   100000   // cycles per phase
+
+   `define LOG_BATCHES_DEFAULT 64   // +LOG_BATCHES= for test_log_throughput
+
+   // Post-power-up checkpoint. +CHECKPOINT_SAVE=<file> saves the simulation
+   // once the shell is up and stops; a restored run resumes from that point.
+   // VCS saves with $save and restores with 'simv -r <file>'; other
+   // simulators stop so the run script can save (xrun 'save', vsim
+   // 'checkpoint') and restore with their own restart command.
+`ifdef VCS
+   `define CL_CHECKPOINT_SAVE(file) $save(file);
+`else
+   `define CL_CHECKPOINT_SAVE(file) $stop;
+`endif
+
+   // Bulk dataset test (+BULK_BATCHES=, +BULK_INPUT=<hex file>)
+   `define BULK_BATCHES_DEFAULT 256
+
+   // Backdoor image test: OCL trace buffer registers
+   `define TRACE_CTRL_REG   64'h200 // Trace control (bit 0 enable, bit 1 clear)
+   `define TRACE_STATUS_REG 64'h214 // [10:0] entries recorded
+   `define TRACE_RD_PTR_REG 64'h218 // Drain pointer
+   `define TRACE_DATA0_REG  64'h21C // Entry at the pointer, high word first; DATA3 advances
+   `define TRACE_CTRL_CLEAR 32'h00000002
+   `define TRACE_DEPTH      1024
+   `define TRACE_DRAIN      16      // entries drained over OCL
+
    // Test data
    logic [31:0] test_input_data [0:7];
    logic [31:0] read_output_data [0:7];
@@ -35,20 +132,85 @@ module cl_top_base_test();
    logic [31:0] status_data;
    logic [31:0] read_data;
    int poll_count;
+   bit done_ok;
    int error_count;
+   realtime clk_period;   // measured clk_main_a0 period, for cycle counts
+
+   // Test selected with +TEST=<name> (default all); +SEED=<n> seeds $urandom
+   string test_name;
+   int unsigned test_seed;
+   string checkpoint_file;
 
    initial begin
       error_count = 0;
       
       tb.power_up();
-      
-      $display("[%t] Starting Simple Add-One Test", $realtime);
 
       // Wait for system to stabilize
       tb.nsec_delay(1000);
+
+      // Everything up to here is identical for every test; save it once and
+      // restore it per run. Run options are read after this point so a
+      // restored run picks up its own command line.
+      if ($value$plusargs("CHECKPOINT_SAVE=%s", checkpoint_file)) begin
+         `CL_CHECKPOINT_SAVE(checkpoint_file)
+         if ($value$plusargs("CHECKPOINT_SAVE=%s", checkpoint_file)) begin
+            $display("[%t] CHECKPOINT saved %s after power-up", $realtime, checkpoint_file);
+            $finish;
+         end
+         $display("[%t] CHECKPOINT restored", $realtime);
+         void'($value$plusargs("CL_VERBOSITY=%d", cl_log_level));
+         void'($value$plusargs("CL_VERBOSITY=%d", `CL_PATH.cl_log_level));
+      end
+
+      if (!$value$plusargs("TEST=%s", test_name))
+         test_name = "all";
+      if ($value$plusargs("SEED=%d", test_seed))
+         process::self().srandom(test_seed);
       
-      // Test sequence
-      test_add_one();
+      measure_clk_period();
+      $display("[%t] Starting Simple Add-One Test: %s", $realtime, test_name);
+      
+      // Test sequence. The functional checks after test_add_one expect
+      // exactly its two jobs, so they run as one group.
+      case (test_name)
+        "add_one": begin
+           test_kernel_id();
+           test_add_one();
+           test_hw_timestamps();
+           test_sda_monitor();
+           test_latency_histogram();
+        end
+        "alu":          test_alu_ops();
+        "reduce":       test_reduce();
+        "scan":         test_scan();
+        "compact":      test_compact();
+        "perf_budget":  test_perf_budget();
+        "ocl_stress":   test_ocl_stress();
+        "bulk_dataset": test_bulk_dataset();
+        "backdoor":     test_backdoor_images();
+        "log_throughput": test_log_throughput();
+        "all": begin
+           test_kernel_id();
+           test_add_one();
+           test_hw_timestamps();
+           test_sda_monitor();
+           test_latency_histogram();
+           test_alu_ops();
+           test_reduce();
+           test_scan();
+           test_compact();
+           test_perf_budget();
+           test_ocl_stress();
+           test_bulk_dataset();
+           test_backdoor_images();
+        end
+        default: begin
+           $error("[%t] NO Unknown test '%s' (add_one, alu, reduce, scan, compact, perf_budget, ocl_stress, bulk_dataset, backdoor, log_throughput, all)",
+                  $realtime, test_name);
+           error_count++;
+        end
+      endcase
       
       // Final delay
       tb.nsec_delay(500);
@@ -56,9 +218,9 @@ module cl_top_base_test();
       
       // Report results
       if (error_count == 0) begin
-         $display("🎉 TEST PASSED: Simple Add-One test completed successfully");
+         $display("🎉 TEST PASSED: Simple Add-One test completed successfully (%s)", test_name);
       end else begin
-         $display("💥 TEST FAILED: %0d errors detected", error_count);
+         $display("💥 TEST FAILED: %0d errors detected (%s)", error_count, test_name);
       end
       
       report_pass_fail_status();
@@ -68,29 +230,28 @@ module cl_top_base_test();
    // Main test task
    task test_add_one();
       begin
-         $display("[%t] === SIMPLE ADD-ONE TEST ===", $realtime);
+         `CL_LOG(`CL_LOG_LOW, ("[%t] === SIMPLE ADD-ONE TEST ===", $realtime))
          
          // Step 1: Initialize test data
-         $display("[%t] Step 1: Initializing test data", $realtime);
+         `CL_LOG(`CL_LOG_LOW, ("[%t] Step 1: Initializing test data", $realtime))
          for (int i = 0; i < 8; i++) begin
             test_input_data[i] = 32'h10000000 + i;  // Simple pattern
             expected_output_data[i] = test_input_data[i] + 1;  // Expected result
          end
          
          // Step 2: Clear control register
-         $display("[%t] Step 2: Clearing control register", $realtime);
+         `CL_LOG(`CL_LOG_LOW, ("[%t] Step 2: Clearing control register", $realtime))
          tb.poke_ocl(.addr(`CONTROL_REG), .data(32'h00000000));
-         tb.nsec_delay(100);
          
          // Step 3: Write input data
-         $display("[%t] Step 3: Writing input data", $realtime);
+         `CL_LOG(`CL_LOG_LOW, ("[%t] Step 3: Writing input data", $realtime))
          for (int i = 0; i < 8; i++) begin
             tb.poke_ocl(.addr(`INPUT_BASE + (i * 4)), .data(test_input_data[i]));
-            $display("[%t]   Input[%0d] = 0x%08x", $realtime, i, test_input_data[i]);
+            `CL_LOG(`CL_LOG_MEDIUM, ("[%t]   Input[%0d] = 0x%08x", $realtime, i, test_input_data[i]))
          end
          
          // Step 4: Verify input data readback
-         $display("[%t] Step 4: Verifying input data readback", $realtime);
+         `CL_LOG(`CL_LOG_LOW, ("[%t] Step 4: Verifying input data readback", $realtime))
          for (int i = 0; i < 8; i++) begin
             tb.peek_ocl(.addr(`INPUT_BASE + (i * 4)), .data(read_data));
             if (read_data !== test_input_data[i]) begin
@@ -98,53 +259,41 @@ module cl_top_base_test();
                       $realtime, i, test_input_data[i], read_data);
                error_count++;
             end else begin
-               $display("[%t]   OK Input[%0d] readback: 0x%08x", $realtime, i, read_data);
+               `CL_LOG(`CL_LOG_MEDIUM, ("[%t]   OK Input[%0d] readback: 0x%08x", $realtime, i, read_data))
             end
          end
          
          // Step 5: Check initial status
          tb.peek_ocl(.addr(`STATUS_REG), .data(status_data));
-         $display("[%t] Step 5: Initial status: 0x%08x", $realtime, status_data);
+         `CL_LOG(`CL_LOG_LOW, ("[%t] Step 5: Initial status: 0x%08x", $realtime, status_data))
          
          // Step 6: Start computation
-         $display("[%t] Step 6: Starting Add-One computation", $realtime);
+         `CL_LOG(`CL_LOG_LOW, ("[%t] Step 6: Starting Add-One computation", $realtime))
          tb.poke_ocl(.addr(`CONTROL_REG), .data(`START_BIT));
-         tb.nsec_delay(100);
          
          // Step 7: Wait for completion
-         $display("[%t] Step 7: Waiting for computation to complete", $realtime);
-         poll_count = 0;
-         status_data = 32'h0;
-         
-         while ((status_data & `DONE_BIT) == 0 && poll_count < 100) begin
-            tb.nsec_delay(100); // 100ns delay between polls
-            tb.peek_ocl(.addr(`STATUS_REG), .data(status_data));
-            poll_count++;
-            
-            if (poll_count % 10 == 0) begin
-               $display("[%t]   Polling... count=%0d, status=0x%08x", 
-                        $realtime, poll_count, status_data);
-            end
-         end
-         
-         if (poll_count >= 100) begin
-            $error("[%t] NO Timeout waiting for Add-One completion after %0d polls", $realtime, poll_count);
+         `CL_LOG(`CL_LOG_LOW, ("[%t] Step 7: Waiting for computation to complete", $realtime))
+         wait_done(1'b1, done_ok);
+         if (!done_ok) begin
+            $error("[%t] NO Timeout waiting for Add-One completion after %0d cycles",
+                   $realtime, `DONE_TIMEOUT_CYCLES);
             error_count++;
             return;
          end
-         
-         $display("[%t] OK Add-One computation completed after %0d polls", $realtime, poll_count);
+         `CL_LOG(`CL_LOG_LOW, ("[%t] OK Add-One computation completed at cycle %0d (%0d cycles)",
+                  $realtime, `CL_PATH.job_done_cycle,
+                  `CL_PATH.job_done_cycle - `CL_PATH.job_start_cycle))
          
          // Step 8: Clear start bit
-         $display("[%t] Step 8: Clearing start bit", $realtime);
+         `CL_LOG(`CL_LOG_LOW, ("[%t] Step 8: Clearing start bit", $realtime))
          tb.poke_ocl(.addr(`CONTROL_REG), .data(32'h00000000));
-         tb.nsec_delay(100);
+         wait_done(1'b0, done_ok);
          
          // Step 9: Read output data
-         $display("[%t] Step 9: Reading output data", $realtime);
+         `CL_LOG(`CL_LOG_LOW, ("[%t] Step 9: Reading output data", $realtime))
          for (int i = 0; i < 8; i++) begin
             tb.peek_ocl(.addr(`OUTPUT_BASE + (i * 4)), .data(read_output_data[i]));
-            $display("[%t]   Output[%0d] = 0x%08x", $realtime, i, read_output_data[i]);
+            `CL_LOG(`CL_LOG_MEDIUM, ("[%t]   Output[%0d] = 0x%08x", $realtime, i, read_output_data[i]))
          end
          
          // Step 10: Verify results
@@ -160,21 +309,21 @@ module cl_top_base_test();
       int correct_count;
       logic is_correct;
       begin
-         $display("[%t] === VERIFYING RESULTS ===", $realtime);
+         `CL_LOG(`CL_LOG_LOW, ("[%t] === VERIFYING RESULTS ===", $realtime))
          
          correct_count = 0;
          
-         $display("INPUT -> OUTPUT COMPARISON:");
-         $display("Reg# | Input      | Output     | Expected   | Status");
-         $display("-----|------------|------------|------------|-------");
+         `CL_LOG(`CL_LOG_LOW, ("INPUT -> OUTPUT COMPARISON:"))
+         `CL_LOG(`CL_LOG_LOW, ("Reg# | Input      | Output     | Expected   | Status"))
+         `CL_LOG(`CL_LOG_LOW, ("-----|------------|------------|------------|-------"))
          
          for (int i = 0; i < 8; i++) begin
             is_correct = (read_output_data[i] == expected_output_data[i]);
             if (is_correct) correct_count++;
             
-            $display("%2d   | 0x%08x | 0x%08x | 0x%08x | %s", 
+            `CL_LOG(`CL_LOG_LOW, ("%2d   | 0x%08x | 0x%08x | 0x%08x | %s", 
                      i, test_input_data[i], read_output_data[i], 
-                     expected_output_data[i], is_correct ? "OK PASS" : "NO FAIL");
+                     expected_output_data[i], is_correct ? "OK PASS" : "NO FAIL"))
             
             if (!is_correct) begin
                $error("[%t] NO Output mismatch at reg %0d", $realtime, i);
@@ -182,14 +331,14 @@ module cl_top_base_test();
             end
          end
          
-         $display("\nSUMMARY:");
-         $display("  Correct results: %0d/8", correct_count);
-         $display("  Accuracy: %0d%%", (correct_count * 100) / 8);
+         `CL_LOG(`CL_LOG_LOW, ("\nSUMMARY:"))
+         `CL_LOG(`CL_LOG_LOW, ("  Correct results: %0d/8", correct_count))
+         `CL_LOG(`CL_LOG_LOW, ("  Accuracy: %0d%%", (correct_count * 100) / 8))
          
          if (correct_count == 8) begin
-            $display("[%t] 🎉 ALL OUTPUTS CORRECT! Add-One operation working perfectly!", $realtime);
+            `CL_LOG(`CL_LOG_LOW, ("[%t] 🎉 ALL OUTPUTS CORRECT! Add-One operation working perfectly!", $realtime))
          end else begin
-            $display("[%t] 💥 SOME OUTPUTS INCORRECT! Add-One operation has issues.", $realtime);
+            `CL_LOG(`CL_LOG_LOW, ("[%t] 💥 SOME OUTPUTS INCORRECT! Add-One operation has issues.", $realtime))
          end
       end
    endtask
@@ -198,10 +347,9 @@ module cl_top_base_test();
    task test_multiple_operations();
       logic [31:0] test_data2 [0:7];
       logic [31:0] output_data2 [0:7];
-      logic [31:0] temp_status;
       logic is_correct;
       begin
-         $display("[%t] === TESTING MULTIPLE OPERATIONS ===", $realtime);
+         `CL_LOG(`CL_LOG_LOW, ("[%t] === TESTING MULTIPLE OPERATIONS ===", $realtime))
          
          // Prepare second test data
          for (int i = 0; i < 8; i++) begin
@@ -209,47 +357,1140 @@ module cl_top_base_test();
          end
          
          // Write new input data
-         $display("[%t] Writing second test data", $realtime);
+         `CL_LOG(`CL_LOG_LOW, ("[%t] Writing second test data", $realtime))
          for (int i = 0; i < 8; i++) begin
             tb.poke_ocl(.addr(`INPUT_BASE + (i * 4)), .data(test_data2[i]));
          end
          
          // Start second computation
-         $display("[%t] Starting second computation", $realtime);
+         `CL_LOG(`CL_LOG_LOW, ("[%t] Starting second computation", $realtime))
          tb.poke_ocl(.addr(`CONTROL_REG), .data(`START_BIT));
-         tb.nsec_delay(100);
          
          // Wait for completion
-         poll_count = 0;
-         temp_status = 32'h0;
-         while ((temp_status & `DONE_BIT) == 0 && poll_count < 100) begin
-            tb.nsec_delay(100);
-            tb.peek_ocl(.addr(`STATUS_REG), .data(temp_status));
-            poll_count++;
-         end
-         
-         if (poll_count >= 100) begin
-            $display("[%t] ⚠️  Second computation timed out", $realtime);
+         wait_done(1'b1, done_ok);
+         if (!done_ok) begin
+            `CL_LOG(`CL_LOG_LOW, ("[%t] ⚠️  Second computation timed out", $realtime))
          end else begin
-            $display("[%t] OK Second computation completed after %0d polls", $realtime, poll_count);
-            
             // Clear start bit
             tb.poke_ocl(.addr(`CONTROL_REG), .data(32'h00000000));
-            tb.nsec_delay(100);
+            wait_done(1'b0, done_ok);
             
             // Read second results
             for (int i = 0; i < 8; i++) begin
                tb.peek_ocl(.addr(`OUTPUT_BASE + (i * 4)), .data(output_data2[i]));
                is_correct = (output_data2[i] == (test_data2[i] + 1));
-               $display("[%t]   Second test[%0d]: 0x%08x + 1 = 0x%08x %s", 
+               `CL_LOG(`CL_LOG_MEDIUM, ("[%t]   Second test[%0d]: 0x%08x + 1 = 0x%08x %s", 
                         $realtime, i, test_data2[i], output_data2[i], 
-                        is_correct ? "OK" : "NO");
+                        is_correct ? "OK" : "NO"))
                if (!is_correct) error_count++;
             end
          end
          
-         $display("[%t] Multiple operations test completed", $realtime);
+         `CL_LOG(`CL_LOG_LOW, ("[%t] Multiple operations test completed", $realtime))
+      end
+   endtask
+
+   // Block until the engine's done flag equals 'level' instead of polling
+   // STATUS over OCL, giving up after DONE_TIMEOUT_CYCLES. On a rising done
+   // the cycle the result became available is reported, and one frontdoor
+   // STATUS read confirms the register view agrees with the flag. The race
+   // runs in its own fork so disabling the loser leaves the caller's
+   // background processes alone.
+   task automatic wait_done(input logic level, output bit ok);
+      logic [31:0] status;
+      ok = 0;
+      fork
+         begin
+            fork
+               begin
+                  wait (`CL_PATH.add_done === level);
+                  ok = 1;
+               end
+               repeat (`DONE_TIMEOUT_CYCLES) @(posedge `CL_PATH.clk_main_a0);
+            join_any
+            disable fork;
+         end
+      join
+      if (!ok || level !== 1'b1)
+         return;
+      `CL_LOG(`CL_LOG_MEDIUM, ("[%t] OK Done at cycle %0d, %0d cycles after start", $realtime,
+               `CL_PATH.job_done_cycle, `CL_PATH.job_done_cycle - `CL_PATH.job_start_cycle))
+      tb.peek_ocl(.addr(`STATUS_REG), .data(status));
+      if ((status & `DONE_BIT) == 0) begin
+         $error("[%t] NO Done flag set but STATUS read 0x%08x", $realtime, status);
+         error_count++;
+      end
+   endtask
+
+   // Read a 64-bit timestamp register pair, low word first
+   task read_ts64(input logic [63:0] lo_addr, output logic [63:0] ts);
+      logic [31:0] lo;
+      logic [31:0] hi;
+      begin
+         tb.peek_ocl(.addr(lo_addr), .data(lo));
+         tb.peek_ocl(.addr(lo_addr + 4), .data(hi));
+         ts = {hi, lo};
+      end
+   endtask
+
+   // Kernel slot discovery. The add-one and ALU kernels compute add-one out
+   // of reset; only the ALU kernel advertises the job opcode/operand. A scan
+   // kernel build runs +TEST=scan instead of the add-one group.
+   task test_kernel_id();
+      logic [31:0] id;
+      logic [31:0] caps;
+      begin
+         tb.peek_ocl(.addr(`KERNEL_ID_REG), .data(id));
+         tb.peek_ocl(.addr(`KERNEL_CAPS_REG), .data(caps));
+         `CL_LOG(`CL_LOG_LOW, ("[%t] Kernel ID 0x%08x, capabilities 0x%08x", $realtime, id, caps))
+         if (id[15:0] !== `KERNEL_ADD_ONE && id[15:0] !== `KERNEL_ALU &&
+             id[15:0] !== `KERNEL_SCAN) begin
+            $error("[%t] NO Kernel ID 0x%04x, expected add-one, ALU or scan", $realtime, id[15:0]);
+            error_count++;
+         end
+         if (((caps & `KERNEL_FLAG_ALU) != 0) !== (id[15:0] === `KERNEL_ALU)) begin
+            $error("[%t] NO Kernel 0x%04x has ALU flag %0d", $realtime, id[15:0],
+                   (caps & `KERNEL_FLAG_ALU) != 0);
+            error_count++;
+         end
+         if (((caps & `KERNEL_FLAG_SCAN) != 0) !== (id[15:0] === `KERNEL_SCAN)) begin
+            $error("[%t] NO Kernel 0x%04x has scan flag %0d", $realtime, id[15:0],
+                   (caps & `KERNEL_FLAG_SCAN) != 0);
+            error_count++;
+         end
+         if (caps[7:0] !== 8'd8) begin
+            $error("[%t] NO Kernel reports %0d lanes, expected 8", $realtime, caps[7:0]);
+            error_count++;
+         end
+      end
+   endtask
+
+   // Reference for the ALU kernel (cl_top_alu.h is the C twin), computed in
+   // 64 bits instead of from carry bits so it does not mirror the RTL
+   function automatic logic [31:0] alu_ref(input logic [3:0] op, input logic [31:0] x,
+                                           input logic [31:0] k);
+      longint wide;
+      case (op)
+         4'h0: return x + k;
+         4'h1: return x - k;
+         4'h2: return x & k;
+         4'h3: return x | k;
+         4'h4: return x ^ k;
+         4'h5: return x << k[4:0];
+         4'h6: return x >> k[4:0];
+         4'h7: return 32'(longint'($signed(x)) >>> k[4:0]);
+         4'h8: begin
+            wide = longint'(x) + longint'(k);
+            return wide > 64'hFFFFFFFF ? 32'hFFFFFFFF : 32'(wide);
+         end
+         4'h9: begin
+            wide = longint'($signed(x)) + longint'($signed(k));
+            if (wide > 64'sh7FFFFFFF) return 32'h7FFFFFFF;
+            if (wide < -64'sh80000000) return 32'h80000000;
+            return 32'(wide);
+         end
+         default: return x;
+      endcase
+   endfunction
+
+   // Every opcode, reserved ones included, against edge-case lanes and
+   // operands. Restores add with K = 1 for the tests that follow.
+   task test_alu_ops();
+      logic [31:0] caps;
+      logic [31:0] lanes [0:7];
+      logic [31:0] ks [0:4];
+      logic [31:0] data;
+      logic [31:0] want;
+      begin
+         `CL_LOG(`CL_LOG_LOW, ("[%t] === ALU KERNEL TEST ===", $realtime))
+         tb.peek_ocl(.addr(`KERNEL_CAPS_REG), .data(caps));
+         if ((caps & `KERNEL_FLAG_ALU) == 0) begin
+            `CL_LOG(`CL_LOG_LOW, ("[%t] Kernel has no ALU, skipped", $realtime))
+            return;
+         end
+
+         lanes = '{32'h00000000, 32'h00000001, 32'h7FFFFFFF, 32'h80000000,
+                   32'hFFFFFFFF, 32'h80000001, 32'h12345678, 32'hFFFFFFFE};
+         ks = '{32'h00000001, 32'h7FFFFFFF, 32'h80000000, 32'hFFFFFFFF, 32'h00000023};
+         for (int i = 0; i < 8; i++)
+            tb.poke_ocl(.addr(`INPUT_BASE + (i * 4)), .data(lanes[i]));
+
+         for (int op = 0; op < 16; op++) begin
+            foreach (ks[j]) begin
+               tb.poke_ocl(.addr(`JOB_OPCODE_REG), .data(op));
+               tb.poke_ocl(.addr(`JOB_OPERAND_REG), .data(ks[j]));
+               run_batch();
+               for (int i = 0; i < 8; i++) begin
+                  tb.peek_ocl(.addr(`OUTPUT_BASE + (i * 4)), .data(data));
+                  want = alu_ref(op, lanes[i], ks[j]);
+                  if (data !== want) begin
+                     $error("[%t] NO ALU op %0d K=0x%08x lane %0d: 0x%08x -> 0x%08x, expected 0x%08x",
+                            $realtime, op, ks[j], i, lanes[i], data, want);
+                     error_count++;
+                  end
+               end
+            end
+         end
+
+         tb.poke_ocl(.addr(`JOB_OPCODE_REG), .data(32'h0));
+         tb.poke_ocl(.addr(`JOB_OPERAND_REG), .data(32'h1));
+         `CL_LOG(`CL_LOG_LOW, ("[%t] ALU kernel test completed (%0d jobs)", $realtime, 16 * 5))
+      end
+   endtask
+
+   // Predicate reference (cl_top_reduce.h is the C twin), comparing sign- or
+   // zero-extended 64-bit values
+   function automatic bit pred_ref(input logic [3:0] ctrl, input logic [31:0] value,
+                                   input logic [31:0] x);
+      longint a;
+      longint b;
+      a = ctrl[3] ? longint'($signed(x)) : longint'(x);
+      b = ctrl[3] ? longint'($signed(value)) : longint'(value);
+      case (ctrl[2:0])
+         3'd0: return 1'b1;
+         3'd1: return a == b;
+         3'd2: return a != b;
+         3'd3: return a < b;
+         3'd4: return a <= b;
+         3'd5: return a > b;
+         3'd6: return a >= b;
+         default: return 1'b0;
+      endcase
+   endfunction
+
+   // Reduction results against an expected sum, min, max, count and words
+   task check_reduce(input string what, input logic [63:0] sum, input logic [31:0] min,
+                     input logic [31:0] max, input logic [31:0] count, input logic [31:0] words);
+      logic [31:0] got [0:5];
+      logic [31:0] want [0:5];
+      begin
+         want = '{sum[31:0], sum[63:32], min, max, count, words};
+         for (int i = 0; i < 6; i++) begin
+            tb.peek_ocl(.addr(`RED_SUM_LO + (i * 4)), .data(got[i]));
+            if (got[i] !== want[i]) begin
+               $error("[%t] NO Reduction %s: register 0x%03x is 0x%08x, expected 0x%08x",
+                      $realtime, what, `RED_SUM_LO + (i * 4), got[i], want[i]);
+               error_count++;
+            end
+         end
+      end
+   endtask
+
+   // Every predicate, signed and unsigned, over edge-case lanes; then lane
+   // masks, accumulation across jobs, clear, and reducing the result beat.
+   // Restores the reset predicate and reduction settings.
+   task test_reduce();
+      logic [31:0] lanes [0:7];
+      logic [31:0] values [0:2];
+      logic [31:0] data;
+      logic [31:0] caps;
+      logic [3:0]  ctrl;
+      longint      sum;
+      logic [31:0] min;
+      logic [31:0] max;
+      int          count;
+      int          words;
+      int          jobs;
+      begin
+         `CL_LOG(`CL_LOG_LOW, ("[%t] === REDUCTION ENGINE TEST ===", $realtime))
+         jobs = 0;
+         tb.peek_ocl(.addr(`RED_CTRL_REG), .data(data));
+         if (data !== `RED_MASK_ALL) begin
+            $error("[%t] NO Reduction control resets to 0x%08x, expected 0x%08x",
+                   $realtime, data, `RED_MASK_ALL);
+            error_count++;
+         end
+
+         lanes = '{32'h00000000, 32'h00000001, 32'h7FFFFFFF, 32'h80000000,
+                   32'hFFFFFFFF, 32'h80000001, 32'h00000001, 32'hFFFFFFFE};
+         values = '{32'h00000001, 32'h80000000, 32'hFFFFFFFF};
+         for (int i = 0; i < 8; i++)
+            tb.poke_ocl(.addr(`INPUT_BASE + (i * 4)), .data(lanes[i]));
+
+         for (int c = 0; c < 16; c++) begin
+            ctrl = c;
+            sum = 0;
+            min = lanes[0];
+            max = lanes[0];
+            for (int i = 0; i < 8; i++) begin
+               sum += ctrl[3] ? longint'($signed(lanes[i])) : longint'(lanes[i]);
+               if (ctrl[3] ? $signed(lanes[i]) < $signed(min) : lanes[i] < min)
+                  min = lanes[i];
+               if (ctrl[3] ? $signed(lanes[i]) > $signed(max) : lanes[i] > max)
+                  max = lanes[i];
+            end
+            foreach (values[v]) begin
+               count = 0;
+               for (int i = 0; i < 8; i++)
+                  count += pred_ref(ctrl, values[v], lanes[i]);
+               tb.poke_ocl(.addr(`PRED_CTRL_REG), .data(ctrl));
+               tb.poke_ocl(.addr(`PRED_VALUE_REG), .data(values[v]));
+               run_batch();
+               jobs++;
+               check_reduce($sformatf("pred 0x%x value 0x%08x", ctrl, values[v]),
+                            sum, min, max, count, 8);
+            end
+         end
+
+         // Unsigned, count lanes > 1; accumulate three jobs over different
+         // lanes, then the same lanes after add-one in the kernel
+         tb.poke_ocl(.addr(`PRED_CTRL_REG), .data(32'h5));
+         tb.poke_ocl(.addr(`PRED_VALUE_REG), .data(32'h1));
+         tb.poke_ocl(.addr(`RED_CTRL_REG), .data(`RED_CLEAR | `RED_ACCUMULATE | 32'h0000_0300));
+         check_reduce("after clear", 0, 0, 0, 0, 0);
+         run_batch();                                      // lanes 0, 1
+         tb.poke_ocl(.addr(`RED_CTRL_REG), .data(`RED_ACCUMULATE | 32'h0000_0000));
+         run_batch();                                      // no lanes
+         tb.poke_ocl(.addr(`RED_CTRL_REG), .data(`RED_ACCUMULATE | 32'h0000_C000));
+         run_batch();                                      // lanes 6, 7
+         jobs += 3;
+         check_reduce("accumulated", 64'h0000_0001_0000_0000, 32'h0, 32'hFFFFFFFE, 1, 4);
+
+         // Reset ALU arguments: 1, 2, 2, 0xFFFFFFFF. A scan kernel's results
+         // depend on its carry instead.
+         tb.peek_ocl(.addr(`KERNEL_CAPS_REG), .data(caps));
+         if ((caps & `KERNEL_FLAG_SCAN) == 0) begin
+            tb.poke_ocl(.addr(`RED_CTRL_REG), .data(`RED_CLEAR | `RED_RESULTS | 32'h0000_C300));
+            run_batch();
+            jobs++;
+            check_reduce("of results", 64'h0000_0001_0000_0004, 32'h1, 32'hFFFFFFFF, 3, 4);
+         end
+
+         tb.poke_ocl(.addr(`RED_CTRL_REG), .data(`RED_CLEAR | `RED_MASK_ALL));
+         tb.poke_ocl(.addr(`PRED_CTRL_REG), .data(32'h0));
+         tb.poke_ocl(.addr(`PRED_VALUE_REG), .data(32'h0));
+         `CL_LOG(`CL_LOG_LOW, ("[%t] Reduction engine test completed (%0d jobs)", $realtime, jobs))
+      end
+   endtask
+
+   // Scan kernel: a loaded carry near the wrap, inclusive jobs that carry
+   // into each other, exclusive jobs continuing the same carry, then a new
+   // load. Expected values are a running sum over every word pushed, one
+   // word at a time. Restores the reset job arguments.
+   task test_scan();
+      logic [31:0] caps;
+      logic [31:0] lanes [0:7];
+      logic [31:0] data;
+      logic [31:0] carry;
+      logic [31:0] want;
+      logic [3:0]  op;
+      int          jobs;
+      begin
+         `CL_LOG(`CL_LOG_LOW, ("[%t] === SCAN KERNEL TEST ===", $realtime))
+         tb.peek_ocl(.addr(`KERNEL_CAPS_REG), .data(caps));
+         if ((caps & `KERNEL_FLAG_SCAN) == 0) begin
+            `CL_LOG(`CL_LOG_LOW, ("[%t] Kernel cannot scan, skipped", $realtime))
+            return;
+         end
+
+         jobs = 0;
+         for (int j = 0; j < 8; j++) begin
+            // Jobs 0-2 inclusive, 3-5 exclusive, 6-7 exclusive again from
+            // a freshly loaded carry
+            op = (j >= 3) ? 4'h1 : 4'h0;
+            if (j == 0 || j == 6) begin
+               carry = (j == 0) ? 32'hFFFFFFF0 : 32'h00000100;
+               op |= 4'h2;
+               tb.poke_ocl(.addr(`JOB_OPERAND_REG), .data(carry));
+            end
+            tb.poke_ocl(.addr(`JOB_OPCODE_REG), .data(op));
+            for (int i = 0; i < 8; i++) begin
+               lanes[i] = (j == 4) ? 32'h80000000 + i : $urandom_range(0, 7) * (j + 1);
+               tb.poke_ocl(.addr(`INPUT_BASE + (i * 4)), .data(lanes[i]));
+            end
+            run_batch();
+            jobs++;
+            for (int i = 0; i < 8; i++) begin
+               want = op[0] ? carry : carry + lanes[i];
+               carry += lanes[i];
+               tb.peek_ocl(.addr(`OUTPUT_BASE + (i * 4)), .data(data));
+               if (data !== want) begin
+                  $error("[%t] NO Scan job %0d op 0x%x lane %0d: 0x%08x, expected 0x%08x",
+                         $realtime, j, op, i, data, want);
+                  error_count++;
+               end
+            end
+         end
+
+         tb.poke_ocl(.addr(`JOB_OPCODE_REG), .data(32'h0));
+         tb.poke_ocl(.addr(`JOB_OPERAND_REG), .data(32'h1));
+         `CL_LOG(`CL_LOG_LOW, ("[%t] Scan kernel test completed (%0d jobs)", $realtime, jobs))
+      end
+   endtask
+
+   // Output bank and compaction count against the words of 'src' selected
+   // by 'mask' that match the predicate, packed in lane order
+   task check_compact(input string what, input logic [31:0] src [0:7], input logic [7:0] mask,
+                      input logic [3:0] ctrl, input logic [31:0] value);
+      logic [31:0] want [0:7];
+      logic [31:0] data;
+      int          count;
+      begin
+         count = 0;
+         want = '{default: 32'h0};
+         for (int i = 0; i < 8; i++) begin
+            if (mask[i] && pred_ref(ctrl, value, src[i])) begin
+               want[count] = src[i];
+               count++;
+            end
+         end
+         tb.peek_ocl(.addr(`COMPACT_COUNT), .data(data));
+         if (data !== count) begin
+            $error("[%t] NO Compaction %s: count %0d, expected %0d", $realtime, what, data, count);
+            error_count++;
+         end
+         for (int i = 0; i < 8; i++) begin
+            tb.peek_ocl(.addr(`OUTPUT_BASE + (i * 4)), .data(data));
+            if (data !== want[i]) begin
+               $error("[%t] NO Compaction %s: output %0d is 0x%08x, expected 0x%08x",
+                      $realtime, what, i, data, want[i]);
+               error_count++;
+            end
+         end
+      end
+   endtask
+
+   // Every predicate, signed and unsigned, compacting the inputs; lane
+   // masks; then compacting the result beat, which is skipped on a scan
+   // kernel since its results depend on the carry. Restores the reset
+   // predicate and compaction settings.
+   task test_compact();
+      logic [31:0] caps;
+      logic [31:0] lanes [0:7];
+      logic [31:0] results [0:7];
+      logic [31:0] values [0:1];
+      logic [31:0] data;
+      logic [3:0]  ctrl;
+      int          jobs;
+      begin
+         `CL_LOG(`CL_LOG_LOW, ("[%t] === STREAM COMPACTION TEST ===", $realtime))
+         jobs = 0;
+         tb.peek_ocl(.addr(`COMPACT_CTRL_REG), .data(data));
+         if (data !== 32'h0000FF00) begin
+            $error("[%t] NO Compaction control resets to 0x%08x, expected 0x0000FF00",
+                   $realtime, data);
+            error_count++;
+         end
+
+         lanes = '{32'h00000000, 32'h00000001, 32'h00000007, 32'h00000008,
+                   32'hFFFFFFFF, 32'h80000000, 32'h00000006, 32'h00000009};
+         values = '{32'h00000007, 32'h80000000};
+         for (int i = 0; i < 8; i++)
+            tb.poke_ocl(.addr(`INPUT_BASE + (i * 4)), .data(lanes[i]));
+
+         tb.poke_ocl(.addr(`COMPACT_CTRL_REG), .data(`COMPACT_ENABLE | 32'h0000FF00));
+         for (int c = 0; c < 16; c++) begin
+            ctrl = c;
+            foreach (values[v]) begin
+               tb.poke_ocl(.addr(`PRED_CTRL_REG), .data(ctrl));
+               tb.poke_ocl(.addr(`PRED_VALUE_REG), .data(values[v]));
+               run_batch();
+               jobs++;
+               check_compact($sformatf("pred 0x%x value 0x%08x", ctrl, values[v]), lanes, 8'hFF,
+                             ctrl, values[v]);
+            end
+         end
+
+         // Unsigned, keep lanes > 7, lanes 0-4 only and then none
+         tb.poke_ocl(.addr(`PRED_CTRL_REG), .data(32'h5));
+         tb.poke_ocl(.addr(`PRED_VALUE_REG), .data(32'h7));
+         tb.poke_ocl(.addr(`COMPACT_CTRL_REG), .data(`COMPACT_ENABLE | 32'h00001F00));
+         run_batch();
+         check_compact("mask 0x1F", lanes, 8'h1F, 4'h5, 32'h7);
+         tb.poke_ocl(.addr(`COMPACT_CTRL_REG), .data(`COMPACT_ENABLE));
+         run_batch();
+         check_compact("mask 0x00", lanes, 8'h00, 4'h5, 32'h7);
+         jobs += 2;
+
+         tb.peek_ocl(.addr(`KERNEL_CAPS_REG), .data(caps));
+         if ((caps & `KERNEL_FLAG_SCAN) == 0) begin
+            // The plain result beat first, then the same job compacted
+            tb.poke_ocl(.addr(`COMPACT_CTRL_REG), .data(32'h0000FF00));
+            run_batch();
+            tb.peek_ocl(.addr(`COMPACT_COUNT), .data(data));
+            if (data !== 32'd8) begin
+               $error("[%t] NO Compaction disabled: count %0d, expected 8", $realtime, data);
+               error_count++;
+            end
+            for (int i = 0; i < 8; i++)
+               tb.peek_ocl(.addr(`OUTPUT_BASE + (i * 4)), .data(results[i]));
+            tb.poke_ocl(.addr(`COMPACT_CTRL_REG),
+                        .data(`COMPACT_ENABLE | `COMPACT_RESULTS | 32'h0000FF00));
+            run_batch();
+            check_compact("of results", results, 8'hFF, 4'h5, 32'h7);
+            jobs += 2;
+         end
+
+         tb.poke_ocl(.addr(`COMPACT_CTRL_REG), .data(32'h0000FF00));
+         tb.poke_ocl(.addr(`PRED_CTRL_REG), .data(32'h0));
+         tb.poke_ocl(.addr(`PRED_VALUE_REG), .data(32'h0));
+         `CL_LOG(`CL_LOG_LOW, ("[%t] Stream compaction test completed (%0d jobs)", $realtime, jobs))
+      end
+   endtask
+
+   // Check the job timestamps latched for the last add-one job
+   task test_hw_timestamps();
+      logic [63:0] doorbell_ts;
+      logic [63:0] start_ts;
+      logic [63:0] done_ts;
+      logic [63:0] now_ts;
+      begin
+         `CL_LOG(`CL_LOG_LOW, ("[%t] === TESTING HARDWARE TIMESTAMPS ===", $realtime))
+
+         read_ts64(`HWTS_DOORBELL_LO, doorbell_ts);
+         read_ts64(`HWTS_START_LO, start_ts);
+         read_ts64(`HWTS_DONE_LO, done_ts);
+         read_ts64(`HWTS_CYCLE_LO, now_ts);
+
+         `CL_LOG(`CL_LOG_LOW, ("[%t] Doorbell=%0d start=%0d done=%0d now=%0d", $realtime,
+                  doorbell_ts, start_ts, done_ts, now_ts))
+
+         // Start bit write -> start accepted next cycle -> done 5 cycles later
+         if (start_ts - doorbell_ts != 1) begin
+            $error("[%t] NO Doorbell-to-start = %0d cycles, expected 1", $realtime, start_ts - doorbell_ts);
+            error_count++;
+         end
+         if (done_ts - start_ts != 5) begin
+            $error("[%t] NO Start-to-done = %0d cycles, expected 5", $realtime, done_ts - start_ts);
+            error_count++;
+         end
+         if (now_ts <= done_ts) begin
+            $error("[%t] NO Cycle counter %0d not past done %0d", $realtime, now_ts, done_ts);
+            error_count++;
+         end
+      end
+   endtask
+
+   task peek_sda(input logic [63:0] addr, output logic [31:0] data);
+      tb.peek(.addr(addr), .data(data), .size(DataSize::UINT32), .intf(AxiPort::PORT_SDA));
+   endtask
+
+   // Check the out-of-band status seen from the management side
+   task test_sda_monitor();
+      logic [31:0] sda_data;
+      begin
+         `CL_LOG(`CL_LOG_LOW, ("[%t] === TESTING SDA MONITOR ===", $realtime))
+
+         peek_sda(`SDA_JOBS_STARTED, sda_data);
+         if (sda_data != 2) begin
+            $error("[%t] NO SDA jobs started = %0d, expected 2", $realtime, sda_data);
+            error_count++;
+         end
+         peek_sda(`SDA_JOBS_DONE, sda_data);
+         if (sda_data != 2) begin
+            $error("[%t] NO SDA jobs done = %0d, expected 2", $realtime, sda_data);
+            error_count++;
+         end
+         peek_sda(`SDA_STATUS, sda_data);
+         if (sda_data[1:0] != 2'b00 || sda_data[10:8] != 3'b000) begin
+            $error("[%t] NO SDA status = 0x%08x, expected idle without errors", $realtime, sda_data);
+            error_count++;
+         end
+
+         // An unmapped OCL read must raise the sticky flag, writing 1 clears it
+         tb.peek_ocl(.addr(64'h3F0), .data(read_data));
+         peek_sda(`SDA_ERRORS, sda_data);
+         if (sda_data[0] != 1'b1) begin
+            $error("[%t] NO SDA unmapped-read flag not set: 0x%08x", $realtime, sda_data);
+            error_count++;
+         end
+         tb.poke(.addr(`SDA_ERRORS), .data(32'h00000001), .size(DataSize::UINT32), .intf(AxiPort::PORT_SDA));
+         peek_sda(`SDA_ERRORS, sda_data);
+         if (sda_data != 0) begin
+            $error("[%t] NO SDA error flags not cleared: 0x%08x", $realtime, sda_data);
+            error_count++;
+         end else begin
+            `CL_LOG(`CL_LOG_LOW, ("[%t] OK SDA monitor counters and error flags", $realtime))
+         end
+      end
+   endtask
+
+   // Check the on-card latency histograms after the two add-one jobs
+   task test_latency_histogram();
+      logic [31:0] bin_data;
+      int svc_total;
+      int react_total;
+      begin
+         `CL_LOG(`CL_LOG_LOW, ("[%t] === TESTING LATENCY HISTOGRAMS ===", $realtime))
+
+         svc_total = 0;
+         react_total = 0;
+         for (int i = 0; i < 16; i++) begin
+            tb.peek_ocl(.addr(`HIST_SVC_BASE + (i * 4)), .data(bin_data));
+            svc_total += bin_data;
+            // Add-one takes 5 cycles from start to done -> bin 2 (4-7 cycles)
+            if (i == 2 && bin_data != 2) begin
+               $error("[%t] NO Start-to-done bin[2] = %0d, expected 2", $realtime, bin_data);
+               error_count++;
+            end
+            tb.peek_ocl(.addr(`HIST_REACT_BASE + (i * 4)), .data(bin_data));
+            react_total += bin_data;
+         end
+
+         if (svc_total != 2 || react_total != 2) begin
+            $error("[%t] NO Histogram totals start->done=%0d done->read=%0d, expected 2/2",
+                   $realtime, svc_total, react_total);
+            error_count++;
+         end else begin
+            `CL_LOG(`CL_LOG_LOW, ("[%t] OK Histogram totals start->done=%0d done->read=%0d",
+                     $realtime, svc_total, react_total))
+         end
+
+         // Clear and confirm
+         tb.poke_ocl(.addr(`HIST_CTRL), .data(32'h00000001));
+         tb.peek_ocl(.addr(`HIST_SVC_BASE + 8), .data(bin_data));
+         if (bin_data != 0) begin
+            $error("[%t] NO Histogram not cleared: bin[2] = %0d", $realtime, bin_data);
+            error_count++;
+         end
+      end
+   endtask
+
+   // Per-operation cycle statistics for the perf budget test
+   typedef struct {
+      string name;
+      int    count;
+      real   total;
+      real   max;
+      int    budget;
+   } perf_op_t;
+
+   // clk_main_a0 as the testbench actually drives it, rather than an
+   // assumed frequency; time differences divide by it to give cycles
+   task measure_clk_period();
+      realtime t;
+      @(posedge `CL_PATH.clk_main_a0);
+      t = $realtime;
+      @(posedge `CL_PATH.clk_main_a0);
+      clk_period = $realtime - t;
+      `CL_LOG(`CL_LOG_MEDIUM, ("[%t] clk_main_a0 period %0.3f ns", $realtime, clk_period / 1ns))
+   endtask
+
+   function automatic real cycles_since(realtime start);
+      return ($realtime - start) / clk_period;
+   endfunction
+
+   function automatic void perf_add(ref perf_op_t op, input real cycles);
+      op.count++;
+      op.total += cycles;
+      if (cycles > op.max) op.max = cycles;
+   endfunction
+
+   // Measure clk_main_a0 cycles per poke_ocl, per peek_ocl and per complete
+   // add-one batch, fail on any operation over budget and write a JSON summary
+   // (+PERF_SUMMARY=<file>, default cl_top_perf.json)
+   task test_perf_budget();
+      perf_op_t ops [3];
+      realtime t0;
+      real mean;
+      logic [31:0] data;
+      string summary_path;
+      int fd;
+      begin
+         `CL_LOG(`CL_LOG_LOW, ("[%t] === PERF BUDGET TEST ===", $realtime))
+
+         ops[0] = '{name: "poke_ocl", count: 0, total: 0.0, max: 0.0, budget: `POKE_BUDGET_DEFAULT};
+         ops[1] = '{name: "peek_ocl", count: 0, total: 0.0, max: 0.0, budget: `PEEK_BUDGET_DEFAULT};
+         ops[2] = '{name: "add_one_batch", count: 0, total: 0.0, max: 0.0, budget: `BATCH_BUDGET_DEFAULT};
+         void'($value$plusargs("POKE_BUDGET=%d", ops[0].budget));
+         void'($value$plusargs("PEEK_BUDGET=%d", ops[1].budget));
+         void'($value$plusargs("BATCH_BUDGET=%d", ops[2].budget));
+         if (!$value$plusargs("PERF_SUMMARY=%s", summary_path))
+            summary_path = "cl_top_perf.json";
+
+         // Single accesses, back to back
+         for (int i = 0; i < `PERF_SAMPLES; i++) begin
+            t0 = $realtime;
+            tb.poke_ocl(.addr(`INPUT_BASE + ((i % 8) * 4)), .data(32'h30000000 + i));
+            perf_add(ops[0], cycles_since(t0));
+            t0 = $realtime;
+            tb.peek_ocl(.addr(`INPUT_BASE + ((i % 8) * 4)), .data(data));
+            perf_add(ops[1], cycles_since(t0));
+         end
+
+         // Complete batches: inputs, start, poll without delay, clear, outputs
+         for (int b = 0; b < `PERF_SAMPLES / 4; b++) begin
+            t0 = $realtime;
+            for (int i = 0; i < 8; i++)
+               tb.poke_ocl(.addr(`INPUT_BASE + (i * 4)), .data(32'h40000000 + (b << 8) + i));
+            tb.poke_ocl(.addr(`CONTROL_REG), .data(`START_BIT));
+            poll_count = 0;
+            status_data = 32'h0;
+            while ((status_data & `DONE_BIT) == 0 && poll_count < 1000) begin
+               tb.peek_ocl(.addr(`STATUS_REG), .data(status_data));
+               poll_count++;
+            end
+            tb.poke_ocl(.addr(`CONTROL_REG), .data(32'h00000000));
+            for (int i = 0; i < 8; i++) begin
+               tb.peek_ocl(.addr(`OUTPUT_BASE + (i * 4)), .data(data));
+               if (data !== 32'h40000000 + (b << 8) + i + 1) begin
+                  $error("[%t] NO Perf batch %0d output[%0d] = 0x%08x", $realtime, b, i, data);
+                  error_count++;
+               end
+            end
+            perf_add(ops[2], cycles_since(t0));
+         end
+
+         fd = $fopen(summary_path, "w");
+         if (fd == 0) begin
+            `CL_LOG(`CL_LOG_NONE, ("[%t] NO Cannot write perf summary %s", $realtime, summary_path))
+            error_count++;
+         end
+         else begin
+            $fwrite(fd, "{\"test\": \"cl_top_perf_budget\", \"clk_mhz\": %0.1f, \"ops\": [",
+                    1ns / clk_period * 1000.0);
+         end
+         foreach (ops[k]) begin
+            mean = ops[k].total / ops[k].count;
+            $display("[%t] PERF %-14s n=%0d mean=%0.1f max=%0.1f budget=%0d cycles %s", $realtime,
+                     ops[k].name, ops[k].count, mean, ops[k].max, ops[k].budget,
+                     ops[k].max > ops[k].budget ? "OVER BUDGET" : "OK");
+            if (ops[k].max > ops[k].budget) begin
+               $error("[%t] NO %s took %0.1f cycles, budget %0d", $realtime,
+                      ops[k].name, ops[k].max, ops[k].budget);
+               error_count++;
+            end
+            if (fd != 0)
+               $fwrite(fd, "%s{\"name\": \"%s\", \"count\": %0d, \"mean_cycles\": %0.2f, \"max_cycles\": %0.2f, \"budget_cycles\": %0d, \"pass\": %s}",
+                       k == 0 ? "" : ", ", ops[k].name, ops[k].count, mean, ops[k].max, ops[k].budget,
+                       ops[k].max > ops[k].budget ? "false" : "true");
+         end
+         if (fd != 0) begin
+            $fwrite(fd, "]}\n");
+            $fclose(fd);
+            $display("[%t] Perf summary written to %s", $realtime, summary_path);
+         end
+      end
+   endtask
+
+   // Stress master state. The drive variables are forced onto the CL's OCL
+   // inputs for the duration of test_ocl_stress.
+   logic        drv_awvalid, drv_wvalid, drv_bready, drv_arvalid, drv_rready;
+   logic [31:0] drv_awaddr, drv_wdata, drv_araddr;
+   int          stress_bready_pct;
+   int          stress_rready_pct;
+   int          stress_cycles;
+   int          stress_xfers;
+
+   // Issue writes back to back: AW and W are offered as soon as the previous
+   // beat is accepted, B is taken with random backpressure. Handshakes are
+   // evaluated on the falling edge and take effect at the next rising edge.
+   task automatic stress_write(input logic [31:0] addrs[$], input logic [31:0] datas[$]);
+      int aw_n = 0, w_n = 0, b_n = 0, cycles = 0;
+      bit aw_hs = 0, w_hs = 0, b_hs = 0;
+      while (b_n < addrs.size() && cycles < `STRESS_TIMEOUT) begin
+         @(negedge `CL_PATH.clk_main_a0);
+         cycles++;
+         if (aw_hs) aw_n++;
+         if (w_hs) w_n++;
+         if (b_hs) begin
+            b_n++;
+            if (`CL_PATH.cl_ocl_bresp != 2'b00) begin
+               $error("[%t] NO Stress write %0d got BRESP %0d", $realtime, b_n, `CL_PATH.cl_ocl_bresp);
+               error_count++;
+            end
+         end
+         drv_awvalid = aw_n < addrs.size();
+         drv_awaddr  = aw_n < addrs.size() ? addrs[aw_n] : 32'h0;
+         drv_wvalid  = w_n < addrs.size();
+         drv_wdata   = w_n < addrs.size() ? datas[w_n] : 32'h0;
+         drv_bready  = $urandom_range(99) < stress_bready_pct;
+         aw_hs = drv_awvalid && `CL_PATH.cl_ocl_awready;
+         w_hs  = drv_wvalid && `CL_PATH.cl_ocl_wready;
+         b_hs  = drv_bready && `CL_PATH.cl_ocl_bvalid;
+      end
+      drv_awvalid = 0;
+      drv_wvalid = 0;
+      drv_bready = 0;
+      if (b_n < addrs.size()) begin
+         $error("[%t] NO Stress writes stalled after %0d/%0d", $realtime, b_n, addrs.size());
+         error_count++;
+      end
+      stress_xfers += b_n;
+   endtask
+
+   // Issue reads back to back with random R backpressure; data lands in 'datas'
+   task automatic stress_read(input logic [31:0] addrs[$], output logic [31:0] datas[$]);
+      int ar_n = 0, r_n = 0, cycles = 0;
+      bit ar_hs = 0, r_hs = 0;
+      logic [31:0] r_data;
+      datas = {};
+      while (r_n < addrs.size() && cycles < `STRESS_TIMEOUT) begin
+         @(negedge `CL_PATH.clk_main_a0);
+         cycles++;
+         if (ar_hs) ar_n++;
+         if (r_hs) begin
+            datas.push_back(r_data);
+            r_n++;
+         end
+         drv_arvalid = ar_n < addrs.size();
+         drv_araddr  = ar_n < addrs.size() ? addrs[ar_n] : 32'h0;
+         drv_rready  = $urandom_range(99) < stress_rready_pct;
+         ar_hs  = drv_arvalid && `CL_PATH.cl_ocl_arready;
+         r_hs   = drv_rready && `CL_PATH.cl_ocl_rvalid;
+         r_data = `CL_PATH.cl_ocl_rdata;
+      end
+      drv_arvalid = 0;
+      drv_rready = 0;
+      if (r_n < addrs.size()) begin
+         $error("[%t] NO Stress reads stalled after %0d/%0d", $realtime, r_n, addrs.size());
+         error_count++;
+      end
+      stress_xfers += r_n;
+   endtask
+
+   task automatic stress_check(input string what, input logic [31:0] addrs[$],
+                               input logic [31:0] got[$], input logic [31:0] exp[$]);
+      foreach (got[i]) begin
+         if (got[i] !== exp[i]) begin
+            $error("[%t] NO Stress %s: addr 0x%03x read 0x%08x, expected 0x%08x",
+                   $realtime, what, addrs[i], got[i], exp[i]);
+            error_count++;
+         end
+      end
+   endtask
+
+   // Reset the cycle and transfer counts of a stress phase
+   task automatic stress_phase_begin();
+      stress_cycles = 0;
+      stress_xfers = 0;
+   endtask
+
+   // Back-to-back OCL traffic with randomized BREADY/RREADY, concurrent reads
+   // and writes on disjoint registers, data checked on every input, output,
+   // control and status register. Reports transfers per cycle per phase.
+   task test_ocl_stress();
+      logic [31:0] shadow [0:7];
+      logic [31:0] waddrs[$], wdatas[$], raddrs[$], rdatas[$], rexp[$];
+      bit counting;
+      int polls;
+      begin
+         `CL_LOG(`CL_LOG_LOW, ("[%t] === OCL BACK-TO-BACK STRESS ===", $realtime))
+         stress_bready_pct = 50;
+         stress_rready_pct = 50;
+         void'($value$plusargs("STRESS_BREADY_PCT=%d", stress_bready_pct));
+         void'($value$plusargs("STRESS_RREADY_PCT=%d", stress_rready_pct));
+
+         // Known starting point through the BFM: outputs = shadow + 1, control 0
+         for (int i = 0; i < 8; i++) begin
+            shadow[i] = $urandom;
+            tb.poke_ocl(.addr(`INPUT_BASE + (i * 4)), .data(shadow[i]));
+         end
+         run_batch();
+
+         drv_awvalid = 0; drv_wvalid = 0; drv_bready = 0; drv_arvalid = 0; drv_rready = 0;
+         drv_awaddr = 0; drv_wdata = 0; drv_araddr = 0;
+         force `CL_PATH.ocl_cl_awvalid = drv_awvalid;
+         force `CL_PATH.ocl_cl_awaddr  = drv_awaddr;
+         force `CL_PATH.ocl_cl_wvalid  = drv_wvalid;
+         force `CL_PATH.ocl_cl_wdata   = drv_wdata;
+         force `CL_PATH.ocl_cl_wstrb   = 4'hF;
+         force `CL_PATH.ocl_cl_bready  = drv_bready;
+         force `CL_PATH.ocl_cl_arvalid = drv_arvalid;
+         force `CL_PATH.ocl_cl_araddr  = drv_araddr;
+         force `CL_PATH.ocl_cl_rready  = drv_rready;
+
+         fork
+            begin : cycle_counter
+               forever @(posedge `CL_PATH.clk_main_a0) if (counting) stress_cycles++;
+            end
+         join_none
+
+         // Phase 1: random input writes concurrent with output/control/status reads
+         waddrs = {}; wdatas = {}; raddrs = {}; rexp = {};
+         for (int n = 0; n < `STRESS_WRITES; n++) begin
+            automatic int r = $urandom_range(7);
+            waddrs.push_back(`INPUT_BASE + (r * 4));
+            wdatas.push_back($urandom);
+         end
+         for (int n = 0; n < `STRESS_WRITES; n++) begin
+            automatic int r = n % 10;
+            raddrs.push_back(r < 8 ? `OUTPUT_BASE + (r * 4) : (r == 8 ? `CONTROL_REG : `STATUS_REG));
+            rexp.push_back(r < 8 ? shadow[r] + 1 : 32'h0);
+         end
+         stress_phase_begin();
+         counting = 1;
+         fork
+            stress_write(waddrs, wdatas);
+            stress_read(raddrs, rdatas);
+         join
+         counting = 0;
+         stress_check("output/control/status", raddrs, rdatas, rexp);
+         foreach (waddrs[n]) shadow[waddrs[n][4:2]] = wdatas[n];
+         $display("[%t] PERF stress concurrent: %0d transfers in %0d cycles = %0.3f/cycle",
+                  $realtime, stress_xfers, stress_cycles, real'(stress_xfers) / stress_cycles);
+
+         // Phase 2: back-to-back input readback
+         raddrs = {}; rexp = {};
+         for (int n = 0; n < `STRESS_WRITES; n++) begin
+            raddrs.push_back(`INPUT_BASE + ((n % 8) * 4));
+            rexp.push_back(shadow[n % 8]);
+         end
+         stress_phase_begin();
+         counting = 1;
+         stress_read(raddrs, rdatas);
+         counting = 0;
+         stress_check("input", raddrs, rdatas, rexp);
+         $display("[%t] PERF stress reads: %0d transfers in %0d cycles = %0.3f/cycle",
+                  $realtime, stress_xfers, stress_cycles, real'(stress_xfers) / stress_cycles);
+
+         // Phase 3: start, back-to-back status polls, outputs and control
+         waddrs = '{`CONTROL_REG}; wdatas = '{`START_BIT};
+         stress_write(waddrs, wdatas);
+         raddrs = '{`STATUS_REG};
+         polls = 0;
+         do stress_read(raddrs, rdatas);
+         while ((rdatas[0] & `DONE_BIT) == 0 && ++polls < `DONE_TIMEOUT_CYCLES);
+         if ((rdatas[0] & `DONE_BIT) == 0) begin
+            $error("[%t] NO Stress job not done after %0d status polls", $realtime, polls);
+            error_count++;
+         end
+         raddrs = {}; rexp = {};
+         for (int i = 0; i < 8; i++) begin
+            raddrs.push_back(`OUTPUT_BASE + (i * 4));
+            rexp.push_back(shadow[i] + 1);
+         end
+         raddrs.push_back(`CONTROL_REG);
+         rexp.push_back(`START_BIT);
+         raddrs.push_back(`STATUS_REG);
+         rexp.push_back(`DONE_BIT);
+         stress_read(raddrs, rdatas);
+         stress_check("result", raddrs, rdatas, rexp);
+
+         waddrs = '{`CONTROL_REG}; wdatas = '{32'h0};
+         stress_write(waddrs, wdatas);
+         raddrs = '{`STATUS_REG};
+         polls = 0;
+         do stress_read(raddrs, rdatas);
+         while ((rdatas[0] & `DONE_BIT) != 0 && ++polls < `DONE_TIMEOUT_CYCLES);
+         if ((rdatas[0] & `DONE_BIT) != 0) begin
+            $error("[%t] NO Stress done still set after %0d status polls", $realtime, polls);
+            error_count++;
+         end
+         raddrs = '{`CONTROL_REG};
+         rexp = '{32'h0};
+         stress_read(raddrs, rdatas);
+         stress_check("control", raddrs, rdatas, rexp);
+
+         disable cycle_counter;
+         release `CL_PATH.ocl_cl_awvalid;
+         release `CL_PATH.ocl_cl_awaddr;
+         release `CL_PATH.ocl_cl_wvalid;
+         release `CL_PATH.ocl_cl_wdata;
+         release `CL_PATH.ocl_cl_wstrb;
+         release `CL_PATH.ocl_cl_bready;
+         release `CL_PATH.ocl_cl_arvalid;
+         release `CL_PATH.ocl_cl_araddr;
+         release `CL_PATH.ocl_cl_rready;
+         `CL_LOG(`CL_LOG_LOW, ("[%t] OCL stress completed (BREADY %0d%%, RREADY %0d%%)",
+                  $realtime, stress_bready_pct, stress_rready_pct))
+      end
+   endtask
+
+   // Run add-one over a large dataset twice: once with every word moved by
+   // poke_ocl/peek_ocl, once with the input bank loaded and the output bank
+   // read through the simulation backdoor. Start and status polling stay on
+   // the frontdoor in both. Results are dumped with $writememh and compared.
+   task test_bulk_dataset();
+      logic [31:0] dataset [];
+      logic [31:0] front_out [];
+      logic [31:0] back_out [];
+      logic [31:0] batch [0:7];
+      string input_file;
+      int batches;
+      longint wall_start;
+      longint front_ms;
+      longint back_ms;
+      realtime sim_start;
+      realtime front_ns;
+      realtime back_ns;
+      begin
+         `CL_LOG(`CL_LOG_LOW, ("[%t] === BULK DATASET: FRONTDOOR VS BACKDOOR ===", $realtime))
+         batches = `BULK_BATCHES_DEFAULT;
+         void'($value$plusargs("BULK_BATCHES=%d", batches));
+         dataset = new[batches * 8];
+         front_out = new[batches * 8];
+         back_out = new[batches * 8];
+
+         if ($value$plusargs("BULK_INPUT=%s", input_file)) begin
+            $readmemh(input_file, dataset);
+         end else begin
+            input_file = "cl_top_bulk_in.hex";
+            foreach (dataset[i]) dataset[i] = $urandom;
+            $writememh(input_file, dataset);
+         end
+
+         // Frontdoor: every word over OCL
+         wall_start = cl_top_wall_ms();
+         sim_start = $realtime;
+         for (int b = 0; b < batches; b++) begin
+            for (int i = 0; i < 8; i++)
+               tb.poke_ocl(.addr(`INPUT_BASE + (i * 4)), .data(dataset[b * 8 + i]));
+            run_batch();
+            for (int i = 0; i < 8; i++)
+               tb.peek_ocl(.addr(`OUTPUT_BASE + (i * 4)), .data(front_out[b * 8 + i]));
+         end
+         front_ms = cl_top_wall_ms() - wall_start;
+         front_ns = ($realtime - sim_start) / 1ns;
+
+         // Backdoor: input bank loaded and output bank read hierarchically
+         wall_start = cl_top_wall_ms();
+         sim_start = $realtime;
+         for (int b = 0; b < batches; b++) begin
+            for (int i = 0; i < 8; i++)
+               batch[i] = dataset[b * 8 + i];
+            `CL_PATH.backdoor_write_inputs(batch);
+            run_batch();
+            for (int i = 0; i < 8; i++)
+               back_out[b * 8 + i] = `CL_PATH.output_regs[i];
+         end
+         back_ms = cl_top_wall_ms() - wall_start;
+         back_ns = ($realtime - sim_start) / 1ns;
+
+         $writememh("cl_top_bulk_out_front.hex", front_out);
+         $writememh("cl_top_bulk_out_back.hex", back_out);
+
+         foreach (dataset[i]) begin
+            if (front_out[i] !== dataset[i] + 1 || back_out[i] !== dataset[i] + 1) begin
+               $error("[%t] NO Bulk word %0d: input 0x%08x front 0x%08x back 0x%08x",
+                      $realtime, i, dataset[i], front_out[i], back_out[i]);
+               error_count++;
+            end
+         end
+
+         $display("[%t] PERF bulk %0d words frontdoor: %0d ms wall, %0.0f ns simulated",
+                  $realtime, batches * 8, front_ms, front_ns);
+         $display("[%t] PERF bulk %0d words backdoor:  %0d ms wall, %0.0f ns simulated",
+                  $realtime, batches * 8, back_ms, back_ns);
+      end
+   endtask
+
+   // Load the input bank and the trace BRAM from $readmemh images through
+   // the backdoor, read them back over OCL, then dump both with $writememh
+   // and compare the dumps with the images. Tracing is off and cleared, so
+   // the drain reads are not recorded over the image.
+   task test_backdoor_images();
+      logic [31:0]  in_img [0:7];
+      logic [31:0]  in_dump [0:7];
+      logic [127:0] trace_img [0:`TRACE_DEPTH-1];
+      logic [127:0] trace_dump [0:`TRACE_DEPTH-1];
+      logic [31:0]  word;
+      begin
+         `CL_LOG(`CL_LOG_LOW, ("[%t] === BACKDOOR IMAGES ===", $realtime))
+
+         foreach (in_img[i]) in_img[i] = $urandom;
+         $writememh("cl_top_bd_inputs.hex", in_img);
+         `CL_PATH.backdoor_load_inputs("cl_top_bd_inputs.hex");
+         for (int i = 0; i < 8; i++) begin
+            tb.peek_ocl(.addr(`INPUT_BASE + (i * 4)), .data(word));
+            if (word !== in_img[i]) begin
+               $error("[%t] NO Backdoor input %0d reads 0x%08x, image has 0x%08x",
+                      $realtime, i, word, in_img[i]);
+               error_count++;
+            end
+         end
+         `CL_PATH.backdoor_dump_inputs("cl_top_bd_inputs_dump.hex");
+         $readmemh("cl_top_bd_inputs_dump.hex", in_dump);
+         foreach (in_img[i]) begin
+            if (in_dump[i] !== in_img[i]) begin
+               $error("[%t] NO Input bank dump word %0d is 0x%08x, image has 0x%08x",
+                      $realtime, i, in_dump[i], in_img[i]);
+               error_count++;
+            end
+         end
+
+         tb.poke_ocl(.addr(`TRACE_CTRL_REG), .data(`TRACE_CTRL_CLEAR));
+         foreach (trace_img[e])
+            trace_img[e] = {32'hB0D0_0000 | e, $urandom, $urandom, $urandom};
+         $writememh("cl_top_bd_trace.hex", trace_img);
+         `CL_PATH.backdoor_load_trace("cl_top_bd_trace.hex");
+
+         tb.poke_ocl(.addr(`TRACE_RD_PTR_REG), .data(0));
+         for (int e = 0; e < `TRACE_DRAIN; e++) begin
+            for (int k = 0; k < 4; k++) begin
+               tb.peek_ocl(.addr(`TRACE_DATA0_REG + (k * 4)), .data(word));
+               if (word !== trace_img[e][127 - (k * 32) -: 32]) begin
+                  $error("[%t] NO Trace entry %0d word %0d reads 0x%08x, image has 0x%08x",
+                         $realtime, e, k, word, trace_img[e][127 - (k * 32) -: 32]);
+                  error_count++;
+               end
+            end
+         end
+         tb.peek_ocl(.addr(`TRACE_RD_PTR_REG), .data(word));
+         if (word !== `TRACE_DRAIN) begin
+            $error("[%t] NO Trace read pointer is %0d after draining %0d entries",
+                   $realtime, word, `TRACE_DRAIN);
+            error_count++;
+         end
+         // The image fills the BRAM only, nothing was recorded
+         tb.peek_ocl(.addr(`TRACE_STATUS_REG), .data(word));
+         if (word[10:0] !== 0) begin
+            $error("[%t] NO Trace status counts %0d entries after a backdoor load",
+                   $realtime, word[10:0]);
+            error_count++;
+         end
+
+         `CL_PATH.backdoor_dump_trace("cl_top_bd_trace_dump.hex");
+         $readmemh("cl_top_bd_trace_dump.hex", trace_dump);
+         foreach (trace_img[e]) begin
+            if (trace_dump[e] !== trace_img[e]) begin
+               $error("[%t] NO Trace BRAM dump entry %0d is 0x%032x, image has 0x%032x",
+                      $realtime, e, trace_dump[e], trace_img[e]);
+               error_count++;
+            end
+         end
+         `CL_LOG(`CL_LOG_LOW, ("[%t] OK Backdoor images: input bank and %0d trace entries",
+                  $realtime, `TRACE_DRAIN))
+      end
+   endtask
+
+   // Simulation throughput at each verbosity: the same frontdoor workload is
+   // run with the RTL and testbench log levels set to 0..3 in turn
+   task test_log_throughput();
+      int batches;
+      int saved_level;
+      longint wall_start;
+      longint ms;
+      realtime sim_start;
+      real cycles;
+      begin
+         `CL_LOG(`CL_LOG_LOW, ("[%t] === LOG THROUGHPUT ===", $realtime))
+         batches = `LOG_BATCHES_DEFAULT;
+         void'($value$plusargs("LOG_BATCHES=%d", batches));
+         saved_level = cl_log_level;
+
+         for (int level = `CL_LOG_NONE; level <= `CL_LOG_HIGH; level++) begin
+            cl_log_level = level;
+            `CL_PATH.cl_log_level = level;
+            wall_start = cl_top_wall_ms();
+            sim_start = $realtime;
+            for (int b = 0; b < batches; b++) begin
+               for (int i = 0; i < 8; i++)
+                  tb.poke_ocl(.addr(`INPUT_BASE + (i * 4)), .data(32'h50000000 + (b << 8) + i));
+               run_batch();
+               for (int i = 0; i < 8; i++)
+                  tb.peek_ocl(.addr(`OUTPUT_BASE + (i * 4)), .data(read_data));
+            end
+            ms = cl_top_wall_ms() - wall_start;
+            cycles = cycles_since(sim_start);
+            cl_log_level = saved_level;
+            `CL_PATH.cl_log_level = saved_level;
+            $display("[%t] PERF log verbosity=%0d: %0.0f cycles in %0d ms = %0.0f cycles/s",
+                     $realtime, level, cycles, ms, ms > 0 ? cycles * 1000.0 / ms : 0.0);
+         end
+      end
+   endtask
+
+   // Start the loaded batch, wait for done and acknowledge it
+   task run_batch();
+      tb.poke_ocl(.addr(`CONTROL_REG), .data(`START_BIT));
+      wait_done(1'b1, done_ok);
+      if (!done_ok) begin
+         $error("[%t] NO Batch did not complete within %0d cycles", $realtime, `DONE_TIMEOUT_CYCLES);
+         error_count++;
       end
+      tb.poke_ocl(.addr(`CONTROL_REG), .data(32'h00000000));
+      wait_done(1'b0, done_ok);
    endtask
 
 endmodule // cl_top_base_test
@@ -0,0 +1,173 @@
+/*
+ * Copyright 2015-2024 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Plumbing shared by the engine benches (cl_top_reduce_bench,
+// cl_top_compact_bench, cl_top_scan_bench).
+//
+// bench_opt() parses the options they have in common, bench_card_open()
+// attaches to the card in the slot or, with -E, points cl_top_mmio.h at a
+// transaction-level model, and bench_run_begin()/bench_run_end() bracket a
+// timed pass with its OCL transactions, model cycles and wall time. On the
+// model, wall time only measures the model, so bench_print() reports card
+// cycles instead.
+
+#ifndef CL_TOP_BENCH_H
+#define CL_TOP_BENCH_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <time.h>
+
+// AWS FPGA SDK includes
+#include <fpga_pci.h>
+#include <fpga_mgmt.h>
+
+#include "cl_top_mmio.h"
+#include "cl_top_model.h"
+#include "cl_top_reduce.h"
+
+struct bench_opts {
+    size_t n;               // -n words
+    uint32_t pred_ctrl;     // -p, signed with -s
+    uint32_t pred_value;    // -V
+    int slot_id;            // -S
+    bool emulate;           // -E
+};
+
+struct bench_card {
+    struct cl_top_model model;  // -E only
+    pci_bar_handle_t bar;
+    bool emulate;
+};
+
+struct bench_run {
+    uint64_t xacts;
+    uint64_t cycles;        // model clk_main_a0 cycles, -E only
+    double ns;
+};
+
+static inline uint64_t bench_xacts(void) {
+    struct cl_top_mmio_acct *a = cl_top_mmio_acct_get();
+    return a != NULL ? a->total.reads + a->total.writes : 0;
+}
+
+static inline double bench_now_ns(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec * 1e9 + (double)t.tv_nsec;
+}
+
+// Returns 1 if opt is a common option, 0 if the bench must handle it, and
+// -1 if its value is bad
+static inline int bench_opt(struct bench_opts *o, int opt, const char *arg) {
+    switch (opt) {
+    case 'n':
+        o->n = strtoull(arg, NULL, 0);
+        return 1;
+    case 'p':
+        if (cl_top_pred_op_parse(arg) < 0) {
+            printf("ERROR: Unknown predicate '%s'\n", arg);
+            return -1;
+        }
+        o->pred_ctrl = (o->pred_ctrl & PRED_CTRL_SIGNED) | (uint32_t)cl_top_pred_op_parse(arg);
+        return 1;
+    case 'V':
+        o->pred_value = (uint32_t)strtoul(arg, NULL, 0);
+        return 1;
+    case 's':
+        o->pred_ctrl |= PRED_CTRL_SIGNED;
+        return 1;
+    case 'S':
+        o->slot_id = atoi(arg);
+        return 1;
+    case 'E':
+        o->emulate = true;
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+// n words of the same pseudo-random pattern for every bench, or NULL
+static inline uint32_t *bench_input(size_t n) {
+    uint32_t *x = malloc(n * sizeof(*x));
+
+    if (x == NULL) {
+        printf("ERROR: Unable to allocate %zu words\n", n);
+        return NULL;
+    }
+    for (size_t i = 0; i < n; i++) {
+        x[i] = (uint32_t)i * 2654435761u;
+    }
+    return x;
+}
+
+// Attach to the card, or with -E to a model with the default kernel; turns
+// on transaction accounting either way
+static inline int bench_card_open(struct bench_card *c, const struct bench_opts *o) {
+    int rc;
+
+    c->bar = PCI_BAR_HANDLE_INIT;
+    c->emulate = o->emulate;
+    if (c->emulate) {
+        cl_top_model_init(&c->model, 0);
+        cl_top_mmio_model = &c->model;
+    } else {
+        rc = fpga_mgmt_init();
+        if (rc != 0) {
+            printf("ERROR: Unable to initialize the FPGA management library\n");
+            return 1;
+        }
+        rc = fpga_pci_attach(o->slot_id, FPGA_APP_PF, APP_PF_BAR0, 0, &c->bar);
+        if (rc != 0) {
+            printf("ERROR: Unable to attach to the AFI on slot id %d\n", o->slot_id);
+            return rc;
+        }
+    }
+    cl_top_mmio_accounting = true;
+    return 0;
+}
+
+static inline void bench_card_close(struct bench_card *c) {
+    if (!c->emulate) {
+        fpga_pci_detach(c->bar);
+    }
+}
+
+static inline void bench_run_begin(const struct bench_card *c, struct bench_run *r) {
+    r->xacts = bench_xacts();
+    r->cycles = c->model.now;
+    r->ns = bench_now_ns();
+}
+
+static inline void bench_run_end(const struct bench_card *c, struct bench_run *r) {
+    r->ns = bench_now_ns() - r->ns;
+    r->cycles = c->model.now - r->cycles;
+    r->xacts = bench_xacts() - r->xacts;
+}
+
+static inline void bench_print(const char *name, const struct bench_run *b, size_t n,
+                               bool emulate) {
+    printf("  %-10s %6.3f OCL transactions/word, ", name, (double)b->xacts / (double)n);
+    if (emulate) {
+        printf("%7.2f card cycles/word\n", (double)b->cycles / (double)n);
+    } else {
+        printf("%8.1f ns/word\n", b->ns / (double)n);
+    }
+}
+
+#endif // CL_TOP_BENCH_H
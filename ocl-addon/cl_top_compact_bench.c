@@ -0,0 +1,143 @@
+/*
+ * Copyright 2015-2024 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// On-card stream compaction against readback and a CPU filter.
+//
+//   cl_top_compact_bench [-n words] [-p pred] [-V value] [-s] [-S slot] [-E]
+//
+// Pushes the same array through the kernel twice and keeps the words the
+// kernel makes of it that match the predicate -p/-V (signed with -s):
+//
+//   readback  every batch's 8 output registers are read back and filtered
+//             on the CPU with cl_top_compact_n()
+//   on-card   the card packs the survivors and only the count and the
+//             survivors are read back (cl_top_compact_array)
+//
+// Both must keep the same words in the same order. Reports the fraction
+// kept and OCL transactions and time per word for each. With -E the card is
+// the transaction-level model and time is reported in clk_main_a0 cycles
+// instead of wall time, which would only measure the model.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "cl_top_bench.h"
+#include "cl_top_jobs.h"
+#include "cl_top_mmio.h"
+#include "cl_top_reduce.h"
+#include "cl_top_regs.h"
+
+static int compact_readback(pci_bar_handle_t bar, uint32_t pred_ctrl, uint32_t pred_value,
+                            const uint32_t *x, size_t n, uint32_t *y, size_t *count) {
+    uint32_t out[NUM_REGISTERS];
+    size_t kept = 0;
+    int rc = 0;
+
+    for (size_t i = 0; i < n && rc == 0; i += NUM_REGISTERS) {
+        int m = n - i < NUM_REGISTERS ? (int)(n - i) : NUM_REGISTERS;
+        rc = cl_top_job_run(bar, &x[i], m);
+        for (int j = 0; j < m && rc == 0; j++) {
+            rc = cl_top_mmio_peek(bar, OUTPUT_BASE_ADDR + (j * 4), &out[j]);
+        }
+        cl_top_mmio_job_end(m);
+        kept += cl_top_compact_n(pred_ctrl, pred_value, out, &y[kept], m);
+    }
+    *count = kept;
+    return rc;
+}
+
+int main(int argc, char **argv) {
+    static struct bench_card card;
+    struct bench_opts opts = {
+        .n = 1 << 16,
+        .pred_ctrl = PRED_OP_GT,
+        .pred_value = 0xC0000000u,
+    };
+    struct bench_run runs[2] = {{0}};
+    size_t kept[2] = {0};
+    size_t n;
+    uint32_t *x;
+    uint32_t *y[2];
+    int opt;
+    int rc;
+
+    while ((opt = getopt(argc, argv, "n:p:V:sS:E")) != -1) {
+        rc = bench_opt(&opts, opt, optarg);
+        if (rc == 0) {
+            printf("Usage: %s [-n words] [-p pred] [-V value] [-s] [-S slot] [-E]\n", argv[0]);
+        }
+        if (rc <= 0) {
+            return 1;
+        }
+    }
+    n = opts.n;
+    if (n == 0) {
+        printf("ERROR: Word count must be at least 1\n");
+        return 1;
+    }
+
+    x = bench_input(n);
+    if (x == NULL) {
+        return 1;
+    }
+    y[0] = malloc(n * sizeof(*y[0]));
+    y[1] = malloc(n * sizeof(*y[1]));
+    if (y[0] == NULL || y[1] == NULL) {
+        printf("ERROR: Unable to allocate %zu words\n", n);
+        return 1;
+    }
+
+    rc = bench_card_open(&card, &opts);
+    if (rc != 0) {
+        return rc;
+    }
+
+    // The kernel's results are compacted, so both paths see the same words
+    for (int k = 0; k < 2 && rc == 0; k++) {
+        bench_run_begin(&card, &runs[k]);
+        if (k == 0) {
+            rc = compact_readback(card.bar, opts.pred_ctrl, opts.pred_value, x, n, y[0],
+                                  &kept[0]);
+        } else {
+            rc = cl_top_compact_array(card.bar, opts.pred_ctrl, opts.pred_value,
+                                      COMPACT_CTRL_RESULTS, x, n, y[1], &kept[1]);
+        }
+        bench_run_end(&card, &runs[k]);
+    }
+
+    if (rc == 0) {
+        printf("=== cl_top compaction: %zu words, predicate %s%s 0x%x, %zu kept (%.1f%%) ===\n",
+               n, (opts.pred_ctrl & PRED_CTRL_SIGNED) ? "signed " : "",
+               cl_top_pred_op_name(opts.pred_ctrl), opts.pred_value, kept[1],
+               100.0 * (double)kept[1] / (double)n);
+        bench_print("readback", &runs[0], n, opts.emulate);
+        bench_print("on-card", &runs[1], n, opts.emulate);
+        if (kept[0] != kept[1] || memcmp(y[0], y[1], kept[0] * sizeof(*y[0])) != 0) {
+            printf("ERROR: On-card compaction does not match the readback (%zu vs %zu words)\n",
+                   kept[1], kept[0]);
+            rc = 1;
+        }
+    }
+
+    bench_card_close(&card);
+    free(x);
+    free(y[0]);
+    free(y[1]);
+    return rc ? 1 : 0;
+}
@@ -19,6 +19,8 @@
 #include <string.h>
 #include <unistd.h>
 #include <errno.h>
+#include <signal.h>
+#include <stdlib.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <fcntl.h>
@@ -28,35 +30,182 @@
 #include <fpga_mgmt.h>
 #include <utils/lcd.h>
 
-// Register addresses for Simple Add-One
-#define INPUT_BASE_ADDR     0x00    // Input registers 0x00-0x1C (8 regs)
-#define OUTPUT_BASE_ADDR    0x20    // Output registers 0x20-0x3C (8 regs)
-#define CONTROL_REG_ADDR    0x40    // Control register
-#define STATUS_REG_ADDR     0x44    // Status register
-
-#define START_BIT           0x00000001
-#define DONE_BIT            0x00000001
-
-#define NUM_REGISTERS       8
+#include "cl_top_alu.h"
+#include "cl_top_hwts.h"
+#include "cl_top_kernel.h"
+#include "cl_top_metrics.h"
+#include "cl_top_mmio.h"
+#include "cl_top_perf_event.h"
+#include "cl_top_probes.h"
+#include "cl_top_regs.h"
+#include "cl_top_stats.h"
+#include "cl_top_trace.h"
 
 // FPGA slot and PCI IDs
 #define FPGA_SLOT_ID        0
 #define PCI_VENDOR_ID       0x1D0F  // Amazon PCI Vendor ID
 #define PCI_DEVICE_ID       0xF000  // PCI Device ID
 
+// Per-stage timing, dumped at exit and on SIGUSR1
+static struct cl_top_stats stage_stats;
+static volatile sig_atomic_t stats_dump_requested = 0;
+static int num_iterations = 1;
+
+// Report verbosity: 0 = errors and summary only, 1 = per-job step report.
+// The report is rendered from the trace ring, never from the MMIO path.
+static int verbosity = 1;
+static const char *trace_path = NULL;
+static uint32_t job_id = 0;
+
+// Prometheus export target (textfile path or unix:<socket>), off by default
+static const char *metrics_target = NULL;
+static struct cl_top_metrics metrics;
+
+// perf_event counter group around each stage (-p)
+static bool perf_requested = false;
+static struct cl_top_perf perf_counters;
+
+// Clear the card's latency histograms before the run and print them after (-c)
+static bool card_hist_requested = false;
+
+// Read the card's job timestamps after every job and correlate them with the TSC (-H)
+static bool hwts_requested = false;
+static struct cl_top_hwts hwts;
+
+// ALU kernel job arguments (-o, -k); the defaults compute add-one
+static uint32_t alu_op = ALU_OP_ADD;
+static uint32_t alu_operand = 1;
+
+// Run against the transaction-level model instead of a card (-E)
+static bool emulate = false;
+static struct cl_top_model emulator;
+
+#ifdef SV_TEST
+// Exit-time reports. In simulation the process outlives the test, so they
+// run when cl_top_host_main() returns instead.
+#define MAX_EXIT_REPORTS    4
+static void (*exit_reports[MAX_EXIT_REPORTS])(void);
+static int num_exit_reports = 0;
+#endif
+
 // Function prototypes
+#ifndef SV_TEST
 static int check_afi_ready(int slot_id);
+#endif
 static int peek_poke_example(int slot_id, int pf_id, int bar_id);
-static int test_add_one_operation(pci_bar_handle_t pci_bar_handle);
+static int test_add_one_operation(int slot_id, pci_bar_handle_t pci_bar_handle);
+static void stats_dump_at_exit(void);
+static void stats_dump_signal(int sig);
+static void trace_dump_at_exit(void);
+static void mmio_report_at_exit(void);
+static int card_hist_report(pci_bar_handle_t pci_bar_handle);
+
+static void at_exit(void (*fn)(void)) {
+#ifdef SV_TEST
+    if (num_exit_reports < MAX_EXIT_REPORTS) {
+        exit_reports[num_exit_reports++] = fn;
+    }
+#else
+    atexit(fn);
+#endif
+}
 
-int main(int argc __attribute__((unused)), char **argv __attribute__((unused))) {
+static int host_main(int argc, char **argv) {
     int rc = 0;
     int slot_id = 0;
     int pf_id = FPGA_APP_PF;
     int bar_id = APP_PF_BAR0;
+    int opt;
+
+    optind = 1;
+    while ((opt = getopt(argc, argv, "n:v:t:me:pcHEo:k:")) != -1) {
+        switch (opt) {
+        case 'n':
+            num_iterations = atoi(optarg);
+            break;
+        case 'v':
+            verbosity = atoi(optarg);
+            break;
+        case 't':
+            trace_path = optarg;
+            break;
+        case 'm':
+            cl_top_mmio_accounting = true;
+            break;
+        case 'e':
+            metrics_target = optarg;
+            break;
+        case 'p':
+            perf_requested = true;
+            break;
+        case 'c':
+            card_hist_requested = true;
+            break;
+        case 'H':
+            hwts_requested = true;
+            break;
+        case 'E':
+            emulate = true;
+            break;
+        case 'o':
+            if (cl_top_alu_op_parse(optarg) < 0) {
+                printf("ERROR: Unknown ALU opcode '%s' (add, sub, and, or, xor, shl, shr, sra, adds, addss)\n",
+                       optarg);
+                return 1;
+            }
+            alu_op = (uint32_t)cl_top_alu_op_parse(optarg);
+            break;
+        case 'k':
+            alu_operand = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        default:
+            printf("Usage: %s [-n iterations] [-v verbosity] [-t trace_file] [-m] [-e metrics_target] [-p] [-c] [-H] [-E]"
+                   " [-o alu_op] [-k operand]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (num_iterations < 1) {
+        printf("ERROR: Iteration count must be at least 1\n");
+        return 1;
+    }
+    if (emulate && (metrics_target != NULL || hwts_requested)) {
+        printf("ERROR: -e and -H are not available with -E\n");
+        return 1;
+    }
+    if (CL_TOP_SIM && metrics_target != NULL) {
+        printf("ERROR: -e is not available in simulation, its thread cannot call into the simulator\n");
+        return 1;
+    }
 
     printf("\n=== AWS FPGA Simple Add-One Test ===\n");
 
+    cl_top_stats_init(&stage_stats);
+    at_exit(stats_dump_at_exit);
+    signal(SIGUSR1, stats_dump_signal);
+
+    cl_top_trace_enabled = verbosity > 0 || trace_path != NULL;
+    if (trace_path != NULL) {
+        at_exit(trace_dump_at_exit);
+    }
+    if (cl_top_mmio_accounting) {
+        at_exit(mmio_report_at_exit);
+    }
+    if (perf_requested && cl_top_perf_open(&perf_counters) != 0) {
+        printf("WARNING: perf_event counters unavailable: %s\n", strerror(errno));
+    }
+
+    if (emulate) {
+        cl_top_model_init(&emulator, 0);
+        cl_top_mmio_model = &emulator;
+        printf("Emulating cl_top with the transaction-level model, no card attached\n");
+        rc = peek_poke_example(slot_id, pf_id, bar_id);
+        printf("Emulated card time: %llu clk_main_a0 cycles\n", (unsigned long long)emulator.now);
+        goto cleanup;
+    }
+
+#ifdef SV_TEST
+    printf("Running against the cl_top RTL in simulation, times are simulated ns\n");
+#else
     // Initialize the FPGA management library
     rc = fpga_mgmt_init();
     if (rc != 0) {
@@ -74,6 +223,7 @@ int main(int argc __attribute__((unused)), char **argv __attribute__((unused)))
     }
 
     printf("AFI is ready, proceeding with test\n");
+#endif
 
     // Run the peek/poke example
     rc = peek_poke_example(slot_id, pf_id, bar_id);
@@ -89,6 +239,7 @@ cleanup:
     return rc;
 }
 
+#ifndef SV_TEST
 static int check_afi_ready(int slot_id) {
     struct fpga_mgmt_image_info info = {0};
     int rc = 0;
@@ -116,188 +267,409 @@ static int check_afi_ready(int slot_id) {
     printf("AFI is loaded and ready\n");
     return 0;
 }
+#endif
 
 static int peek_poke_example(int slot_id, int pf_id, int bar_id) {
     int rc = 0;
     pci_bar_handle_t pci_bar_handle = PCI_BAR_HANDLE_INIT;
+    struct cl_top_kernel_info kernel;
 
     printf("\n=== Initializing PCI BAR ===\n");
 
     // Attach to the FPGA, with a PCIe connection
-    rc = fpga_pci_attach(slot_id, pf_id, bar_id, 0, &pci_bar_handle);
+#ifndef SV_TEST
+    if (!emulate) {
+        rc = fpga_pci_attach(slot_id, pf_id, bar_id, 0, &pci_bar_handle);
+        if (rc != 0) {
+            printf("ERROR: Unable to attach to the AFI on slot id %d, pf id %d, bar id %d\n", slot_id, pf_id, bar_id);
+            return rc;
+        }
+
+        printf("PCI BAR attached successfully\n");
+    }
+#else
+    // The testbench's OCL tasks stand in for the attached BAR
+    (void)pf_id;
+    (void)bar_id;
+#endif
+
+    rc = cl_top_kernel_probe(pci_bar_handle, &kernel);
     if (rc != 0) {
-        printf("ERROR: Unable to attach to the AFI on slot id %d, pf id %d, bar id %d\n", slot_id, pf_id, bar_id);
-        return rc;
+        printf("ERROR: Failed to read the kernel ID\n");
+        goto cleanup;
+    }
+    cl_top_kernel_print(&kernel);
+    // An AFI without the kernel slot reads back 0xDEADBEEF, whose flags would
+    // claim an ALU, so only trust the flags of a kernel we know
+    if (kernel.id != KERNEL_ADD_ONE && kernel.id != KERNEL_ALU && kernel.id != KERNEL_SCAN) {
+        printf("ERROR: Unknown kernel 0x%04x in slot %d\n", kernel.id, slot_id);
+        rc = 1;
+        goto cleanup;
+    }
+    if (kernel.id == KERNEL_ALU && (kernel.flags & KERNEL_CAPS_FLAG_ALU)) {
+        // Set every run, the registers keep whatever the last user left
+        rc = cl_top_mmio_bar_poke(pci_bar_handle, JOB_OPCODE_ADDR, alu_op);
+        if (rc == 0) {
+            rc = cl_top_mmio_bar_poke(pci_bar_handle, JOB_OPERAND_ADDR, alu_operand);
+        }
+        if (rc != 0) {
+            printf("ERROR: Failed to set the ALU opcode and operand\n");
+            goto cleanup;
+        }
+        printf("ALU: %s, operand 0x%08x\n", cl_top_alu_op_name(alu_op), alu_operand);
+    } else if (kernel.id != KERNEL_ADD_ONE || alu_op != ALU_OP_ADD || alu_operand != 1) {
+        printf("ERROR: Kernel 0x%04x cannot run %s with operand 0x%08x\n", kernel.id,
+               cl_top_alu_op_name(alu_op), alu_operand);
+        rc = 1;
+        goto cleanup;
     }
 
-    printf("PCI BAR attached successfully\n");
+    if (metrics_target != NULL) {
+        if (cl_top_metrics_start(&metrics, metrics_target, &stage_stats, slot_id, pci_bar_handle) != 0) {
+            printf("ERROR: Unable to start metrics export to %s: %s\n", metrics_target, strerror(errno));
+            rc = 1;
+            goto cleanup;
+        }
+        printf("Exporting metrics to %s\n", metrics_target);
+    }
 
-    // Test the Add-One operation
-    rc = test_add_one_operation(pci_bar_handle);
-    if (rc != 0) {
-        printf("ERROR: Add-One operation test failed\n");
+    if (card_hist_requested) {
+        rc = cl_top_mmio_bar_poke(pci_bar_handle, HIST_CTRL_ADDR, HIST_CLEAR_BIT);
+        if (rc != 0) {
+            printf("ERROR: Failed to clear card latency histograms\n");
+            goto cleanup;
+        }
+    }
+
+    if (hwts_requested && cl_top_hwts_init(&hwts, pci_bar_handle) != 0) {
+        printf("ERROR: Failed to read the card cycle counter\n");
+        rc = 1;
         goto cleanup;
     }
 
+    // Run the kernel operation
+    for (int iter = 0; iter < num_iterations; iter++) {
+        uint64_t mark = cl_top_trace_mark();
+        rc = test_add_one_operation(slot_id, pci_bar_handle);
+        if (verbosity > 0) {
+            struct cl_top_trace_render render;
+            cl_top_trace_render_init(&render, 0.0, false);
+            cl_top_trace_render_since(stdout, &render, mark);
+        }
+        if (rc != 0) {
+            cl_top_metrics_error(&metrics);
+            printf("ERROR: Kernel operation test failed on iteration %d\n", iter);
+            goto cleanup;
+        }
+        if (stats_dump_requested) {
+            stats_dump_requested = 0;
+            cl_top_stats_dump(&stage_stats, stdout);
+        }
+    }
+
+    if (card_hist_requested) {
+        rc = card_hist_report(pci_bar_handle);
+    }
+    if (rc == 0 && hwts_requested) {
+        rc = cl_top_hwts_report(&hwts, pci_bar_handle, stdout, cl_top_stats_ticks_per_ns(&stage_stats));
+        if (rc != 0) {
+            printf("ERROR: Failed to correlate card timestamps\n");
+        }
+    }
+
 cleanup:
+    cl_top_metrics_stop(&metrics);
+
     // Detach from the FPGA
+#ifndef SV_TEST
     if (pci_bar_handle >= 0) {
-        rc = fpga_pci_detach(pci_bar_handle);
-        if (rc != 0) {
+        // Keep the first failure as the exit status
+        int drc = fpga_pci_detach(pci_bar_handle);
+        if (drc != 0) {
             printf("ERROR: Failure while detaching from the FPGA\n");
         } else {
             printf("PCI BAR detached successfully\n");
         }
+        if (rc == 0) {
+            rc = drc;
+        }
     }
+#endif
 
     return rc;
 }
 
-static int test_add_one_operation(pci_bar_handle_t pci_bar_handle) {
+static void stats_dump_at_exit(void) {
+    cl_top_stats_dump(&stage_stats, stdout);
+    cl_top_perf_report(&perf_counters, stdout, NUM_REGISTERS);
+}
+
+// Print the card's start-to-done and done-to-status-read histograms
+static int card_hist_report(pci_bar_handle_t pci_bar_handle) {
+    uint32_t svc[HIST_BINS];
+    uint32_t react[HIST_BINS];
+    int rc;
+
+    for (int i = 0; i < HIST_BINS; i++) {
+        rc = cl_top_mmio_bar_peek(pci_bar_handle, HIST_SVC_BASE_ADDR + (i * 4), &svc[i]);
+        if (rc == 0) {
+            rc = cl_top_mmio_bar_peek(pci_bar_handle, HIST_REACT_BASE_ADDR + (i * 4), &react[i]);
+        }
+        if (rc != 0) {
+            printf("ERROR: Failed to read card latency histogram bin %d\n", i);
+            return rc;
+        }
+    }
+
+    printf("\n=== Card latency histograms (clk_main_a0 cycles, %d MHz) ===\n", CLK_MAIN_A0_MHZ);
+    printf("%-22s %12s %12s\n", "cycles", "start->done", "done->read");
+    for (int i = 0; i < HIST_BINS; i++) {
+        char range[32];
+        if (svc[i] == 0 && react[i] == 0) {
+            continue;
+        }
+        if (i == HIST_BINS - 1) {
+            snprintf(range, sizeof(range), ">= %u", 1u << i);
+        } else {
+            snprintf(range, sizeof(range), "%u - %u", i == 0 ? 0u : 1u << i, (2u << i) - 1);
+        }
+        printf("%-22s %12u %12u\n", range, svc[i], react[i]);
+    }
+    return 0;
+}
+
+// Close a protocol stage in every enabled instrument
+static inline uint64_t stage_end(enum cl_top_stage stage, uint64_t start) {
+    cl_top_perf_stage(&perf_counters, stage);
+    return cl_top_stage_end(&stage_stats, stage, start);
+}
+
+static void trace_dump_at_exit(void) {
+    if (cl_top_trace_write_file(trace_path, cl_top_stats_ticks_per_ns(&stage_stats)) != 0) {
+        printf("ERROR: Unable to write trace file %s: %s\n", trace_path, strerror(errno));
+    } else {
+        printf("Trace written to %s\n", trace_path);
+    }
+}
+
+static void mmio_report_at_exit(void) {
+    cl_top_mmio_report(stdout, cl_top_stats_ticks_per_ns(&stage_stats));
+}
+
+// Only flag the request here; the job loop dumps between iterations
+static void stats_dump_signal(int sig __attribute__((unused))) {
+    stats_dump_requested = 1;
+}
+
+static int test_add_one_operation(int slot_id, pci_bar_handle_t pci_bar_handle) {
     int rc = 0;
     uint32_t test_data[NUM_REGISTERS];
     uint32_t output_data[NUM_REGISTERS];
+    uint32_t expected[NUM_REGISTERS];
     uint32_t status = 0;
     int poll_count = 0;
     const int max_polls = 1000;
+    uint64_t job_start;
+    uint64_t submit;
+    uint64_t done_seen;
+    uint64_t readback;
+    uint64_t t;
+    uint32_t job = job_id++;
 
-    printf("\n=== Testing Add-One Operation ===\n");
+    // Progress goes to the trace ring; the report is rendered after the job
+    CL_TOP_TRACE(TRACE_EV_JOB_BEGIN, 0, 0, job);
 
     // Step 1: Initialize test data
-    printf("Step 1: Initializing test data\n");
+    CL_TOP_TRACE(TRACE_EV_STEP, 1, 0, 0);
     for (int i = 0; i < NUM_REGISTERS; i++) {
         test_data[i] = 0x10000000 + i;
-        printf("  Input[%d] = 0x%08x\n", i, test_data[i]);
+        CL_TOP_TRACE(TRACE_EV_DATA, i, 0, test_data[i]);
     }
+    CL_TOP_TRACE(TRACE_EV_ARGS, alu_op, 0, alu_operand);
 
     // Step 2: Clear control register
-    printf("Step 2: Clearing control register\n");
-    rc = fpga_pci_poke(pci_bar_handle, CONTROL_REG_ADDR, 0x00000000);
+    CL_TOP_TRACE(TRACE_EV_STEP, 2, 0, 0);
+    cl_top_perf_job_begin(&perf_counters);
+    job_start = t = cl_top_tsc();
+    rc = cl_top_mmio_poke(pci_bar_handle, CONTROL_REG_ADDR, 0x00000000);
     if (rc != 0) {
         printf("ERROR: Failed to clear control register\n");
-        return rc;
+        goto cleanup;
     }
+    CL_TOP_TRACE(TRACE_EV_POKE, 0, CONTROL_REG_ADDR, 0x00000000);
+    t = stage_end(STAGE_CTRL_CLEAR, t);
 
     // Step 3: Write input data to FPGA
-    printf("Step 3: Writing input data to FPGA\n");
+    CL_TOP_TRACE(TRACE_EV_STEP, 3, 0, 0);
     for (int i = 0; i < NUM_REGISTERS; i++) {
         uint32_t addr = INPUT_BASE_ADDR + (i * 4);
-        rc = fpga_pci_poke(pci_bar_handle, addr, test_data[i]);
+        rc = cl_top_mmio_poke(pci_bar_handle, addr, test_data[i]);
         if (rc != 0) {
             printf("ERROR: Failed to write input register %d\n", i);
-            return rc;
+            goto cleanup;
         }
-        printf("  Wrote 0x%08x to address 0x%02x\n", test_data[i], addr);
+        CL_TOP_TRACE(TRACE_EV_POKE, 0, addr, test_data[i]);
     }
+    t = stage_end(STAGE_INPUT_WRITE, t);
 
     // Step 4: Verify input data readback
-    printf("Step 4: Verifying input data readback\n");
+    CL_TOP_TRACE(TRACE_EV_STEP, 4, 0, 0);
     for (int i = 0; i < NUM_REGISTERS; i++) {
         uint32_t addr = INPUT_BASE_ADDR + (i * 4);
         uint32_t read_data = 0;
-        rc = fpga_pci_peek(pci_bar_handle, addr, &read_data);
+        rc = cl_top_mmio_peek(pci_bar_handle, addr, &read_data);
         if (rc != 0) {
             printf("ERROR: Failed to read input register %d\n", i);
-            return rc;
+            goto cleanup;
         }
+        CL_TOP_TRACE(TRACE_EV_PEEK, 0, addr, read_data);
         if (read_data != test_data[i]) {
             printf("ERROR: Input readback mismatch at reg %d: expected 0x%08x, got 0x%08x\n", 
                    i, test_data[i], read_data);
-            return 1;
+            rc = 1;
+            goto cleanup;
         }
-        printf("  ✅ Input[%d] readback: 0x%08x\n", i, read_data);
     }
+    t = stage_end(STAGE_INPUT_VERIFY, t);
 
     // Step 5: Check initial status
-    printf("Step 5: Checking initial status\n");
-    rc = fpga_pci_peek(pci_bar_handle, STATUS_REG_ADDR, &status);
+    CL_TOP_TRACE(TRACE_EV_STEP, 5, 0, 0);
+    rc = cl_top_mmio_peek(pci_bar_handle, STATUS_REG_ADDR, &status);
     if (rc != 0) {
         printf("ERROR: Failed to read status register\n");
-        return rc;
+        goto cleanup;
     }
-    printf("Initial status: 0x%08x\n", status);
+    CL_TOP_TRACE(TRACE_EV_PEEK, 0, STATUS_REG_ADDR, status);
+    t = stage_end(STAGE_STATUS_CHECK, t);
 
     // Step 6: Start computation
-    printf("Step 6: Starting Add-One computation\n");
-    rc = fpga_pci_poke(pci_bar_handle, CONTROL_REG_ADDR, START_BIT);
+    CL_TOP_TRACE(TRACE_EV_STEP, 6, 0, 0);
+    CL_TOP_PROBE_SUBMIT(job, slot_id);
+    submit = t;
+    rc = cl_top_mmio_poke(pci_bar_handle, CONTROL_REG_ADDR, START_BIT);
     if (rc != 0) {
         printf("ERROR: Failed to start computation\n");
-        return rc;
+        goto cleanup;
     }
-    printf("Computation started\n");
+    CL_TOP_TRACE(TRACE_EV_POKE, 0, CONTROL_REG_ADDR, START_BIT);
+    t = stage_end(STAGE_START, t);
 
     // Step 7: Wait for completion
-    printf("Step 7: Waiting for computation to complete\n");
+    CL_TOP_TRACE(TRACE_EV_STEP, 7, 0, 0);
     poll_count = 0;
     status = 0;
 
     while (!(status & DONE_BIT) && poll_count < max_polls) {
-        usleep(1000); // 1ms delay between polls
-        rc = fpga_pci_peek(pci_bar_handle, STATUS_REG_ADDR, &status);
+        cl_top_mmio_delay_us(1000); // 1ms delay between polls
+        rc = cl_top_mmio_peek(pci_bar_handle, STATUS_REG_ADDR, &status);
         if (rc != 0) {
             printf("ERROR: Failed to read status register during polling\n");
-            return rc;
+            goto cleanup;
         }
+        CL_TOP_TRACE(TRACE_EV_PEEK, 0, STATUS_REG_ADDR, status);
         poll_count++;
-
-        if (poll_count % 100 == 0) {
-            printf("  Polling... count=%d, status=0x%08x\n", poll_count, status);
-        }
+        CL_TOP_PROBE_POLL(job, slot_id, poll_count, status);
     }
 
     if (poll_count >= max_polls) {
+        CL_TOP_PROBE_TIMEOUT(job, slot_id, poll_count);
+        cl_top_metrics_timeout(&metrics, poll_count);
         printf("ERROR: Timeout waiting for computation completion after %d polls\n", poll_count);
-        return 1;
+        rc = 1;
+        goto cleanup;
     }
-
-    printf("✅ Computation completed after %d polls\n", poll_count);
+    t = stage_end(STAGE_POLL, t);
+    done_seen = t;
+    CL_TOP_PROBE_COMPLETE(job, slot_id, t - submit, poll_count);
+    CL_TOP_TRACE(TRACE_EV_POLL_DONE, 0, 0, poll_count);
 
     // Step 8: Clear start bit
-    printf("Step 8: Clearing start bit\n");
-    rc = fpga_pci_poke(pci_bar_handle, CONTROL_REG_ADDR, 0x00000000);
+    CL_TOP_TRACE(TRACE_EV_STEP, 8, 0, 0);
+    rc = cl_top_mmio_poke(pci_bar_handle, CONTROL_REG_ADDR, 0x00000000);
     if (rc != 0) {
         printf("ERROR: Failed to clear start bit\n");
-        return rc;
+        goto cleanup;
     }
+    CL_TOP_TRACE(TRACE_EV_POKE, 0, CONTROL_REG_ADDR, 0x00000000);
+    t = stage_end(STAGE_START_CLEAR, t);
 
     // Step 9: Read output data
-    printf("Step 9: Reading output data\n");
+    CL_TOP_TRACE(TRACE_EV_STEP, 9, 0, 0);
     for (int i = 0; i < NUM_REGISTERS; i++) {
         uint32_t addr = OUTPUT_BASE_ADDR + (i * 4);
-        rc = fpga_pci_peek(pci_bar_handle, addr, &output_data[i]);
+        rc = cl_top_mmio_peek(pci_bar_handle, addr, &output_data[i]);
         if (rc != 0) {
             printf("ERROR: Failed to read output register %d\n", i);
-            return rc;
+            goto cleanup;
         }
-        printf("  Output[%d] = 0x%08x\n", i, output_data[i]);
+        CL_TOP_TRACE(TRACE_EV_PEEK, 0, addr, output_data[i]);
     }
+    readback = t;
+    t = stage_end(STAGE_READBACK, t);
+    CL_TOP_PROBE_READBACK(job, slot_id, NUM_REGISTERS, t - readback);
 
     // Step 10: Verify results
-    printf("Step 10: Verifying results\n");
-    printf("\nRESULTS COMPARISON:\n");
-    printf("Reg# | Input      | Output     | Expected   | Status\n");
-    printf("-----|------------|------------|------------|-------\n");
-
+    CL_TOP_TRACE(TRACE_EV_STEP, 10, 0, 0);
     int correct_count = 0;
+    cl_top_alu_apply_n(alu_op, alu_operand, test_data, expected, NUM_REGISTERS);
     for (int i = 0; i < NUM_REGISTERS; i++) {
-        uint32_t expected = test_data[i] + 1;
-        bool is_correct = (output_data[i] == expected);
-        if (is_correct) correct_count++;
+        if (output_data[i] == expected[i]) {
+            correct_count++;
+        }
+    }
+    CL_TOP_TRACE(TRACE_EV_VERIFY, 0, 0, correct_count);
+    t = stage_end(STAGE_RESULT_VERIFY, t);
+    cl_top_stage_end(&stage_stats, STAGE_JOB_TOTAL, job_start);
+    cl_top_perf_job_end(&perf_counters);
+    cl_top_mmio_job_end(NUM_REGISTERS);
+    cl_top_metrics_job(&metrics, t - job_start, poll_count, NUM_REGISTERS);
+
+    rc = cl_top_hwts_job(&hwts, pci_bar_handle, submit, done_seen);
+    if (rc != 0) {
+        printf("ERROR: Failed to read card job timestamps\n");
+        return rc;
+    }
 
-        printf("%2d   | 0x%08x | 0x%08x | 0x%08x | %s\n", 
-               i, test_data[i], output_data[i], expected, 
-               is_correct ? "✅ PASS" : "❌ FAIL");
+    if (correct_count != NUM_REGISTERS) {
+        printf("ERROR: %d/%d outputs incorrect\n", NUM_REGISTERS - correct_count, NUM_REGISTERS);
+        return 1;
     }
+    return 0;
 
-    printf("\nSUMMARY:\n");
-    printf("  Correct results: %d/%d\n", correct_count, NUM_REGISTERS);
-    printf("  Accuracy: %d%%\n", (correct_count * 100) / NUM_REGISTERS);
+cleanup:
+    // Close the failed job so its transactions are not charged to the next one
+    cl_top_mmio_job_end(0);
+    return rc;
+}
 
-    if (correct_count == NUM_REGISTERS) {
-        printf("🎉 ALL OUTPUTS CORRECT! Add-One operation working perfectly!\n");
-        return 0;
-    } else {
-        printf("💥 SOME OUTPUTS INCORRECT! Add-One operation has issues.\n");
-        return 1;
+#ifndef SV_TEST
+int main(int argc, char **argv) {
+    return host_main(argc, argv);
+}
+#else
+#define SIM_MAX_ARGS        32
+
+// DPI-C entry point, called by cl_top_host_test.sv with the options from
+// +HOST_ARGS=. Runs the same sequence as main() against the simulated RTL.
+int cl_top_host_main(const char *args, unsigned int *exit_code) {
+    char buf[512];
+    char *argv[SIM_MAX_ARGS + 1];
+    char *save = NULL;
+    int argc = 0;
+
+    snprintf(buf, sizeof(buf), "%s", args != NULL ? args : "");
+    argv[argc++] = "cl_top_host";
+    for (char *tok = strtok_r(buf, " \t", &save); tok != NULL && argc < SIM_MAX_ARGS;
+         tok = strtok_r(NULL, " \t", &save)) {
+        argv[argc++] = tok;
     }
+    argv[argc] = NULL;
+
+    *exit_code = (unsigned int)host_main(argc, argv);
+    // Same order atexit() would use
+    while (num_exit_reports > 0) {
+        exit_reports[--num_exit_reports]();
+    }
+    return 0;
 }
+#endif
@@ -0,0 +1,99 @@
+// ============================================================================
+// Amazon FPGA Hardware Development Kit
+//
+// Copyright 2024 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Amazon Software License (the "License"). You may not use
+// this file except in compliance with the License. A copy of the License is
+// located at
+//
+//    http://aws.amazon.com/asl/
+//
+// or in the "license" file accompanying this file. This file is distributed on
+// an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, express or
+// implied. See the License for the specific language governing permissions and
+// limitations under the License.
+// ============================================================================
+
+// Runs the production host program against the cl_top RTL.
+//
+// cl_top_host.c is compiled into the simulator with -DSV_TEST and entered
+// through cl_top_host_main() with the options from +HOST_ARGS= (the same
+// options the binary takes on a card, e.g. +HOST_ARGS="-n 100 -v 0 -c").
+// Its OCL accesses, delays and time stamps come back through the tasks
+// exported below, so the host's polling, batching and per-stage latency
+// report all run on simulated time.
+
+`include "common_base_test.svh"
+`include "cl_top_log.svh"
+
+module cl_top_host_test();
+   import tb_type_defines_pkg::*;
+
+   `CL_LOG_INIT
+
+   import "DPI-C" context task cl_top_host_main(input string args, output int unsigned exit_code);
+
+   export "DPI-C" task cl_top_sim_peek;
+   export "DPI-C" task cl_top_sim_poke;
+   export "DPI-C" task cl_top_sim_wait_ns;
+   export "DPI-C" function cl_top_sim_now_ns;
+
+   string       host_args;
+   int unsigned host_rc;
+   int          error_count;
+
+   task cl_top_sim_peek(input longint unsigned offset, output int unsigned value);
+      logic [31:0] data;
+      tb.peek_ocl(.addr(offset), .data(data));
+      value = data;
+      `CL_LOG(`CL_LOG_HIGH, ("[%t] host peek 0x%03x -> 0x%08x", $realtime, offset, data))
+   endtask
+
+   task cl_top_sim_poke(input longint unsigned offset, input int unsigned value);
+      `CL_LOG(`CL_LOG_HIGH, ("[%t] host poke 0x%03x <- 0x%08x", $realtime, offset, value))
+      tb.poke_ocl(.addr(offset), .data(value));
+   endtask
+
+   task cl_top_sim_wait_ns(input int unsigned ns);
+      tb.nsec_delay(ns);
+   endtask
+
+   // The host's time stamp counter, in ns of simulated time
+   function longint unsigned cl_top_sim_now_ns();
+      return longint'($realtime / 1ns);
+   endfunction
+
+   initial begin
+      error_count = 0;
+
+      tb.power_up();
+
+      // Wait for system to stabilize
+      tb.nsec_delay(1000);
+
+      if (!$value$plusargs("HOST_ARGS=%s", host_args))
+         host_args = "";
+
+      $display("[%t] Starting cl_top host program: '%s'", $realtime, host_args);
+      cl_top_host_main(host_args, host_rc);
+      if (host_rc != 0) begin
+         $error("[%t] NO Host program exited with %0d", $realtime, host_rc);
+         error_count++;
+      end
+
+      // Final delay
+      tb.nsec_delay(500);
+      tb.power_down();
+
+      if (error_count == 0) begin
+         $display("🎉 TEST PASSED: cl_top host program completed successfully");
+      end else begin
+         $display("💥 TEST FAILED: %0d errors detected (host program)", error_count);
+      end
+
+      report_pass_fail_status();
+      $finish;
+   end
+
+endmodule
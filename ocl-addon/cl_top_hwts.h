@@ -0,0 +1,229 @@
+/*
+ * Copyright 2015-2024 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, express or
+ * implied. See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Hardware job timestamps correlated with the host TSC.
+//
+// cl_top latches its 64-bit clk_main_a0 cycle counter when a job starts,
+// when it completes and at the last OCL write before the start (the
+// doorbell). Service time and doorbell-to-start delay come straight from
+// the card. To place card events on the host timeline, the cycle counter is
+// sampled between two rdtsc reads at the beginning and end of the run; the
+// pair of samples gives ticks per cycle and an offset, which maps each
+// job's doorbell and done cycles onto the TSC. That splits the host-visible
+// job latency into posted-write delivery, on-card work and completion
+// detection (poll) time.
+
+#ifndef CL_TOP_HWTS_H
+#define CL_TOP_HWTS_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <fpga_pci.h>
+
+#include "cl_top_mmio.h"
+#include "cl_top_regs.h"
+#include "cl_top_stats.h"
+
+#define HWTS_MAX_JOBS       4096    // jobs kept for TSC correlation (most recent)
+#define HWTS_SYNC_TRIES     8
+
+struct cl_top_hwts_job {
+    uint64_t submit_tsc;    // host TSC before the start-bit write
+    uint64_t seen_tsc;      // host TSC after the status read that saw done
+    uint64_t doorbell;      // card cycles
+    uint64_t start;
+    uint64_t done;
+};
+
+struct cl_top_hwts_sync {
+    uint64_t tsc;           // midpoint of the bracketing rdtsc pair
+    uint64_t cycle;
+    uint64_t window;        // bracketing width in ticks
+};
+
+struct cl_top_hwts {
+    bool enabled;
+    struct cl_top_hwts_sync origin;
+    struct cl_top_hist service;         // start -> done, cycles
+    struct cl_top_hist doorbell;        // doorbell -> start, cycles
+    uint64_t jobs;
+    struct cl_top_hwts_job job[HWTS_MAX_JOBS];
+};
+
+static inline void cl_top_hwts_hist_init(struct cl_top_hist *h) {
+    memset(h, 0, sizeof(*h));
+    h->min = UINT64_MAX;
+}
+
+static inline int cl_top_hwts_read64(pci_bar_handle_t bar, uint64_t lo_addr, uint64_t *v) {
+    uint32_t lo = 0;
+    uint32_t hi = 0;
+    int rc;
+
+    rc = cl_top_mmio_bar_peek(bar, lo_addr, &lo);
+    rc = rc ? rc : cl_top_mmio_bar_peek(bar, lo_addr + 4, &hi);
+    *v = ((uint64_t)hi << 32) | lo;
+    return rc;
+}
+
+// Sample the cycle counter, keeping the try with the tightest rdtsc bracket
+static inline int cl_top_hwts_sync(pci_bar_handle_t bar, struct cl_top_hwts_sync *s) {
+    s->tsc = 0;
+    s->cycle = 0;
+    s->window = UINT64_MAX;
+    for (int i = 0; i < HWTS_SYNC_TRIES; i++) {
+        uint64_t cycle;
+        uint64_t t0 = cl_top_tsc();
+        uint32_t lo = 0;
+        uint32_t hi = 0;
+        int rc = cl_top_mmio_bar_peek(bar, HWTS_CYCLE_LO_ADDR, &lo);
+        uint64_t t1 = cl_top_tsc();
+
+        rc = rc ? rc : cl_top_mmio_bar_peek(bar, HWTS_CYCLE_HI_ADDR, &hi);
+        if (rc != 0) {
+            return rc;
+        }
+        cycle = ((uint64_t)hi << 32) | lo;
+        if (t1 - t0 < s->window) {
+            s->tsc = t0 + (t1 - t0) / 2;
+            s->cycle = cycle;
+            s->window = t1 - t0;
+        }
+    }
+    return 0;
+}
+
+static inline int cl_top_hwts_init(struct cl_top_hwts *h, pci_bar_handle_t bar) {
+    memset(h, 0, sizeof(*h));
+    cl_top_hwts_hist_init(&h->service);
+    cl_top_hwts_hist_init(&h->doorbell);
+    if (cl_top_hwts_sync(bar, &h->origin) != 0) {
+        return -1;
+    }
+    h->enabled = true;
+    return 0;
+}
+
+// Fetch the timestamps of the job that just finished. Call outside the
+// timed stages; it costs six OCL reads.
+static inline int cl_top_hwts_job(struct cl_top_hwts *h, pci_bar_handle_t bar,
+                                  uint64_t submit_tsc, uint64_t seen_tsc) {
+    struct cl_top_hwts_job *j;
+    int rc;
+
+    if (__builtin_expect(!h->enabled, 1)) {
+        return 0;
+    }
+    j = &h->job[h->jobs % HWTS_MAX_JOBS];
+    rc = cl_top_hwts_read64(bar, HWTS_DOORBELL_LO_ADDR, &j->doorbell);
+    rc = rc ? rc : cl_top_hwts_read64(bar, HWTS_START_LO_ADDR, &j->start);
+    rc = rc ? rc : cl_top_hwts_read64(bar, HWTS_DONE_LO_ADDR, &j->done);
+    if (rc != 0) {
+        return rc;
+    }
+    j->submit_tsc = submit_tsc;
+    j->seen_tsc = seen_tsc;
+    cl_top_hist_record(&h->service, j->done - j->start);
+    cl_top_hist_record(&h->doorbell, j->start - j->doorbell);
+    h->jobs++;
+    return 0;
+}
+
+static inline void cl_top_hwts_row(FILE *out, const char *name, const struct cl_top_hist *h,
+                                   double scale) {
+    if (h->count == 0) {
+        return;
+    }
+    fprintf(out, "%-22s %8llu %10.0f %10.0f %10.0f %10.0f %10.0f\n", name,
+            (unsigned long long)h->count,
+            (double)h->min * scale,
+            (double)h->sum / (double)h->count * scale,
+            (double)cl_top_hist_quantile(h, 0.50) * scale,
+            (double)cl_top_hist_quantile(h, 0.99) * scale,
+            (double)h->max * scale);
+}
+
+// Correlate the recorded jobs with the TSC and print the breakdown (ns).
+// 'tpn' is the calibrated TSC rate in ticks per nanosecond.
+static inline int cl_top_hwts_report(struct cl_top_hwts *h, pci_bar_handle_t bar, FILE *out,
+                                     double tpn) {
+    struct cl_top_hwts_sync end;
+    struct cl_top_hist issue;
+    struct cl_top_hist detect;
+    uint64_t stored;
+    uint64_t skewed = 0;
+    double tpc;
+    double ns_per_cycle;
+
+    if (!h->enabled || h->jobs == 0) {
+        return 0;
+    }
+    if (cl_top_hwts_sync(bar, &end) != 0) {
+        return -1;
+    }
+    if (end.cycle <= h->origin.cycle || end.tsc <= h->origin.tsc) {
+        fprintf(out, "ERROR: Card cycle counter did not advance between TSC samples\n");
+        return -1;
+    }
+    tpc = (double)(end.tsc - h->origin.tsc) / (double)(end.cycle - h->origin.cycle);
+    ns_per_cycle = tpc / tpn;
+
+    cl_top_hwts_hist_init(&issue);
+    cl_top_hwts_hist_init(&detect);
+    stored = h->jobs < HWTS_MAX_JOBS ? h->jobs : HWTS_MAX_JOBS;
+    for (uint64_t i = 0; i < stored; i++) {
+        const struct cl_top_hwts_job *j = &h->job[i];
+        double doorbell_tsc = (double)h->origin.tsc +
+                              ((double)j->doorbell - (double)h->origin.cycle) * tpc;
+        double done_tsc = (double)h->origin.tsc +
+                          ((double)j->done - (double)h->origin.cycle) * tpc;
+        double a = doorbell_tsc - (double)j->submit_tsc;
+        double b = (double)j->seen_tsc - done_tsc;
+
+        // Negative spans are within the sync error; count them, record 0
+        if (a < 0.0 || b < 0.0) {
+            skewed++;
+        }
+        cl_top_hist_record(&issue, a < 0.0 ? 0 : (uint64_t)a);
+        cl_top_hist_record(&detect, b < 0.0 ? 0 : (uint64_t)b);
+    }
+
+    fprintf(out, "\n=== Hardware job timestamps (ns) ===\n");
+    fprintf(out, "clk_main_a0 measured %.3f MHz against TSC (nominal %d MHz), "
+            "sync window %.0f/%.0f ns\n",
+            tpn * 1000.0 / tpc, CLK_MAIN_A0_MHZ,
+            (double)h->origin.window / tpn, (double)end.window / tpn);
+    fprintf(out, "%-22s %8s %10s %10s %10s %10s %10s\n",
+            "span", "count", "min", "mean", "p50", "p99", "max");
+    cl_top_hwts_row(out, "host poke->doorbell", &issue, 1.0 / tpn);
+    cl_top_hwts_row(out, "doorbell->start", &h->doorbell, ns_per_cycle);
+    cl_top_hwts_row(out, "start->done (card)", &h->service, ns_per_cycle);
+    cl_top_hwts_row(out, "done->host seen", &detect, 1.0 / tpn);
+    if (h->jobs > stored) {
+        fprintf(out, "TSC-correlated spans cover the last %llu of %llu jobs\n",
+                (unsigned long long)stored, (unsigned long long)h->jobs);
+    }
+    if (skewed != 0) {
+        fprintf(out, "%llu jobs had spans below the sync error, recorded as 0\n",
+                (unsigned long long)skewed);
+    }
+    fflush(out);
+    return 0;
+}
+
+#endif // CL_TOP_HWTS_H
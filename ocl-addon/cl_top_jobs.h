@@ -0,0 +1,195 @@
+/*
+ * Copyright 2015-2024 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Host job API over the OCL BAR.
+//
+// cl_top_job_run() submits one batch of up to NUM_REGISTERS words with the
+// plain job protocol (inputs, start, poll, clear) and leaves the result in
+// the output bank. The engine helpers below stream whole arrays through it
+// one batch at a time, so arrays can be any size; only the state the
+// engines carry between jobs lives on the card. Every access goes through
+// cl_top_mmio.h, so they are accounted and run against the model (-E) or
+// the simulation like the rest of the host code.
+
+#ifndef CL_TOP_JOBS_H
+#define CL_TOP_JOBS_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+
+#include <fpga_pci.h>
+
+#include "cl_top_mmio.h"
+#include "cl_top_reduce.h"
+#include "cl_top_regs.h"
+#include "cl_top_scan.h"
+
+#define CL_TOP_JOB_MAX_POLLS    1000    // status reads before a job is declared hung
+
+// Run one job on in[0..n-1]; input registers from n up keep their values
+static inline int cl_top_job_run(pci_bar_handle_t handle, const uint32_t *in, int n) {
+    uint32_t status = 0;
+    int polls = 0;
+    int rc = 0;
+
+    for (int i = 0; i < n && rc == 0; i++) {
+        rc = cl_top_mmio_poke(handle, INPUT_BASE_ADDR + (i * 4), in[i]);
+    }
+    rc = rc ? rc : cl_top_mmio_poke(handle, CONTROL_REG_ADDR, START_BIT);
+    while (rc == 0 && !(status & DONE_BIT)) {
+        if (polls++ == CL_TOP_JOB_MAX_POLLS) {
+            printf("ERROR: Timeout waiting for job completion after %d polls\n", polls - 1);
+            return -ETIMEDOUT;
+        }
+        rc = cl_top_mmio_peek(handle, STATUS_REG_ADDR, &status);
+    }
+    rc = rc ? rc : cl_top_mmio_poke(handle, CONTROL_REG_ADDR, 0);
+    if (rc != 0) {
+        printf("ERROR: OCL access failed during a job\n");
+    }
+    return rc;
+}
+
+static inline int cl_top_reduce_setup(pci_bar_handle_t handle, uint32_t pred_ctrl,
+                                      uint32_t pred_value, uint32_t red_ctrl) {
+    int rc = cl_top_mmio_poke(handle, PRED_CTRL_ADDR, pred_ctrl);
+    rc = rc ? rc : cl_top_mmio_poke(handle, PRED_VALUE_ADDR, pred_value);
+    rc = rc ? rc : cl_top_mmio_poke(handle, RED_CTRL_ADDR, red_ctrl);
+    return rc;
+}
+
+static inline int cl_top_reduce_read(pci_bar_handle_t handle, struct cl_top_reduce *r) {
+    uint32_t lo = 0;
+    uint32_t hi = 0;
+    int rc;
+
+    rc = cl_top_mmio_peek(handle, RED_SUM_LO_ADDR, &lo);
+    rc = rc ? rc : cl_top_mmio_peek(handle, RED_SUM_HI_ADDR, &hi);
+    rc = rc ? rc : cl_top_mmio_peek(handle, RED_MIN_ADDR, &r->min);
+    rc = rc ? rc : cl_top_mmio_peek(handle, RED_MAX_ADDR, &r->max);
+    rc = rc ? rc : cl_top_mmio_peek(handle, RED_COUNT_ADDR, &r->count);
+    rc = rc ? rc : cl_top_mmio_peek(handle, RED_WORDS_ADDR, &r->words);
+    r->sum = ((uint64_t)hi << 32) | lo;
+    return rc;
+}
+
+// Reduce x[0..n-1] on the card: the inputs themselves, or with
+// RED_CTRL_RESULTS in 'flags' what the kernel makes of them. The results
+// accumulate on the card across batches and are read once at the end; the
+// last batch masks off the lanes past n.
+static inline int cl_top_reduce_array(pci_bar_handle_t handle, uint32_t pred_ctrl,
+                                      uint32_t pred_value, uint32_t flags, const uint32_t *x,
+                                      size_t n, struct cl_top_reduce *r) {
+    uint32_t red_ctrl = RED_CTRL_ACCUMULATE | (flags & RED_CTRL_RESULTS);
+    int rc;
+
+    if (n > UINT32_MAX) {
+        printf("ERROR: %zu words overflow the reduction's word count\n", n);
+        return -EINVAL;
+    }
+    rc = cl_top_reduce_setup(handle, pred_ctrl, pred_value,
+                             red_ctrl | RED_CTRL_CLEAR | RED_CTRL_MASK_ALL);
+    for (size_t i = 0; i < n && rc == 0; i += NUM_REGISTERS) {
+        int m = n - i < NUM_REGISTERS ? (int)(n - i) : NUM_REGISTERS;
+        if (m < NUM_REGISTERS) {
+            rc = cl_top_mmio_poke(handle, RED_CTRL_ADDR, red_ctrl | RED_CTRL_MASK((1u << m) - 1));
+        }
+        rc = rc ? rc : cl_top_job_run(handle, &x[i], m);
+        cl_top_mmio_job_end(m);
+    }
+    return rc ? rc : cl_top_reduce_read(handle, r);
+}
+
+// Prefix sum of x[0..n-1] into y on a scan kernel, SCAN_OP_EXCLUSIVE in
+// 'op' for an exclusive scan. The scan starts from 'carry' and *carry_out
+// gets the carry after the last word, so an array larger than one call
+// wants is scanned in chunks, each resuming from the previous one's carry.
+// Between jobs the carry stays on the card; a short last batch is padded
+// with zeros so the card's carry stays valid.
+static inline int cl_top_scan_array(pci_bar_handle_t handle, uint32_t op, uint32_t carry,
+                                    const uint32_t *x, uint32_t *y, size_t n,
+                                    uint32_t *carry_out) {
+    uint32_t batch[NUM_REGISTERS] = {0};
+    uint32_t next = op & SCAN_OP_EXCLUSIVE;
+    int rc;
+
+    rc = cl_top_mmio_poke(handle, JOB_OPERAND_ADDR, carry);
+    rc = rc ? rc : cl_top_mmio_poke(handle, JOB_OPCODE_ADDR, next | SCAN_OP_LOAD);
+    for (size_t i = 0; i < n && rc == 0; i += NUM_REGISTERS) {
+        int m = n - i < NUM_REGISTERS ? (int)(n - i) : NUM_REGISTERS;
+        const uint32_t *in = &x[i];
+        if (m < NUM_REGISTERS) {
+            memcpy(batch, in, m * sizeof(*in));
+            in = batch;
+        }
+        rc = cl_top_job_run(handle, in, NUM_REGISTERS);
+        if (rc == 0 && i == 0) {
+            rc = cl_top_mmio_poke(handle, JOB_OPCODE_ADDR, next);
+        }
+        for (int j = 0; j < m && rc == 0; j++) {
+            rc = cl_top_mmio_peek(handle, OUTPUT_BASE_ADDR + (j * 4), &y[i + j]);
+        }
+        cl_top_mmio_job_end(m);
+    }
+    if (rc == 0 && carry_out != NULL) {
+        *carry_out = n == 0 ? carry : y[n - 1] + ((op & SCAN_OP_EXCLUSIVE) ? x[n - 1] : 0);
+    }
+    return rc;
+}
+
+// Keep the words of x[0..n-1] matching the predicate, or with
+// COMPACT_CTRL_RESULTS in 'flags' the matching words the kernel makes of
+// them, packed into y in order; *count gets how many. Each batch reads
+// COMPACT_COUNT and then only that many output registers, so the words the
+// predicate drops never cross the bus. The last batch masks off the lanes
+// past n. y has room for n words; compaction is disabled again at the end.
+static inline int cl_top_compact_array(pci_bar_handle_t handle, uint32_t pred_ctrl,
+                                       uint32_t pred_value, uint32_t flags, const uint32_t *x,
+                                       size_t n, uint32_t *y, size_t *count) {
+    uint32_t cmp_ctrl = COMPACT_CTRL_ENABLE | (flags & COMPACT_CTRL_RESULTS);
+    uint32_t k = 0;
+    size_t kept = 0;
+    int rc;
+
+    rc = cl_top_mmio_poke(handle, PRED_CTRL_ADDR, pred_ctrl);
+    rc = rc ? rc : cl_top_mmio_poke(handle, PRED_VALUE_ADDR, pred_value);
+    rc = rc ? rc : cl_top_mmio_poke(handle, COMPACT_CTRL_ADDR, cmp_ctrl | COMPACT_CTRL_MASK_ALL);
+    for (size_t i = 0; i < n && rc == 0; i += NUM_REGISTERS) {
+        int m = n - i < NUM_REGISTERS ? (int)(n - i) : NUM_REGISTERS;
+        if (m < NUM_REGISTERS) {
+            rc = cl_top_mmio_poke(handle, COMPACT_CTRL_ADDR,
+                                  cmp_ctrl | COMPACT_CTRL_MASK((1u << m) - 1));
+        }
+        rc = rc ? rc : cl_top_job_run(handle, &x[i], m);
+        rc = rc ? rc : cl_top_mmio_peek(handle, COMPACT_COUNT_ADDR, &k);
+        if (rc == 0 && k > (uint32_t)m) {
+            printf("ERROR: Compaction kept %u of %d words\n", k, m);
+            rc = -EIO;
+        }
+        for (uint32_t j = 0; j < k && rc == 0; j++) {
+            rc = cl_top_mmio_peek(handle, OUTPUT_BASE_ADDR + (j * 4), &y[kept + j]);
+        }
+        kept += rc == 0 ? k : 0;
+        cl_top_mmio_job_end(m);
+    }
+    rc = rc ? rc : cl_top_mmio_poke(handle, COMPACT_CTRL_ADDR, COMPACT_CTRL_MASK_ALL);
+    *count = kept;
+    return rc;
+}
+
+#endif // CL_TOP_JOBS_H
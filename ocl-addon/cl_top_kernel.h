@@ -0,0 +1,78 @@
+/*
+ * Copyright 2015-2024 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Kernel slot discovery.
+//
+// cl_top's compute stage is an AXI-Stream kernel chosen at build time by
+// the KERNEL parameter. The kernel reports its ID and capabilities at OCL
+// KERNEL_ID_ADDR and KERNEL_CAPS_ADDR, so the host can tell which kernel an
+// AFI carries before submitting work. An AFI built before the kernel slot
+// existed returns 0xDEADBEEF for both, which decodes as an unknown kernel.
+
+#ifndef CL_TOP_KERNEL_H
+#define CL_TOP_KERNEL_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include <fpga_pci.h>
+
+#include "cl_top_mmio.h"
+#include "cl_top_regs.h"
+
+struct cl_top_kernel_info {
+    uint16_t id;
+    uint16_t version;
+    uint32_t lanes;
+    uint32_t latency;       // clk_main_a0 cycles, input beat to result beat
+    uint32_t flags;
+};
+
+static inline const char *cl_top_kernel_name(uint16_t id) {
+    switch (id) {
+    case KERNEL_ADD_ONE:    return "add-one";
+    case KERNEL_ALU:        return "alu";
+    case KERNEL_SCAN:       return "scan";
+    default:                return "unknown";
+    }
+}
+
+static inline int cl_top_kernel_probe(pci_bar_handle_t handle, struct cl_top_kernel_info *info) {
+    uint32_t id = 0;
+    uint32_t caps = 0;
+    int rc;
+
+    rc = cl_top_mmio_bar_peek(handle, KERNEL_ID_ADDR, &id);
+    if (rc == 0) {
+        rc = cl_top_mmio_bar_peek(handle, KERNEL_CAPS_ADDR, &caps);
+    }
+    if (rc != 0) {
+        return rc;
+    }
+    info->id = KERNEL_ID(id);
+    info->version = KERNEL_VERSION(id);
+    info->lanes = KERNEL_CAPS_LANES(caps);
+    info->latency = KERNEL_CAPS_LATENCY(caps);
+    info->flags = KERNEL_CAPS_FLAGS(caps);
+    return 0;
+}
+
+static inline void cl_top_kernel_print(const struct cl_top_kernel_info *info) {
+    printf("Kernel: %s (id 0x%04x, version %u), %u lanes, %u cycle latency, flags 0x%04x\n",
+           cl_top_kernel_name(info->id), info->id, info->version, info->lanes, info->latency,
+           info->flags);
+}
+
+#endif // CL_TOP_KERNEL_H
@@ -0,0 +1,493 @@
+/*
+ * Copyright 2015-2024 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Lockstep check of cl_top_model.h against the Verilated cl_top RTL.
+//
+//   cl_top_lockstep [-n steps] [-s seed] [-k kernel] [-v]
+//
+// Drives the OCL slave of the Verilated design with one transaction
+// outstanding, the way cl_top_model.h assumes, and issues every transaction
+// to the model as well: jobs with random data under random job opcodes and
+// operands, predicates, reduction and compaction settings, random reads
+// across the register map, perf and histogram clears, trace configuration,
+// writes and reads of unmapped addresses, start while busy, and random idle
+// gaps.
+// Each read value and the cycle of every AW/W/B/AR/R handshake must match;
+// the first divergence is printed and the run exits non-zero. Cycles are
+// counted like the card's cycle counter, from the first cycle out of reset.
+// -k gives the KERNEL parameter the design was built with (default 2, ALU;
+// add -GKERNEL=<id> to the verilator line for another kernel).
+//
+// Build with Verilator 5, from the HDK environment (hdk_setup.sh), adding
+// the include and library directories the HDK simulation flow passes for
+// cl_top:
+//
+//   verilator --cc --exe --build -O3 -DSYNTHESIS --top-module cl_top
+//       -I<cl design dir> -I$HDK_SHELL_DESIGN_DIR/interfaces -y <sh_ddr dir>
+//       cl_top.sv cl_kernel_pipe.sv cl_kernel_alu.sv cl_kernel_add_one.sv
+//       cl_kernel_scan.sv
+//       cl_top_lockstep.cpp
+//       -CFLAGS -I$PWD -o cl_top_lockstep
+
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <unistd.h>
+
+#include <verilated.h>
+#include "Vcl_top.h"
+
+#include "cl_top_alu.h"
+#include "cl_top_model.h"
+#include "cl_top_reduce.h"
+#include "cl_top_regs.h"
+#include "cl_top_scan.h"
+
+#define LOCKSTEP_RESET_CYCLES   8
+#define LOCKSTEP_XACT_TIMEOUT   64      // cycles before a transaction is declared hung
+#define LOCKSTEP_MAX_IDLE       24
+
+struct lockstep {
+    Vcl_top *dut;
+    struct cl_top_model model;
+    int64_t cycle;              // value of the card's cycle counter at the next edge
+    uint64_t xacts;
+    uint64_t jobs;
+    bool verbose;
+};
+
+static void clock_edge(struct lockstep *ls) {
+    ls->dut->clk_main_a0 = 1;
+    ls->dut->eval();
+    ls->cycle++;
+    ls->dut->clk_main_a0 = 0;
+    ls->dut->eval();
+}
+
+static void dut_reset(struct lockstep *ls) {
+    ls->dut->clk_main_a0 = 0;
+    ls->dut->rst_main_n = 0;
+    ls->dut->ocl_cl_awvalid = 0;
+    ls->dut->ocl_cl_wvalid = 0;
+    ls->dut->ocl_cl_bready = 0;
+    ls->dut->ocl_cl_arvalid = 0;
+    ls->dut->ocl_cl_rready = 0;
+    ls->dut->sda_cl_awvalid = 0;
+    ls->dut->sda_cl_wvalid = 0;
+    ls->dut->sda_cl_bready = 0;
+    ls->dut->sda_cl_arvalid = 0;
+    ls->dut->sda_cl_rready = 0;
+    ls->dut->eval();
+    for (int i = 0; i < LOCKSTEP_RESET_CYCLES; i++) {
+        clock_edge(ls);
+    }
+    // rst_main_n goes through a two-flop synchronizer; the counter starts
+    // at 0 on the third edge after release
+    ls->dut->rst_main_n = 1;
+    ls->cycle = -2;
+}
+
+static int dut_write(struct lockstep *ls, uint32_t addr, uint32_t data,
+                     struct cl_top_model_xact *x) {
+    Vcl_top *d = ls->dut;
+
+    x->write = true;
+    x->addr = addr;
+    x->data = data;
+    d->ocl_cl_awaddr = addr;
+    d->ocl_cl_awvalid = 1;
+    d->ocl_cl_wdata = data;
+    d->ocl_cl_wstrb = 0xF;
+    d->ocl_cl_wvalid = 1;
+    d->ocl_cl_bready = 1;
+    for (int i = 0; i < LOCKSTEP_XACT_TIMEOUT; i++) {
+        bool aw, w, b;
+
+        d->eval();
+        aw = d->ocl_cl_awvalid && d->cl_ocl_awready;
+        w = d->ocl_cl_wvalid && d->cl_ocl_wready;
+        b = d->ocl_cl_bready && d->cl_ocl_bvalid;
+        if (aw) {
+            x->addr_hs = (uint64_t)ls->cycle;
+        }
+        if (w) {
+            x->data_hs = (uint64_t)ls->cycle;
+        }
+        if (b) {
+            x->resp_hs = (uint64_t)ls->cycle;
+        }
+        clock_edge(ls);
+        if (aw) {
+            d->ocl_cl_awvalid = 0;
+        }
+        if (w) {
+            d->ocl_cl_wvalid = 0;
+        }
+        if (b) {
+            d->ocl_cl_bready = 0;
+            return 0;
+        }
+    }
+    printf("ERROR: RTL write to 0x%03x hung at cycle %lld\n", addr, (long long)ls->cycle);
+    return 1;
+}
+
+static int dut_read(struct lockstep *ls, uint32_t addr, struct cl_top_model_xact *x) {
+    Vcl_top *d = ls->dut;
+
+    x->write = false;
+    x->addr = addr;
+    x->data_hs = 0;
+    d->ocl_cl_araddr = addr;
+    d->ocl_cl_arvalid = 1;
+    d->ocl_cl_rready = 1;
+    for (int i = 0; i < LOCKSTEP_XACT_TIMEOUT; i++) {
+        bool ar, r;
+
+        d->eval();
+        ar = d->ocl_cl_arvalid && d->cl_ocl_arready;
+        r = d->ocl_cl_rready && d->cl_ocl_rvalid;
+        if (ar) {
+            x->addr_hs = (uint64_t)ls->cycle;
+        }
+        if (r) {
+            x->resp_hs = (uint64_t)ls->cycle;
+            x->data = d->cl_ocl_rdata;
+        }
+        clock_edge(ls);
+        if (ar) {
+            d->ocl_cl_arvalid = 0;
+        }
+        if (r) {
+            d->ocl_cl_rready = 0;
+            return 0;
+        }
+    }
+    printf("ERROR: RTL read of 0x%03x hung at cycle %lld\n", addr, (long long)ls->cycle);
+    return 1;
+}
+
+static int compare(struct lockstep *ls, const struct cl_top_model_xact *rtl) {
+    const struct cl_top_model_xact *mod = &ls->model.last;
+    bool data_ok = rtl->write || mod->unmodeled || rtl->data == mod->data;
+
+    ls->xacts++;
+    if (ls->verbose) {
+        printf("%8llu %s 0x%03x = 0x%08x  hs %llu/%llu/%llu\n", (unsigned long long)ls->xacts,
+               rtl->write ? "W" : "R", rtl->addr, rtl->data,
+               (unsigned long long)rtl->addr_hs, (unsigned long long)rtl->data_hs,
+               (unsigned long long)rtl->resp_hs);
+    }
+    if (data_ok && rtl->addr_hs == mod->addr_hs && rtl->data_hs == mod->data_hs &&
+        rtl->resp_hs == mod->resp_hs) {
+        return 0;
+    }
+    printf("ERROR: Model diverged from RTL at transaction %llu (%s 0x%03x)\n",
+           (unsigned long long)ls->xacts, rtl->write ? "write" : "read", rtl->addr);
+    printf("       %-6s %10s %10s %10s %10s\n", "", "data", rtl->write ? "aw" : "ar",
+           rtl->write ? "w" : "-", rtl->write ? "b" : "r");
+    printf("       %-6s 0x%08x %10llu %10llu %10llu\n", "rtl", rtl->data,
+           (unsigned long long)rtl->addr_hs, (unsigned long long)rtl->data_hs,
+           (unsigned long long)rtl->resp_hs);
+    printf("       %-6s 0x%08x %10llu %10llu %10llu\n", "model", mod->data,
+           (unsigned long long)mod->addr_hs, (unsigned long long)mod->data_hs,
+           (unsigned long long)mod->resp_hs);
+    return 1;
+}
+
+static int poke(struct lockstep *ls, uint32_t addr, uint32_t data) {
+    struct cl_top_model_xact rtl = {};
+
+    cl_top_model_poke(&ls->model, addr, data);
+    if (dut_write(ls, addr, data, &rtl) != 0) {
+        return 1;
+    }
+    return compare(ls, &rtl);
+}
+
+static int peek(struct lockstep *ls, uint32_t addr, uint32_t *data) {
+    struct cl_top_model_xact rtl = {};
+
+    cl_top_model_peek(&ls->model, addr, data);
+    if (dut_read(ls, addr, &rtl) != 0) {
+        return 1;
+    }
+    *data = rtl.data;
+    return compare(ls, &rtl);
+}
+
+static void idle(struct lockstep *ls, unsigned cycles) {
+    for (unsigned i = 0; i < cycles; i++) {
+        // The model's clock starts with the counter, out of reset
+        if (ls->cycle >= 0) {
+            cl_top_model_idle(&ls->model, 1);
+        }
+        clock_edge(ls);
+    }
+}
+
+// The host protocol, with the result checked against the kernel's C
+// reference, compacted when compaction is enabled, and, unless the
+// reduction accumulates, the reduction against cl_top_reduce.h
+static int job(struct lockstep *ls, std::mt19937 &rng) {
+    static const uint32_t red_regs[] = {
+        RED_SUM_LO_ADDR, RED_SUM_HI_ADDR, RED_MIN_ADDR, RED_MAX_ADDR, RED_COUNT_ADDR,
+        RED_WORDS_ADDR,
+    };
+    uint32_t data[NUM_REGISTERS];
+    uint32_t result[NUM_REGISTERS];
+    uint32_t want[NUM_REGISTERS] = {};
+    uint32_t lanes[NUM_REGISTERS];
+    struct cl_top_reduce red = {};
+    uint32_t red_ctrl = ls->model.red_ctrl;
+    uint32_t cmp_ctrl = ls->model.cmp_ctrl;
+    uint32_t want_count = NUM_REGISTERS;
+    uint32_t carry;
+    int n = 0;
+    uint32_t v = 0;
+    int polls = 0;
+
+    if (poke(ls, CONTROL_REG_ADDR, 0) != 0) {
+        return 1;
+    }
+    for (int i = 0; i < NUM_REGISTERS; i++) {
+        // Small values too, so equality predicates match now and then
+        data[i] = rng() % 4 ? rng() : rng() % 8;
+        if (poke(ls, INPUT_BASE_ADDR + (i * 4), data[i]) != 0) {
+            return 1;
+        }
+    }
+    // Any job started without waiting has completed by now
+    carry = ls->model.scan_carry;
+    switch (ls->model.kernel) {
+    case KERNEL_ADD_ONE:
+        cl_top_alu_apply_n(ALU_OP_ADD, 1, data, result, NUM_REGISTERS);
+        break;
+    case KERNEL_SCAN:
+        cl_top_scan_apply_n(ls->model.job_opcode, ls->model.job_operand, &carry, data, result,
+                            NUM_REGISTERS);
+        break;
+    default:
+        cl_top_alu_apply_n(ls->model.job_opcode, ls->model.job_operand, data, result,
+                           NUM_REGISTERS);
+        break;
+    }
+    if (cmp_ctrl & COMPACT_CTRL_ENABLE) {
+        want_count = 0;
+        for (int i = 0; i < NUM_REGISTERS; i++) {
+            uint32_t x = (cmp_ctrl & COMPACT_CTRL_RESULTS) ? result[i] : data[i];
+            if ((COMPACT_CTRL_MASK_GET(cmp_ctrl) & (1u << i)) &&
+                cl_top_pred_match(ls->model.pred_ctrl, ls->model.pred_value, x)) {
+                want[want_count++] = x;
+            }
+        }
+    } else {
+        memcpy(want, result, sizeof(want));
+    }
+    if (poke(ls, CONTROL_REG_ADDR, START_BIT) != 0) {
+        return 1;
+    }
+    do {
+        if (rng() % 4 == 0) {
+            idle(ls, rng() % LOCKSTEP_MAX_IDLE);
+        }
+        if (peek(ls, STATUS_REG_ADDR, &v) != 0) {
+            return 1;
+        }
+    } while (!(v & DONE_BIT) && ++polls < LOCKSTEP_XACT_TIMEOUT);
+    if (poke(ls, CONTROL_REG_ADDR, 0) != 0) {
+        return 1;
+    }
+    for (int i = 0; i < NUM_REGISTERS; i++) {
+        if (peek(ls, OUTPUT_BASE_ADDR + (i * 4), &v) != 0) {
+            return 1;
+        }
+        if (v != want[i]) {
+            printf("ERROR: RTL output %d is 0x%08x, expected 0x%08x\n", i, v, want[i]);
+            return 1;
+        }
+    }
+    if (peek(ls, COMPACT_COUNT_ADDR, &v) != 0) {
+        return 1;
+    }
+    if (v != want_count) {
+        printf("ERROR: RTL compaction count is %u, expected %u\n", v, want_count);
+        return 1;
+    }
+    for (int i = 0; i < NUM_REGISTERS; i++) {
+        if (RED_CTRL_MASK_GET(red_ctrl) & (1u << i)) {
+            lanes[n++] = (red_ctrl & RED_CTRL_RESULTS) ? result[i] : data[i];
+        }
+    }
+    cl_top_reduce_add(&red, ls->model.pred_ctrl, ls->model.pred_value, lanes, n);
+    const uint32_t want_red[] = {
+        (uint32_t)red.sum, (uint32_t)(red.sum >> 32), red.min, red.max, red.count, red.words,
+    };
+    for (int i = 0; i < (int)(sizeof(red_regs) / sizeof(red_regs[0])); i++) {
+        if (peek(ls, red_regs[i], &v) != 0) {
+            return 1;
+        }
+        if (!(red_ctrl & RED_CTRL_ACCUMULATE) && v != want_red[i]) {
+            printf("ERROR: RTL reduction register 0x%03x is 0x%08x, expected 0x%08x\n",
+                   red_regs[i], v, want_red[i]);
+            return 1;
+        }
+    }
+    ls->jobs++;
+    return 0;
+}
+
+// Every address the model tracks, plus unmapped ones
+static uint32_t random_read_addr(std::mt19937 &rng) {
+    static const uint32_t fixed[] = {
+        CONTROL_REG_ADDR, STATUS_REG_ADDR, KERNEL_ID_ADDR, KERNEL_CAPS_ADDR,
+        JOB_OPCODE_ADDR, JOB_OPERAND_ADDR, PRED_CTRL_ADDR, PRED_VALUE_ADDR, RED_CTRL_ADDR,
+        RED_SUM_LO_ADDR, RED_SUM_HI_ADDR, RED_MIN_ADDR, RED_MAX_ADDR, RED_COUNT_ADDR,
+        RED_WORDS_ADDR, COMPACT_CTRL_ADDR,
+        PERF_JOBS_ADDR, PERF_BUSY_CYCLES_ADDR, PERF_OCL_WRITES_ADDR, PERF_OCL_READS_ADDR,
+        COMPACT_COUNT_ADDR,
+        HWTS_CYCLE_LO_ADDR, HWTS_CYCLE_HI_ADDR, HWTS_START_LO_ADDR, HWTS_START_HI_ADDR,
+        HWTS_DONE_LO_ADDR, HWTS_DONE_HI_ADDR, HWTS_DOORBELL_LO_ADDR, HWTS_DOORBELL_HI_ADDR,
+        OCL_TRACE_CTRL_ADDR, OCL_TRACE_EVMASK_ADDR, OCL_TRACE_AMATCH_ADDR,
+        OCL_TRACE_AMASK_ADDR, OCL_TRACE_TRIG_ADDR,
+        0x094, 0x0BC, 0x0E0, HIST_CTRL_ADDR, 0x300, 0xFFC,
+    };
+
+    switch (rng() % 4) {
+    case 0:
+        return INPUT_BASE_ADDR + (rng() % NUM_REGISTERS) * 4;
+    case 1:
+        return OUTPUT_BASE_ADDR + (rng() % NUM_REGISTERS) * 4;
+    case 2:
+        return (rng() % 2 ? HIST_SVC_BASE_ADDR : HIST_REACT_BASE_ADDR) + (rng() % HIST_BINS) * 4;
+    default:
+        return fixed[rng() % (sizeof(fixed) / sizeof(fixed[0]))];
+    }
+}
+
+static int random_write(struct lockstep *ls, std::mt19937 &rng) {
+    static const uint32_t unmapped[] = { 0x094, 0x0BC, 0x0E0, 0x300, 0xFFC };
+
+    switch (rng() % 10) {
+    case 0:
+        return poke(ls, PERF_JOBS_ADDR, 0);
+    case 8:
+        // Predicate, reduction and compaction settings, clears and read-only
+        // results included
+        switch (rng() % 5) {
+        case 0:
+            return poke(ls, PRED_CTRL_ADDR, rng());
+        case 1:
+            return poke(ls, PRED_VALUE_ADDR, rng() % 2 ? rng() % 8 : rng());
+        case 2:
+            return poke(ls, RED_CTRL_ADDR, rng() % 2 ? rng() : RED_CTRL_MASK_ALL);
+        case 3:
+            return poke(ls, COMPACT_CTRL_ADDR, rng() % 2 ? rng() : COMPACT_CTRL_MASK_ALL);
+        default:
+            return poke(ls, RED_SUM_LO_ADDR + (rng() % 6) * 4, rng());
+        }
+    case 7:
+        // ALU arguments for the following jobs, reserved opcodes included
+        if (rng() % 2) {
+            return poke(ls, JOB_OPCODE_ADDR, rng());
+        }
+        return poke(ls, JOB_OPERAND_ADDR, rng() % 2 ? rng() % 40 : rng());
+    case 1:
+        return poke(ls, HIST_CTRL_ADDR, rng() % 2 ? HIST_CLEAR_BIT : 0);
+    case 2:
+        // Trace configuration only; recording stays off
+        return poke(ls, OCL_TRACE_EVMASK_ADDR + (rng() % 4) * 4, rng());
+    case 3:
+        return poke(ls, unmapped[rng() % (sizeof(unmapped) / sizeof(unmapped[0]))], rng());
+    case 4:
+        // Read-only registers ignore writes
+        return poke(ls, OUTPUT_BASE_ADDR + (rng() % NUM_REGISTERS) * 4, rng());
+    case 5:
+        // Start without waiting: exercises start-while-busy and done held
+        return poke(ls, CONTROL_REG_ADDR, rng() % 2);
+    default:
+        return poke(ls, INPUT_BASE_ADDR + (rng() % NUM_REGISTERS) * 4, rng());
+    }
+}
+
+int main(int argc, char **argv) {
+    static struct lockstep ls;
+    uint64_t steps = 100000;
+    uint32_t seed = 1;
+    uint32_t kernel = KERNEL_ALU;
+    uint32_t v = 0;
+    int rc = 0;
+    int opt;
+
+    Verilated::commandArgs(argc, argv);
+    while ((opt = getopt(argc, argv, "n:s:k:v")) != -1) {
+        switch (opt) {
+        case 'n':
+            steps = strtoull(optarg, NULL, 0);
+            break;
+        case 's':
+            seed = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 'k':
+            kernel = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 'v':
+            ls.verbose = true;
+            break;
+        default:
+            printf("Usage: %s [-n steps] [-s seed] [-k kernel] [-v]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    std::mt19937 rng(seed);
+    ls.dut = new Vcl_top;
+    cl_top_model_init(&ls.model, 0);
+    cl_top_model_set_kernel(&ls.model, kernel);
+    dut_reset(&ls);
+
+    for (uint64_t i = 0; i < steps && rc == 0; i++) {
+        switch (rng() % 8) {
+        case 0:
+        case 1:
+        case 2:
+            rc = job(&ls, rng);
+            break;
+        case 3:
+        case 4:
+            rc = peek(&ls, random_read_addr(rng), &v);
+            break;
+        case 5:
+        case 6:
+            rc = random_write(&ls, rng);
+            break;
+        default:
+            idle(&ls, rng() % LOCKSTEP_MAX_IDLE);
+            break;
+        }
+    }
+
+    if (rc == 0) {
+        printf("LOCKSTEP PASS: seed %u, %llu transactions, %llu jobs, %lld cycles\n", seed,
+               (unsigned long long)ls.xacts, (unsigned long long)ls.jobs, (long long)ls.cycle);
+    } else {
+        printf("LOCKSTEP FAIL: seed %u, cycle %lld\n", seed, (long long)ls.cycle);
+    }
+    ls.dut->final();
+    delete ls.dut;
+    return rc;
+}
@@ -0,0 +1,334 @@
+/*
+ * Copyright 2015-2024 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Prometheus metrics exporter for the Add-One host runtime.
+//
+// The job path only bumps relaxed atomic counters and a latency histogram.
+// A background thread renders them, together with the hardware perf
+// counters read from cl_top, in Prometheus text format and either
+//   - rewrites a textfile (write to <path>.tmp, rename) every interval, for
+//     the node_exporter textfile collector, or
+//   - serves the text over HTTP on a local Unix socket ("unix:<path>"),
+//     e.g. curl --unix-socket <path> http://localhost/metrics
+// so hardware reads and formatting never run on the job path.
+
+#ifndef CL_TOP_METRICS_H
+#define CL_TOP_METRICS_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include <limits.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+
+#include <fpga_pci.h>
+
+#include "cl_top_mmio.h"
+#include "cl_top_regs.h"
+#include "cl_top_stats.h"
+
+#define METRICS_INTERVAL_MS     1000
+#define METRICS_BUF_SIZE        8192
+#define METRICS_CLIENT_TIMEOUT_MS 1000  // a client gets this long to send, then is dropped
+
+struct cl_top_metrics {
+    bool enabled;
+
+    // Updated on the job path with relaxed atomics
+    uint64_t jobs;
+    uint64_t words;
+    uint64_t timeouts;
+    uint64_t errors;
+    uint64_t polls;
+    uint64_t latency_count;
+    uint64_t latency_sum;               // TSC ticks
+    uint64_t latency_buckets[STATS_NUM_BUCKETS];
+
+    // Exporter state
+    const char *target;
+    const struct cl_top_stats *clock;   // TSC calibration
+    pci_bar_handle_t bar;
+    int slot;
+    int listen_fd;
+    bool stop;
+    pthread_t thread;
+    uint64_t hw_scrape_errors;
+    size_t len;
+    char buf[METRICS_BUF_SIZE];
+};
+
+static inline void cl_top_metrics_job(struct cl_top_metrics *m, uint64_t latency_ticks,
+                                      uint32_t polls, uint32_t words) {
+    if (__builtin_expect(!m->enabled, 1)) {
+        return;
+    }
+    __atomic_fetch_add(&m->jobs, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&m->words, words, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&m->polls, polls, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&m->latency_count, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&m->latency_sum, latency_ticks, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&m->latency_buckets[cl_top_hist_index(latency_ticks)], 1, __ATOMIC_RELAXED);
+}
+
+static inline void cl_top_metrics_timeout(struct cl_top_metrics *m, uint32_t polls) {
+    if (__builtin_expect(!m->enabled, 1)) {
+        return;
+    }
+    __atomic_fetch_add(&m->timeouts, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&m->polls, polls, __ATOMIC_RELAXED);
+}
+
+static inline void cl_top_metrics_error(struct cl_top_metrics *m) {
+    if (__builtin_expect(!m->enabled, 1)) {
+        return;
+    }
+    __atomic_fetch_add(&m->errors, 1, __ATOMIC_RELAXED);
+}
+
+//-----------------------------------------------------------------------------
+// Exporter thread
+//-----------------------------------------------------------------------------
+
+__attribute__((format(printf, 2, 3)))
+static inline void cl_top_metrics_printf(struct cl_top_metrics *m, const char *fmt, ...) {
+    va_list ap;
+    if (m->len >= sizeof(m->buf)) {
+        return;
+    }
+    va_start(ap, fmt);
+    int n = vsnprintf(m->buf + m->len, sizeof(m->buf) - m->len, fmt, ap);
+    va_end(ap);
+    if (n > 0) {
+        m->len += (size_t)n;
+    }
+}
+
+static inline void cl_top_metrics_counter(struct cl_top_metrics *m, const char *name,
+                                          const char *help, uint64_t value) {
+    cl_top_metrics_printf(m, "# HELP %s %s\n# TYPE %s counter\n%s{slot=\"%d\"} %llu\n",
+                          name, help, name, name, m->slot, (unsigned long long)value);
+}
+
+static inline void cl_top_metrics_render(struct cl_top_metrics *m) {
+    static const double quantiles[] = { 0.5, 0.9, 0.99, 0.999 };
+    static const struct {
+        uint64_t addr;
+        const char *name;
+        const char *help;
+    } hw[] = {
+        { PERF_JOBS_ADDR,        "cl_top_hw_jobs_total",
+          "Jobs completed by the card (32-bit, wraps, cleared by a write to 0x80)." },
+        { PERF_BUSY_CYCLES_ADDR, "cl_top_hw_busy_cycles_total",
+          "Cycles the kernel engine was busy (32-bit, wraps, cleared by a write to 0x80)." },
+        { PERF_OCL_WRITES_ADDR,  "cl_top_hw_ocl_writes_total",
+          "OCL write transactions seen by the card (32-bit, wraps, cleared by a write to 0x80)." },
+        { PERF_OCL_READS_ADDR,   "cl_top_hw_ocl_reads_total",
+          "OCL read transactions seen by the card, including these scrapes "
+          "(32-bit, wraps, cleared by a write to 0x80)." },
+    };
+    struct cl_top_hist lat = {0};
+    double tpn = cl_top_stats_ticks_per_ns(m->clock);
+
+    m->len = 0;
+    cl_top_metrics_counter(m, "cl_top_jobs_total", "Jobs completed by the host.",
+                           __atomic_load_n(&m->jobs, __ATOMIC_RELAXED));
+    cl_top_metrics_counter(m, "cl_top_words_total", "Data words processed.",
+                           __atomic_load_n(&m->words, __ATOMIC_RELAXED));
+    cl_top_metrics_counter(m, "cl_top_timeouts_total", "Jobs that timed out waiting for done.",
+                           __atomic_load_n(&m->timeouts, __ATOMIC_RELAXED));
+    cl_top_metrics_counter(m, "cl_top_errors_total", "Jobs that failed.",
+                           __atomic_load_n(&m->errors, __ATOMIC_RELAXED));
+    cl_top_metrics_counter(m, "cl_top_status_polls_total", "Status register polls.",
+                           __atomic_load_n(&m->polls, __ATOMIC_RELAXED));
+
+    // Snapshot the latency buckets; percentiles are computed here, not on the job path
+    lat.count = __atomic_load_n(&m->latency_count, __ATOMIC_RELAXED);
+    lat.sum = __atomic_load_n(&m->latency_sum, __ATOMIC_RELAXED);
+    for (int b = 0; b < STATS_NUM_BUCKETS; b++) {
+        lat.buckets[b] = __atomic_load_n(&m->latency_buckets[b], __ATOMIC_RELAXED);
+        if (lat.buckets[b] != 0) {
+            lat.max = cl_top_hist_lower(b);
+        }
+    }
+    cl_top_metrics_printf(m, "# HELP cl_top_job_latency_seconds Host-measured job latency.\n"
+                             "# TYPE cl_top_job_latency_seconds summary\n");
+    for (size_t q = 0; q < sizeof(quantiles) / sizeof(quantiles[0]); q++) {
+        cl_top_metrics_printf(m, "cl_top_job_latency_seconds{slot=\"%d\",quantile=\"%g\"} %.9f\n",
+                              m->slot, quantiles[q],
+                              (double)cl_top_hist_quantile(&lat, quantiles[q]) / tpn * 1e-9);
+    }
+    cl_top_metrics_printf(m, "cl_top_job_latency_seconds_sum{slot=\"%d\"} %.9f\n",
+                          m->slot, (double)lat.sum / tpn * 1e-9);
+    cl_top_metrics_printf(m, "cl_top_job_latency_seconds_count{slot=\"%d\"} %llu\n",
+                          m->slot, (unsigned long long)lat.count);
+
+    // Hardware perf-counter snapshot, kept out of the host's MMIO accounting
+    for (size_t i = 0; i < sizeof(hw) / sizeof(hw[0]); i++) {
+        uint32_t value = 0;
+        if (cl_top_mmio_bar_peek(m->bar, hw[i].addr, &value) != 0) {
+            m->hw_scrape_errors++;
+            continue;
+        }
+        cl_top_metrics_counter(m, hw[i].name, hw[i].help, value);
+    }
+    cl_top_metrics_counter(m, "cl_top_hw_scrape_errors_total",
+                           "Failed reads of hardware perf counters.", m->hw_scrape_errors);
+}
+
+static inline void cl_top_metrics_write_file(struct cl_top_metrics *m) {
+    char tmp[PATH_MAX];
+    FILE *fp;
+
+    snprintf(tmp, sizeof(tmp), "%s.tmp", m->target);
+    fp = fopen(tmp, "w");
+    if (fp == NULL) {
+        return;
+    }
+    fwrite(m->buf, 1, m->len, fp);
+    if (fclose(fp) == 0) {
+        rename(tmp, m->target);
+    }
+}
+
+static inline void cl_top_metrics_serve(struct cl_top_metrics *m, int fd) {
+    struct pollfd pfd = { .fd = fd, .events = POLLIN };
+    struct timeval tv = {
+        .tv_sec = METRICS_CLIENT_TIMEOUT_MS / 1000,
+        .tv_usec = (METRICS_CLIENT_TIMEOUT_MS % 1000) * 1000,
+    };
+    char hdr[128];
+    char req[512];
+    int n;
+
+    // A client that never sends or never reads must not stall the thread,
+    // or cl_top_metrics_stop() with it
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+    if (poll(&pfd, 1, METRICS_CLIENT_TIMEOUT_MS) <= 0) {
+        close(fd);
+        return;
+    }
+
+    // Any request gets the metrics; drain it so closing does not reset the peer
+    if (read(fd, req, sizeof(req)) < 0) {
+        close(fd);
+        return;
+    }
+    cl_top_metrics_render(m);
+    n = snprintf(hdr, sizeof(hdr),
+                 "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\n"
+                 "Content-Length: %zu\r\n\r\n", m->len);
+    if (write(fd, hdr, n) == n) {
+        ssize_t rc = write(fd, m->buf, m->len);
+        (void)rc;
+    }
+    close(fd);
+}
+
+static inline void *cl_top_metrics_thread(void *arg) {
+    struct cl_top_metrics *m = arg;
+
+    while (!__atomic_load_n(&m->stop, __ATOMIC_ACQUIRE)) {
+        if (m->listen_fd >= 0) {
+            struct pollfd pfd = { .fd = m->listen_fd, .events = POLLIN };
+            if (poll(&pfd, 1, 200) > 0) {
+                int fd = accept(m->listen_fd, NULL, NULL);
+                if (fd >= 0) {
+                    cl_top_metrics_serve(m, fd);
+                }
+            }
+        } else {
+            cl_top_metrics_render(m);
+            cl_top_metrics_write_file(m);
+            for (int ms = 0; ms < METRICS_INTERVAL_MS && !__atomic_load_n(&m->stop, __ATOMIC_ACQUIRE); ms += 100) {
+                usleep(100 * 1000);
+            }
+        }
+    }
+
+    // Leave the final totals behind for the textfile collector
+    if (m->listen_fd < 0) {
+        cl_top_metrics_render(m);
+        cl_top_metrics_write_file(m);
+    }
+    return NULL;
+}
+
+// Start exporting to 'target': a textfile path, or "unix:<path>" for a socket
+static inline int cl_top_metrics_start(struct cl_top_metrics *m, const char *target,
+                                       const struct cl_top_stats *clock,
+                                       int slot, pci_bar_handle_t bar) {
+    m->target = target;
+    m->clock = clock;
+    m->slot = slot;
+    m->bar = bar;
+    m->listen_fd = -1;
+    m->stop = false;
+
+    if (strncmp(target, "unix:", 5) == 0) {
+        struct sockaddr_un addr = { .sun_family = AF_UNIX };
+        const char *path = target + 5;
+
+        if (strlen(path) >= sizeof(addr.sun_path)) {
+            errno = ENAMETOOLONG;
+            return -1;
+        }
+        strcpy(addr.sun_path, path);
+        m->listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (m->listen_fd < 0) {
+            return -1;
+        }
+        unlink(path);
+        if (bind(m->listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+            listen(m->listen_fd, 4) != 0) {
+            close(m->listen_fd);
+            m->listen_fd = -1;
+            return -1;
+        }
+    }
+
+    if (pthread_create(&m->thread, NULL, cl_top_metrics_thread, m) != 0) {
+        if (m->listen_fd >= 0) {
+            close(m->listen_fd);
+            m->listen_fd = -1;
+        }
+        return -1;
+    }
+    m->enabled = true;
+    return 0;
+}
+
+static inline void cl_top_metrics_stop(struct cl_top_metrics *m) {
+    if (!m->enabled) {
+        return;
+    }
+    __atomic_store_n(&m->stop, true, __ATOMIC_RELEASE);
+    pthread_join(m->thread, NULL);
+    if (m->listen_fd >= 0) {
+        close(m->listen_fd);
+        unlink(m->target + 5);
+        m->listen_fd = -1;
+    }
+    m->enabled = false;
+}
+
+#endif // CL_TOP_METRICS_H
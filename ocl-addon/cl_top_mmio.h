@@ -0,0 +1,257 @@
+/*
+ * Copyright 2015-2024 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// MMIO accounting for the OCL BAR.
+//
+// cl_top_mmio_peek()/cl_top_mmio_poke() wrap fpga_pci_peek()/fpga_pci_poke()
+// and, when cl_top_mmio_accounting is set, count reads and writes and the
+// TSC ticks spent in them per register, per job and per thread. Counters
+// live in a thread-local block, so accounting needs no atomics; blocks are
+// linked into a global list for the report. With accounting off a wrapper
+// is the SDK call plus one not-taken branch.
+//
+// Setting cl_top_mmio_model sends every access to the transaction-level
+// model (cl_top_model.h) instead of the BAR, so host code runs without a
+// card. In SV_TEST builds accesses go to the RTL in simulation through
+// DPI-C (cl_top_sim.h).
+
+#ifndef CL_TOP_MMIO_H
+#define CL_TOP_MMIO_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#include <fpga_pci.h>
+
+#include "cl_top_model.h"
+#include "cl_top_regs.h"
+#include "cl_top_sim.h"
+#include "cl_top_stats.h"
+
+#define MMIO_ACCT_REGS      64      // per-register counters for offsets 0x00-0xFC
+
+struct cl_top_mmio_counts {
+    uint64_t reads;
+    uint64_t writes;
+    uint64_t read_ticks;
+    uint64_t write_ticks;
+};
+
+struct cl_top_mmio_acct {
+    struct cl_top_mmio_acct *next;
+    uint32_t tid;
+    struct cl_top_mmio_counts reg[MMIO_ACCT_REGS];
+    struct cl_top_mmio_counts other;    // offsets beyond MMIO_ACCT_REGS
+    struct cl_top_mmio_counts total;
+    struct cl_top_mmio_counts job;      // current job, folded in at job end
+    uint64_t jobs;
+    uint64_t words;
+    uint64_t job_mmio_max;
+};
+
+static bool cl_top_mmio_accounting __attribute__((unused)) = false;
+static struct cl_top_mmio_acct *cl_top_mmio_blocks __attribute__((unused)) = NULL;
+static __thread struct cl_top_mmio_acct *cl_top_mmio_self __attribute__((unused)) = NULL;
+static struct cl_top_model *cl_top_mmio_model __attribute__((unused)) = NULL;
+
+// Raw access to the BAR, the model or the simulated RTL, never accounted
+static inline int cl_top_mmio_bar_peek(pci_bar_handle_t handle, uint64_t offset, uint32_t *value) {
+    if (__builtin_expect(cl_top_mmio_model != NULL, 0)) {
+        return cl_top_model_peek(cl_top_mmio_model, offset, value);
+    }
+#ifdef SV_TEST
+    (void)handle;
+    return cl_top_sim_peek(offset, value);
+#else
+    return fpga_pci_peek(handle, offset, value);
+#endif
+}
+
+static inline int cl_top_mmio_bar_poke(pci_bar_handle_t handle, uint64_t offset, uint32_t value) {
+    if (__builtin_expect(cl_top_mmio_model != NULL, 0)) {
+        return cl_top_model_poke(cl_top_mmio_model, offset, value);
+    }
+#ifdef SV_TEST
+    (void)handle;
+    return cl_top_sim_poke(offset, value);
+#else
+    return fpga_pci_poke(handle, offset, value);
+#endif
+}
+
+// Host-side delay between accesses. The model and the simulation advance
+// their own clock instead of sleeping.
+static inline void cl_top_mmio_delay_us(unsigned us) {
+    if (cl_top_mmio_model != NULL) {
+        cl_top_model_idle(cl_top_mmio_model, (uint64_t)us * CLK_MAIN_A0_MHZ);
+        return;
+    }
+#ifdef SV_TEST
+    cl_top_sim_wait_ns(us * 1000);
+#else
+    usleep(us);
+#endif
+}
+
+static inline struct cl_top_mmio_acct *cl_top_mmio_acct_get(void) {
+    struct cl_top_mmio_acct *a = cl_top_mmio_self;
+    if (__builtin_expect(a != NULL, 1)) {
+        return a;
+    }
+    a = calloc(1, sizeof(*a));
+    if (a == NULL) {
+        return NULL;
+    }
+    a->tid = (uint32_t)syscall(SYS_gettid);
+    a->next = __atomic_load_n(&cl_top_mmio_blocks, __ATOMIC_RELAXED);
+    while (!__atomic_compare_exchange_n(&cl_top_mmio_blocks, &a->next, a, true,
+                                        __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+    }
+    cl_top_mmio_self = a;
+    return a;
+}
+
+static inline struct cl_top_mmio_counts *cl_top_mmio_slot(struct cl_top_mmio_acct *a, uint64_t offset) {
+    uint64_t idx = offset >> 2;
+    return idx < MMIO_ACCT_REGS ? &a->reg[idx] : &a->other;
+}
+
+static inline int cl_top_mmio_peek(pci_bar_handle_t handle, uint64_t offset, uint32_t *value) {
+    if (__builtin_expect(!cl_top_mmio_accounting, 1)) {
+        return cl_top_mmio_bar_peek(handle, offset, value);
+    }
+    struct cl_top_mmio_acct *a = cl_top_mmio_acct_get();
+    uint64_t start = cl_top_tsc();
+    int rc = cl_top_mmio_bar_peek(handle, offset, value);
+    uint64_t ticks = cl_top_tsc() - start;
+    if (a != NULL) {
+        struct cl_top_mmio_counts *c = cl_top_mmio_slot(a, offset);
+        c->reads++;
+        c->read_ticks += ticks;
+        a->job.reads++;
+        a->job.read_ticks += ticks;
+    }
+    return rc;
+}
+
+static inline int cl_top_mmio_poke(pci_bar_handle_t handle, uint64_t offset, uint32_t value) {
+    if (__builtin_expect(!cl_top_mmio_accounting, 1)) {
+        return cl_top_mmio_bar_poke(handle, offset, value);
+    }
+    struct cl_top_mmio_acct *a = cl_top_mmio_acct_get();
+    uint64_t start = cl_top_tsc();
+    int rc = cl_top_mmio_bar_poke(handle, offset, value);
+    uint64_t ticks = cl_top_tsc() - start;
+    if (a != NULL) {
+        struct cl_top_mmio_counts *c = cl_top_mmio_slot(a, offset);
+        c->writes++;
+        c->write_ticks += ticks;
+        a->job.writes++;
+        a->job.write_ticks += ticks;
+    }
+    return rc;
+}
+
+// Close the current job on this thread; 'words' is the payload it moved
+static inline void cl_top_mmio_job_end(uint64_t words) {
+    if (__builtin_expect(!cl_top_mmio_accounting, 1)) {
+        return;
+    }
+    struct cl_top_mmio_acct *a = cl_top_mmio_acct_get();
+    if (a == NULL) {
+        return;
+    }
+    uint64_t n = a->job.reads + a->job.writes;
+    a->total.reads += a->job.reads;
+    a->total.writes += a->job.writes;
+    a->total.read_ticks += a->job.read_ticks;
+    a->total.write_ticks += a->job.write_ticks;
+    if (n > a->job_mmio_max) {
+        a->job_mmio_max = n;
+    }
+    a->jobs++;
+    a->words += words;
+    a->job = (struct cl_top_mmio_counts){0};
+}
+
+static inline const char *cl_top_mmio_reg_name(unsigned idx, char *buf, size_t len) {
+    uint32_t offset = idx * 4;
+    if (offset - INPUT_BASE_ADDR < NUM_REGISTERS * 4) {
+        snprintf(buf, len, "input[%u]", (offset - INPUT_BASE_ADDR) / 4);
+    } else if (offset - OUTPUT_BASE_ADDR < NUM_REGISTERS * 4) {
+        snprintf(buf, len, "output[%u]", (offset - OUTPUT_BASE_ADDR) / 4);
+    } else if (offset == CONTROL_REG_ADDR) {
+        snprintf(buf, len, "control");
+    } else if (offset == STATUS_REG_ADDR) {
+        snprintf(buf, len, "status");
+    } else {
+        snprintf(buf, len, "0x%02x", offset);
+    }
+    return buf;
+}
+
+static inline void cl_top_mmio_report(FILE *out, double ticks_per_ns) {
+    struct cl_top_mmio_acct *a;
+
+    if (ticks_per_ns <= 0.0) {
+        ticks_per_ns = 1.0;
+    }
+    fprintf(out, "\n=== MMIO accounting ===\n");
+    for (a = __atomic_load_n(&cl_top_mmio_blocks, __ATOMIC_ACQUIRE); a; a = a->next) {
+        uint64_t mmio = a->total.reads + a->total.writes;
+        char name[16];
+
+        fprintf(out, "Thread %u: %llu jobs, %llu words, %llu reads, %llu writes\n",
+                a->tid, (unsigned long long)a->jobs, (unsigned long long)a->words,
+                (unsigned long long)a->total.reads, (unsigned long long)a->total.writes);
+        if (a->jobs != 0) {
+            fprintf(out, "  MMIO/job:  %.2f (max %llu)\n",
+                    (double)mmio / (double)a->jobs, (unsigned long long)a->job_mmio_max);
+        }
+        if (a->words != 0) {
+            fprintf(out, "  MMIO/word: %.2f (%.2f reads, %.2f writes)\n",
+                    (double)mmio / (double)a->words,
+                    (double)a->total.reads / (double)a->words,
+                    (double)a->total.writes / (double)a->words);
+        }
+        if (a->total.reads != 0) {
+            fprintf(out, "  Read avg:  %.0f ns\n",
+                    (double)a->total.read_ticks / (double)a->total.reads / ticks_per_ns);
+        }
+        if (a->total.writes != 0) {
+            fprintf(out, "  Write avg: %.0f ns\n",
+                    (double)a->total.write_ticks / (double)a->total.writes / ticks_per_ns);
+        }
+
+        fprintf(out, "  %-10s %10s %10s %12s %12s\n", "register", "reads", "writes", "read ns", "write ns");
+        for (unsigned i = 0; i <= MMIO_ACCT_REGS; i++) {
+            const struct cl_top_mmio_counts *c = i < MMIO_ACCT_REGS ? &a->reg[i] : &a->other;
+            if (c->reads == 0 && c->writes == 0) {
+                continue;
+            }
+            fprintf(out, "  %-10s %10llu %10llu %12.0f %12.0f\n",
+                    i < MMIO_ACCT_REGS ? cl_top_mmio_reg_name(i, name, sizeof(name)) : "other",
+                    (unsigned long long)c->reads, (unsigned long long)c->writes,
+                    (double)c->read_ticks / ticks_per_ns, (double)c->write_ticks / ticks_per_ns);
+        }
+    }
+    fflush(out);
+}
+
+#endif // CL_TOP_MMIO_H
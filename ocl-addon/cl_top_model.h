@@ -0,0 +1,529 @@
+/*
+ * Copyright 2015-2024 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Transaction-level model of cl_top's OCL slave.
+//
+// Models the register map, the kernel in the slot (the ALU kernel of the
+// default build, or add-one or scan after cl_top_model_set_kernel(); job
+// opcode and operand registers, cl_top_alu.h, cl_top_scan.h), the reduction
+// engine and stream compaction (cl_top_reduce.h), the perf counters, the
+// cycle timestamps, the latency histograms and the out-of-band job counters
+// and error flags, timed in clk_main_a0 cycles as seen by a master with one
+// transaction outstanding that presents each request the cycle after the
+// previous response (plus host_gap idle cycles). Time is the value of the
+// card's cycle counter: a transaction is evaluated in one call and records
+// the cycle of each handshake, and the engine is advanced lazily from one
+// register access to the next, so a job costs a few dozen instructions
+// instead of a few hundred simulated clocks. cl_top_lockstep.cpp checks
+// every value and handshake cycle against the Verilated RTL.
+//
+// Not modeled: the trace buffer contents (OCL_TRACE_STATUS and the entry
+// and pointer registers read as zero and set last.unmodeled), concurrent
+// reads and writes, and SDA timing (cl_top_model_sda_peek() is untimed).
+//
+// The header is plain C with no SDK dependency, so the same model backs the
+// host emulator (cl_top_mmio.h), the benchmark and the C++ lockstep harness.
+
+#ifndef CL_TOP_MODEL_H
+#define CL_TOP_MODEL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "cl_top_alu.h"
+#include "cl_top_reduce.h"
+#include "cl_top_scan.h"
+#include "cl_top_regs.h"
+
+#define MODEL_ADD_ONE_CYCLES    5       // start accepted -> done
+#define MODEL_WR_W_CYCLES       2       // AW handshake -> W handshake
+#define MODEL_WR_B_CYCLES       4       // AW handshake -> B handshake
+#define MODEL_RD_R_CYCLES       2       // AR handshake -> R handshake
+#define MODEL_READY_CYCLES      2       // response -> AWREADY/ARREADY high again
+#define MODEL_UNMAPPED_DATA     0xDEADBEEF
+#define MODEL_KERNEL_VERSION    0x00010000
+#define MODEL_KERNEL_CAPS       (((MODEL_ADD_ONE_CYCLES - 1) << 8) | NUM_REGISTERS)
+
+enum cl_top_model_engine {
+    MODEL_ENGINE_IDLE = 0,
+    MODEL_ENGINE_BUSY,
+    MODEL_ENGINE_DONE,
+};
+
+// One OCL transaction and the cycles of its handshakes
+struct cl_top_model_xact {
+    bool write;
+    bool unmodeled;         // read of a register the model does not track
+    uint32_t addr;
+    uint32_t data;
+    uint64_t addr_hs;       // AW or AR
+    uint64_t data_hs;       // W (writes only)
+    uint64_t resp_hs;       // B or R
+};
+
+struct cl_top_model {
+    uint32_t host_gap;      // idle cycles between a response and the next request
+    uint64_t now;           // first cycle the next request is presented
+    uint64_t wr_ready;      // first cycle AWREADY is high
+    uint64_t rd_ready;      // first cycle ARREADY is high
+
+    // Engine, evaluated up to (not including) engine_cycle
+    enum cl_top_model_engine engine;
+    uint64_t engine_cycle;
+    uint64_t done_cycle;
+    uint64_t svc_zero;      // cycle the start-to-done counter was last zeroed
+    bool react_pending;
+    uint64_t react_from;    // cycle done was set
+
+    uint32_t input[NUM_REGISTERS];
+    uint32_t output[NUM_REGISTERS];
+    uint32_t control;
+    uint32_t job_opcode;
+    uint32_t job_operand;
+    uint32_t kernel;        // KERNEL_* ID of the kernel in the slot
+    uint32_t scan_carry;
+    uint32_t pred_ctrl;
+    uint32_t pred_value;
+    uint32_t red_ctrl;
+    struct cl_top_reduce red;
+    uint32_t cmp_ctrl;
+    uint32_t cmp_count;
+
+    uint32_t perf_jobs;
+    uint32_t perf_busy;
+    uint32_t perf_writes;
+    uint32_t perf_reads;
+
+    uint64_t cycle_snap;
+    uint64_t last_wr;
+    uint64_t job_start;
+    uint64_t job_done;
+    uint64_t job_doorbell;
+
+    uint32_t hist_svc[HIST_BINS];
+    uint32_t hist_react[HIST_BINS];
+
+    uint32_t trace_ctrl;
+    uint32_t trace_evmask;
+    uint32_t trace_amatch;
+    uint32_t trace_amask;
+    uint32_t trace_trig;
+
+    uint32_t mon_jobs_started;
+    uint32_t mon_jobs_done;
+    uint32_t mon_errors;
+
+    struct cl_top_model_xact last;
+};
+
+static inline void cl_top_model_init(struct cl_top_model *m, uint32_t host_gap) {
+    memset(m, 0, sizeof(*m));
+    m->host_gap = host_gap;
+    // Reset deasserts at cycle 0; the slaves raise READY one cycle later
+    m->wr_ready = 1;
+    m->rd_ready = 1;
+    m->trace_evmask = OCL_TRACE_EV_ALL;
+    m->job_opcode = ALU_OP_ADD;
+    m->job_operand = 1;
+    m->kernel = KERNEL_ALU;
+    m->red_ctrl = RED_CTRL_MASK_ALL;
+    m->cmp_ctrl = COMPACT_CTRL_MASK_ALL;
+}
+
+static inline uint64_t cl_top_model_max(uint64_t a, uint64_t b) {
+    return a > b ? a : b;
+}
+
+// floor(log2(v)), clamped to the last histogram bin
+static inline unsigned cl_top_model_hist_bin(uint64_t v) {
+    unsigned b = v > 1 ? 63 - (unsigned)__builtin_clzll(v) : 0;
+    return b < HIST_BINS ? b : HIST_BINS - 1;
+}
+
+static inline void cl_top_model_hist_add(uint32_t *bins, uint64_t v) {
+    uint32_t *bin = &bins[cl_top_model_hist_bin(v)];
+    if (*bin != UINT32_MAX) {
+        (*bin)++;
+    }
+}
+
+// Fold the job's masked lanes into the reduction results
+static inline void cl_top_model_reduce(struct cl_top_model *m) {
+    const uint32_t *src = (m->red_ctrl & RED_CTRL_RESULTS) ? m->output : m->input;
+    uint32_t mask = RED_CTRL_MASK_GET(m->red_ctrl);
+    uint32_t lanes[NUM_REGISTERS];
+    int n = 0;
+
+    if (!(m->red_ctrl & RED_CTRL_ACCUMULATE)) {
+        memset(&m->red, 0, sizeof(m->red));
+    }
+    if (mask == 0xFF) {
+        cl_top_reduce_add(&m->red, m->pred_ctrl, m->pred_value, src, NUM_REGISTERS);
+        return;
+    }
+    for (int i = 0; i < NUM_REGISTERS; i++) {
+        if (mask & (1u << i)) {
+            lanes[n++] = src[i];
+        }
+    }
+    cl_top_reduce_add(&m->red, m->pred_ctrl, m->pred_value, lanes, n);
+}
+
+// Pack the job's masked, matching lanes into the output bank. Runs after
+// the reduction, which sees the result beat before compaction.
+static inline void cl_top_model_compact(struct cl_top_model *m) {
+    const uint32_t *src = (m->cmp_ctrl & COMPACT_CTRL_RESULTS) ? m->output : m->input;
+    uint32_t mask = COMPACT_CTRL_MASK_GET(m->cmp_ctrl);
+    uint32_t lanes[NUM_REGISTERS];
+    int n = 0;
+
+    if (!(m->cmp_ctrl & COMPACT_CTRL_ENABLE)) {
+        m->cmp_count = NUM_REGISTERS;
+        return;
+    }
+    for (int i = 0; i < NUM_REGISTERS; i++) {
+        if (mask & (1u << i)) {
+            lanes[n++] = src[i];
+        }
+    }
+    m->cmp_count = (uint32_t)cl_top_compact_n(m->pred_ctrl, m->pred_value, lanes, lanes, n);
+    memset(m->output, 0, sizeof(m->output));
+    memcpy(m->output, lanes, m->cmp_count * sizeof(lanes[0]));
+}
+
+// Model the kernel of a build with another KERNEL parameter; call after init
+static inline void cl_top_model_set_kernel(struct cl_top_model *m, uint32_t kernel) {
+    m->kernel = kernel;
+}
+
+static inline uint32_t cl_top_model_kernel_caps(const struct cl_top_model *m) {
+    uint32_t flags = m->kernel == KERNEL_ALU ? KERNEL_CAPS_FLAG_ALU :
+                     m->kernel == KERNEL_SCAN ? KERNEL_CAPS_FLAG_SCAN : 0;
+    return (flags << 16) | MODEL_KERNEL_CAPS;
+}
+
+static inline void cl_top_model_complete(struct cl_top_model *m) {
+    switch (m->kernel) {
+    case KERNEL_ADD_ONE:
+        cl_top_alu_apply_n(ALU_OP_ADD, 1, m->input, m->output, NUM_REGISTERS);
+        break;
+    case KERNEL_SCAN:
+        cl_top_scan_apply_n(m->job_opcode, m->job_operand, &m->scan_carry, m->input, m->output,
+                            NUM_REGISTERS);
+        break;
+    default:
+        cl_top_alu_apply_n(m->job_opcode, m->job_operand, m->input, m->output, NUM_REGISTERS);
+        break;
+    }
+    cl_top_model_reduce(m);
+    cl_top_model_compact(m);
+    m->engine = MODEL_ENGINE_DONE;
+    m->job_done = m->done_cycle;
+    m->perf_jobs++;
+    m->mon_jobs_done++;
+    cl_top_model_hist_add(m->hist_svc, m->done_cycle - m->svc_zero);
+    m->react_pending = true;
+    m->react_from = m->done_cycle;
+}
+
+// Evaluate the engine for every cycle before 'until'. Register writes must
+// be applied after advancing through their W handshake cycle.
+static inline void cl_top_model_advance(struct cl_top_model *m, uint64_t until) {
+    while (m->engine_cycle < until) {
+        uint64_t c = m->engine_cycle;
+
+        switch (m->engine) {
+        case MODEL_ENGINE_IDLE:
+            if (!(m->control & START_BIT)) {
+                m->engine_cycle = until;
+                break;
+            }
+            m->engine = MODEL_ENGINE_BUSY;
+            m->job_start = c;
+            m->job_doorbell = m->last_wr;
+            m->svc_zero = c;
+            m->done_cycle = c + MODEL_ADD_ONE_CYCLES;
+            m->mon_jobs_started++;
+            m->engine_cycle = c + 1;
+            break;
+        case MODEL_ENGINE_BUSY: {
+            // Busy from the cycle after start through the done cycle
+            uint64_t end = until < m->done_cycle + 1 ? until : m->done_cycle + 1;
+            m->perf_busy += (uint32_t)(end - c);
+            m->engine_cycle = end;
+            if (end == m->done_cycle + 1) {
+                cl_top_model_complete(m);
+            }
+            break;
+        }
+        case MODEL_ENGINE_DONE:
+            if (m->control & START_BIT) {
+                m->engine_cycle = until;
+                break;
+            }
+            m->engine = MODEL_ENGINE_IDLE;
+            m->engine_cycle = c + 1;
+            break;
+        }
+    }
+}
+
+// Let the bus sit idle; the engine keeps running
+static inline void cl_top_model_idle(struct cl_top_model *m, uint64_t cycles) {
+    m->now += cycles;
+}
+
+static inline bool cl_top_model_read_only(uint32_t a) {
+    return (a >= OUTPUT_BASE_ADDR && a <= OUTPUT_BASE_ADDR + 0x1C) ||
+           (a >= STATUS_REG_ADDR && a <= KERNEL_CAPS_ADDR) ||
+           (a >= RED_SUM_LO_ADDR && a <= RED_WORDS_ADDR) ||
+           (a >= PERF_JOBS_ADDR && a <= COMPACT_COUNT_ADDR) ||
+           (a >= HWTS_CYCLE_LO_ADDR && a <= HWTS_DOORBELL_HI_ADDR) ||
+           (a >= HIST_SVC_BASE_ADDR && a <= HIST_REACT_BASE_ADDR + 0x3C) ||
+           (a >= OCL_TRACE_CTRL_ADDR && a <= OCL_TRACE_DATA3_ADDR);
+}
+
+static inline int cl_top_model_poke(struct cl_top_model *m, uint64_t offset, uint32_t value) {
+    struct cl_top_model_xact *x = &m->last;
+    uint32_t a = (uint32_t)offset & 0xFFF;
+    uint64_t w;
+    bool err_wr = false;
+    bool err_busy = false;
+
+    x->write = true;
+    x->unmodeled = false;
+    x->addr = a;
+    x->data = value;
+    x->addr_hs = cl_top_model_max(m->now, m->wr_ready);
+    x->data_hs = w = x->addr_hs + MODEL_WR_W_CYCLES;
+    x->resp_hs = x->addr_hs + MODEL_WR_B_CYCLES;
+    m->wr_ready = x->resp_hs + MODEL_READY_CYCLES;
+    m->now = x->resp_hs + 1 + m->host_gap;
+
+    // State before the W handshake, then the handshake cycle itself
+    cl_top_model_advance(m, w);
+    if (a == CONTROL_REG_ADDR) {
+        err_busy = (value & START_BIT) && m->engine != MODEL_ENGINE_IDLE;
+    }
+    cl_top_model_advance(m, w + 1);
+    m->last_wr = w;
+
+    if (a <= INPUT_BASE_ADDR + 0x1C) {
+        m->input[(a >> 2) & (NUM_REGISTERS - 1)] = value;
+    } else if (a == CONTROL_REG_ADDR) {
+        m->control = value;
+    } else if (a == JOB_OPCODE_ADDR) {
+        m->job_opcode = value & 0xF;
+    } else if (a == JOB_OPERAND_ADDR) {
+        m->job_operand = value;
+    } else if (a == PRED_CTRL_ADDR) {
+        m->pred_ctrl = value & 0xF;
+    } else if (a == PRED_VALUE_ADDR) {
+        m->pred_value = value;
+    } else if (a == RED_CTRL_ADDR) {
+        m->red_ctrl = value & (RED_CTRL_ACCUMULATE | RED_CTRL_RESULTS | RED_CTRL_MASK_ALL);
+        if (value & RED_CTRL_CLEAR) {
+            cl_top_model_advance(m, w + 2);
+            memset(&m->red, 0, sizeof(m->red));
+        }
+    } else if (a == COMPACT_CTRL_ADDR) {
+        m->cmp_ctrl = value & (COMPACT_CTRL_ENABLE | COMPACT_CTRL_RESULTS | COMPACT_CTRL_MASK_ALL);
+    } else if (a == PERF_JOBS_ADDR) {
+        // Cleared on the following cycle, dropping that cycle's events
+        cl_top_model_advance(m, w + 2);
+        m->perf_jobs = 0;
+        m->perf_busy = 0;
+        m->perf_writes = 0;
+        m->perf_reads = 0;
+    } else if (a == HIST_CTRL_ADDR) {
+        if (value & HIST_CLEAR_BIT) {
+            cl_top_model_advance(m, w + 2);
+            memset(m->hist_svc, 0, sizeof(m->hist_svc));
+            memset(m->hist_react, 0, sizeof(m->hist_react));
+            m->react_pending = false;
+            m->svc_zero = w + 1;
+        }
+    } else if (a == OCL_TRACE_CTRL_ADDR) {
+        m->trace_ctrl = value & ~OCL_TRACE_CTRL_CLEAR;
+    } else if (a == OCL_TRACE_EVMASK_ADDR) {
+        m->trace_evmask = value & OCL_TRACE_EV_ALL;
+    } else if (a == OCL_TRACE_AMATCH_ADDR) {
+        m->trace_amatch = value & 0xFFF;
+    } else if (a == OCL_TRACE_AMASK_ADDR) {
+        m->trace_amask = value & 0xFFF;
+    } else if (a == OCL_TRACE_TRIG_ADDR) {
+        m->trace_trig = value & 0xFFF;
+    } else if (a != OCL_TRACE_RD_PTR_ADDR && !cl_top_model_read_only(a)) {
+        err_wr = true;
+    }
+
+    m->mon_errors |= (err_wr ? SDA_ERR_WR_UNMAPPED : 0) | (err_busy ? SDA_ERR_START_BUSY : 0);
+    m->perf_writes++;
+    return 0;
+}
+
+static inline int cl_top_model_peek(struct cl_top_model *m, uint64_t offset, uint32_t *value) {
+    struct cl_top_model_xact *x = &m->last;
+    uint32_t a = (uint32_t)offset & 0xFFF;
+    uint64_t ar;
+    uint32_t v = 0;
+
+    x->write = false;
+    x->unmodeled = false;
+    x->addr = a;
+    x->addr_hs = ar = cl_top_model_max(m->now, m->rd_ready);
+    x->data_hs = 0;
+    x->resp_hs = ar + MODEL_RD_R_CYCLES;
+    m->rd_ready = x->resp_hs + MODEL_READY_CYCLES;
+    m->now = x->resp_hs + 1 + m->host_gap;
+
+    cl_top_model_advance(m, ar);
+    if (a == STATUS_REG_ADDR && m->react_pending &&
+        !(m->engine == MODEL_ENGINE_BUSY && m->done_cycle == ar)) {
+        // Done-to-read latency; a job finishing this very cycle wins
+        cl_top_model_hist_add(m->hist_react, ar - m->react_from - 1);
+        m->react_pending = false;
+    }
+    if (a == HWTS_CYCLE_LO_ADDR) {
+        m->cycle_snap = ar;
+    }
+    // Data is taken the cycle after the AR handshake
+    cl_top_model_advance(m, ar + 1);
+
+    if (a <= INPUT_BASE_ADDR + 0x1C) {
+        v = m->input[(a >> 2) & (NUM_REGISTERS - 1)];
+    } else if (a <= OUTPUT_BASE_ADDR + 0x1C) {
+        v = m->output[(a >> 2) & (NUM_REGISTERS - 1)];
+    } else if (a == CONTROL_REG_ADDR) {
+        v = m->control;
+    } else if (a == STATUS_REG_ADDR) {
+        v = m->engine == MODEL_ENGINE_DONE ? DONE_BIT : 0;
+    } else if (a == KERNEL_ID_ADDR) {
+        v = MODEL_KERNEL_VERSION | m->kernel;
+    } else if (a == KERNEL_CAPS_ADDR) {
+        v = cl_top_model_kernel_caps(m);
+    } else if (a == JOB_OPCODE_ADDR) {
+        v = m->job_opcode;
+    } else if (a == JOB_OPERAND_ADDR) {
+        v = m->job_operand;
+    } else if (a == PRED_CTRL_ADDR) {
+        v = m->pred_ctrl;
+    } else if (a == PRED_VALUE_ADDR) {
+        v = m->pred_value;
+    } else if (a == RED_CTRL_ADDR) {
+        v = m->red_ctrl;
+    } else if (a == RED_SUM_LO_ADDR) {
+        v = (uint32_t)m->red.sum;
+    } else if (a == RED_SUM_HI_ADDR) {
+        v = (uint32_t)(m->red.sum >> 32);
+    } else if (a == RED_MIN_ADDR) {
+        v = m->red.min;
+    } else if (a == RED_MAX_ADDR) {
+        v = m->red.max;
+    } else if (a == RED_COUNT_ADDR) {
+        v = m->red.count;
+    } else if (a == RED_WORDS_ADDR) {
+        v = m->red.words;
+    } else if (a == COMPACT_CTRL_ADDR) {
+        v = m->cmp_ctrl;
+    } else if (a == PERF_JOBS_ADDR) {
+        v = m->perf_jobs;
+    } else if (a == PERF_BUSY_CYCLES_ADDR) {
+        v = m->perf_busy;
+    } else if (a == PERF_OCL_WRITES_ADDR) {
+        v = m->perf_writes;
+    } else if (a == PERF_OCL_READS_ADDR) {
+        v = m->perf_reads;
+    } else if (a == COMPACT_COUNT_ADDR) {
+        v = m->cmp_count;
+    } else if (a == HWTS_CYCLE_LO_ADDR) {
+        v = (uint32_t)m->cycle_snap;
+    } else if (a == HWTS_CYCLE_HI_ADDR) {
+        v = (uint32_t)(m->cycle_snap >> 32);
+    } else if (a == HWTS_START_LO_ADDR) {
+        v = (uint32_t)m->job_start;
+    } else if (a == HWTS_START_HI_ADDR) {
+        v = (uint32_t)(m->job_start >> 32);
+    } else if (a == HWTS_DONE_LO_ADDR) {
+        v = (uint32_t)m->job_done;
+    } else if (a == HWTS_DONE_HI_ADDR) {
+        v = (uint32_t)(m->job_done >> 32);
+    } else if (a == HWTS_DOORBELL_LO_ADDR) {
+        v = (uint32_t)m->job_doorbell;
+    } else if (a == HWTS_DOORBELL_HI_ADDR) {
+        v = (uint32_t)(m->job_doorbell >> 32);
+    } else if (a >= HIST_SVC_BASE_ADDR && a <= HIST_SVC_BASE_ADDR + 0x3C) {
+        v = m->hist_svc[(a >> 2) & (HIST_BINS - 1)];
+    } else if (a >= HIST_REACT_BASE_ADDR && a <= HIST_REACT_BASE_ADDR + 0x3C) {
+        v = m->hist_react[(a >> 2) & (HIST_BINS - 1)];
+    } else if (a == OCL_TRACE_CTRL_ADDR) {
+        v = m->trace_ctrl;
+    } else if (a == OCL_TRACE_EVMASK_ADDR) {
+        v = m->trace_evmask;
+    } else if (a == OCL_TRACE_AMATCH_ADDR) {
+        v = m->trace_amatch;
+    } else if (a == OCL_TRACE_AMASK_ADDR) {
+        v = m->trace_amask;
+    } else if (a == OCL_TRACE_TRIG_ADDR) {
+        v = m->trace_trig;
+    } else if (a >= OCL_TRACE_STATUS_ADDR && a <= OCL_TRACE_DATA3_ADDR) {
+        x->unmodeled = true;
+    } else {
+        v = MODEL_UNMAPPED_DATA;
+        m->mon_errors |= SDA_ERR_RD_UNMAPPED;
+    }
+
+    m->perf_reads++;
+    x->data = v;
+    *value = v;
+    return 0;
+}
+
+// Out-of-band registers (SDA map), sampled at the current cycle
+static inline int cl_top_model_sda_peek(struct cl_top_model *m, uint64_t offset, uint32_t *value) {
+    uint32_t v;
+
+    cl_top_model_advance(m, m->now);
+    switch (offset) {
+    case SDA_STATUS_ADDR:
+        v = (m->engine == MODEL_ENGINE_BUSY ? SDA_STATUS_BUSY : 0) |
+            (m->engine == MODEL_ENGINE_DONE ? SDA_STATUS_DONE : 0) |
+            ((m->control & START_BIT) ? SDA_STATUS_START : 0) |
+            ((m->trace_ctrl & OCL_TRACE_CTRL_ENABLE) ? SDA_STATUS_TRACE : 0) |
+            (m->mon_errors << 8);
+        break;
+    case SDA_JOBS_STARTED_ADDR: v = m->mon_jobs_started; break;
+    case SDA_JOBS_DONE_ADDR:    v = m->mon_jobs_done; break;
+    case SDA_ERRORS_ADDR:       v = m->mon_errors; break;
+    case SDA_CYCLE_LO_ADDR:     v = (uint32_t)m->now; break;
+    case SDA_CYCLE_HI_ADDR:     v = (uint32_t)(m->now >> 32); break;
+    case SDA_BUSY_CYCLES_ADDR:  v = m->perf_busy; break;
+    case SDA_OCL_WRITES_ADDR:   v = m->perf_writes; break;
+    case SDA_OCL_READS_ADDR:    v = m->perf_reads; break;
+    default:                    v = MODEL_UNMAPPED_DATA; break;
+    }
+    *value = v;
+    return 0;
+}
+
+static inline int cl_top_model_sda_poke(struct cl_top_model *m, uint64_t offset, uint32_t value) {
+    if (offset == SDA_ERRORS_ADDR) {
+        m->mon_errors &= ~value;
+    }
+    return 0;
+}
+
+#endif // CL_TOP_MODEL_H
@@ -0,0 +1,155 @@
+/*
+ * Copyright 2015-2024 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Capacity planning with the cl_top transaction-level model.
+//
+//   cl_top_model_bench [-n jobs] [-g gap_cycles] [-r] [-o alu_op] [-k operand]
+//
+// Runs the host's job protocol (clear, 8 input writes, start, poll, clear,
+// 8 output reads) against cl_top_model.h and checks every result against
+// cl_top_alu.h. -o and -k pick the ALU operation, add-one by default.
+// Reports how fast the model runs on this host and the card-side cost of a
+// job: OCL cycles per job and the job rate one serial master reaches at
+// clk_main_a0. -g adds idle cycles between transactions to stand in for the
+// host's PCIe round trip; -r also reads the inputs back before start, as
+// cl_top_host does. Needs no card and no SDK.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "cl_top_alu.h"
+#include "cl_top_model.h"
+#include "cl_top_regs.h"
+
+static uint32_t alu_op = ALU_OP_ADD;
+static uint32_t alu_operand = 1;
+
+static int run_job(struct cl_top_model *m, uint32_t seed, bool readback, uint64_t *polls) {
+    uint32_t data[NUM_REGISTERS];
+    uint32_t v = 0;
+
+    cl_top_model_poke(m, CONTROL_REG_ADDR, 0);
+    for (int i = 0; i < NUM_REGISTERS; i++) {
+        data[i] = seed * 2654435761u + (uint32_t)i;
+        cl_top_model_poke(m, INPUT_BASE_ADDR + (i * 4), data[i]);
+    }
+    if (readback) {
+        for (int i = 0; i < NUM_REGISTERS; i++) {
+            cl_top_model_peek(m, INPUT_BASE_ADDR + (i * 4), &v);
+            if (v != data[i]) {
+                printf("ERROR: Input readback mismatch at reg %d: expected 0x%08x, got 0x%08x\n",
+                       i, data[i], v);
+                return 1;
+            }
+        }
+    }
+    cl_top_model_poke(m, CONTROL_REG_ADDR, START_BIT);
+    do {
+        cl_top_model_peek(m, STATUS_REG_ADDR, &v);
+        (*polls)++;
+    } while (!(v & DONE_BIT));
+    cl_top_model_poke(m, CONTROL_REG_ADDR, 0);
+    for (int i = 0; i < NUM_REGISTERS; i++) {
+        cl_top_model_peek(m, OUTPUT_BASE_ADDR + (i * 4), &v);
+        uint32_t want = cl_top_alu_apply(alu_op, alu_operand, data[i]);
+        if (v != want) {
+            printf("ERROR: Output %d is 0x%08x, expected 0x%08x\n", i, v, want);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    static struct cl_top_model model;
+    uint64_t jobs = 10000000;
+    uint32_t gap = 0;
+    bool readback = false;
+    uint64_t polls = 0;
+    struct timespec t0;
+    struct timespec t1;
+    double wall;
+    double cycles_per_job;
+    uint64_t xacts;
+    uint64_t start;
+    uint64_t cycles;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:g:ro:k:")) != -1) {
+        switch (opt) {
+        case 'n':
+            jobs = strtoull(optarg, NULL, 0);
+            break;
+        case 'g':
+            gap = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 'r':
+            readback = true;
+            break;
+        case 'o':
+            if (cl_top_alu_op_parse(optarg) < 0) {
+                printf("ERROR: Unknown ALU opcode '%s'\n", optarg);
+                return 1;
+            }
+            alu_op = (uint32_t)cl_top_alu_op_parse(optarg);
+            break;
+        case 'k':
+            alu_operand = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        default:
+            printf("Usage: %s [-n jobs] [-g gap_cycles] [-r] [-o alu_op] [-k operand]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (jobs == 0) {
+        printf("ERROR: Job count must be at least 1\n");
+        return 1;
+    }
+
+    cl_top_model_init(&model, gap);
+    cl_top_model_poke(&model, JOB_OPCODE_ADDR, alu_op);
+    cl_top_model_poke(&model, JOB_OPERAND_ADDR, alu_operand);
+    start = model.now;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (uint64_t j = 0; j < jobs; j++) {
+        if (run_job(&model, (uint32_t)j, readback, &polls) != 0) {
+            printf("ERROR: Job %llu failed\n", (unsigned long long)j);
+            return 1;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    wall = (double)(t1.tv_sec - t0.tv_sec) + (double)(t1.tv_nsec - t0.tv_nsec) * 1e-9;
+    cycles = model.now - start;
+    cycles_per_job = (double)cycles / (double)jobs;
+    // The card's counters are 32 bits wide; count from the protocol instead
+    xacts = jobs * (3 + NUM_REGISTERS * (readback ? 3 : 2)) + polls;
+
+    printf("=== cl_top model: %llu jobs, ALU %s 0x%x, host gap %u cycles%s ===\n",
+           (unsigned long long)jobs, cl_top_alu_op_name(alu_op), alu_operand, gap,
+           readback ? ", input readback" : "");
+    printf("Model speed:      %.2f M jobs/s (%.0f ns/job, %.2f M OCL transactions/s)\n",
+           (double)jobs / wall * 1e-6, wall * 1e9 / (double)jobs,
+           (double)xacts / wall * 1e-6);
+    printf("Card cycles/job:  %.1f (%.2f status polls/job, engine busy %.1f%%)\n", cycles_per_job,
+           (double)polls / (double)jobs, 100.0 * (double)(jobs * MODEL_ADD_ONE_CYCLES) / (double)cycles);
+    printf("Card job rate:    %.0f jobs/s at %d MHz, %.1f MB/s of input\n",
+           CLK_MAIN_A0_MHZ * 1e6 / cycles_per_job, CLK_MAIN_A0_MHZ,
+           CLK_MAIN_A0_MHZ * 1e6 / cycles_per_job * NUM_REGISTERS * 4 * 1e-6);
+    return 0;
+}
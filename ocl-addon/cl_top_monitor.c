@@ -0,0 +1,180 @@
+/*
+ * Copyright 2015-2024 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Out-of-band monitor for cl_top.
+//
+//   cl_top_monitor [-S slot] [-i interval_ms] [-n samples] [-x]
+//
+// Reads engine state, job counters and error flags from the SDA slave on
+// the management PF (BAR4), so it can watch a running cl_top_host without
+// adding a single access to the application BAR. Prints one line per
+// interval with job and OCL transaction rates and engine utilization from
+// the card's own cycle counter. -x clears the error flags first.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// AWS FPGA SDK includes
+#include <fpga_pci.h>
+#include <fpga_mgmt.h>
+
+#include "cl_top_regs.h"
+
+struct monitor_sample {
+    uint32_t status;
+    uint32_t started;
+    uint32_t done;
+    uint32_t errors;
+    uint64_t cycle;
+    uint32_t busy;
+    uint32_t writes;
+    uint32_t reads;
+};
+
+static int sample_read(pci_bar_handle_t bar, struct monitor_sample *m) {
+    uint32_t lo = 0;
+    uint32_t hi = 0;
+    int rc;
+
+    rc = fpga_pci_peek(bar, SDA_CYCLE_LO_ADDR, &lo);
+    rc = rc ? rc : fpga_pci_peek(bar, SDA_CYCLE_HI_ADDR, &hi);
+    rc = rc ? rc : fpga_pci_peek(bar, SDA_STATUS_ADDR, &m->status);
+    rc = rc ? rc : fpga_pci_peek(bar, SDA_JOBS_STARTED_ADDR, &m->started);
+    rc = rc ? rc : fpga_pci_peek(bar, SDA_JOBS_DONE_ADDR, &m->done);
+    rc = rc ? rc : fpga_pci_peek(bar, SDA_ERRORS_ADDR, &m->errors);
+    rc = rc ? rc : fpga_pci_peek(bar, SDA_BUSY_CYCLES_ADDR, &m->busy);
+    rc = rc ? rc : fpga_pci_peek(bar, SDA_OCL_WRITES_ADDR, &m->writes);
+    rc = rc ? rc : fpga_pci_peek(bar, SDA_OCL_READS_ADDR, &m->reads);
+    m->cycle = ((uint64_t)hi << 32) | lo;
+    return rc;
+}
+
+static const char *engine_state(uint32_t status) {
+    if (status & SDA_STATUS_BUSY) {
+        return "busy";
+    }
+    if (status & SDA_STATUS_DONE) {
+        return "done";
+    }
+    return "idle";
+}
+
+static void error_names(uint32_t errors, char *buf, size_t len) {
+    snprintf(buf, len, "%s%s%s%s",
+             errors == 0 ? "-" : "",
+             (errors & SDA_ERR_RD_UNMAPPED) ? "rd_unmapped " : "",
+             (errors & SDA_ERR_WR_UNMAPPED) ? "wr_unmapped " : "",
+             (errors & SDA_ERR_START_BUSY) ? "start_busy" : "");
+}
+
+int main(int argc, char **argv) {
+    pci_bar_handle_t bar = PCI_BAR_HANDLE_INIT;
+    struct monitor_sample prev;
+    struct monitor_sample cur;
+    int slot_id = 0;
+    int interval_ms = 1000;
+    int samples = 0;
+    bool clear_errors = false;
+    int opt;
+    int rc;
+
+    while ((opt = getopt(argc, argv, "S:i:n:x")) != -1) {
+        switch (opt) {
+        case 'S':
+            slot_id = atoi(optarg);
+            break;
+        case 'i':
+            interval_ms = atoi(optarg);
+            break;
+        case 'n':
+            samples = atoi(optarg);
+            break;
+        case 'x':
+            clear_errors = true;
+            break;
+        default:
+            printf("Usage: %s [-S slot] [-i interval_ms] [-n samples] [-x]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (interval_ms < 1) {
+        printf("ERROR: Interval must be at least 1 ms\n");
+        return 1;
+    }
+
+    rc = fpga_mgmt_init();
+    if (rc != 0) {
+        printf("ERROR: Unable to initialize the FPGA management library\n");
+        return 1;
+    }
+    rc = fpga_pci_attach(slot_id, FPGA_MGMT_PF, MGMT_PF_BAR4, 0, &bar);
+    if (rc != 0) {
+        printf("ERROR: Unable to attach to the management PF BAR4 on slot id %d\n", slot_id);
+        return rc;
+    }
+
+    if (clear_errors) {
+        rc = fpga_pci_poke(bar, SDA_ERRORS_ADDR, SDA_ERR_RD_UNMAPPED | SDA_ERR_WR_UNMAPPED |
+                                                 SDA_ERR_START_BUSY);
+        if (rc != 0) {
+            printf("ERROR: Failed to clear error flags\n");
+            goto cleanup;
+        }
+    }
+
+    rc = sample_read(bar, &prev);
+    if (rc != 0) {
+        printf("ERROR: Failed to read SDA monitor registers\n");
+        goto cleanup;
+    }
+
+    printf("%-5s %10s %10s %12s %12s %12s %7s  %s\n",
+           "state", "started", "done", "jobs/s", "ocl_wr/s", "ocl_rd/s", "busy%", "errors");
+    for (int n = 0; samples == 0 || n < samples; n++) {
+        char errs[64];
+        double secs;
+
+        usleep((useconds_t)interval_ms * 1000);
+        rc = sample_read(bar, &cur);
+        if (rc != 0) {
+            printf("ERROR: Failed to read SDA monitor registers\n");
+            goto cleanup;
+        }
+
+        // Rates use the card's clock, so host scheduling jitter does not skew them
+        secs = (double)(cur.cycle - prev.cycle) / (CLK_MAIN_A0_MHZ * 1e6);
+        if (secs <= 0.0) {
+            secs = interval_ms / 1000.0;
+        }
+        error_names(cur.errors, errs, sizeof(errs));
+        printf("%-5s %10u %10u %12.1f %12.1f %12.1f %6.2f%%  %s\n",
+               engine_state(cur.status), cur.started, cur.done,
+               (double)(uint32_t)(cur.done - prev.done) / secs,
+               (double)(uint32_t)(cur.writes - prev.writes) / secs,
+               (double)(uint32_t)(cur.reads - prev.reads) / secs,
+               100.0 * (double)(uint32_t)(cur.busy - prev.busy) / (double)(cur.cycle - prev.cycle),
+               errs);
+        fflush(stdout);
+        prev = cur;
+    }
+
+cleanup:
+    fpga_pci_detach(bar);
+    return rc;
+}
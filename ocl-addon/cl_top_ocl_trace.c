@@ -0,0 +1,279 @@
+/*
+ * Copyright 2015-2024 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Arm and drain the in-fabric OCL transaction trace buffer of cl_top.
+//
+//   cl_top_ocl_trace [-S slot] arm [-e evmask] [-a addr] [-M mask] [-T trig_addr] [-s]
+//   cl_top_ocl_trace [-S slot] stop
+//   cl_top_ocl_trace [-S slot] dump
+//
+// 'dump' prints every recorded handshake as a timeline in clk_main_a0
+// cycles, marks the idle gap before each new host transaction (cycles from
+// the previous B/R to the next AW/AR), and summarizes gaps and per
+// transaction latency.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// AWS FPGA SDK includes
+#include <fpga_pci.h>
+#include <fpga_mgmt.h>
+
+#include "cl_top_regs.h"
+
+struct ocl_trace_entry {
+    uint32_t ts;
+    uint32_t ev;
+    uint32_t waddr;
+    uint32_t raddr;
+    uint32_t wdata;
+    uint32_t rdata;
+};
+
+struct gap_stats {
+    uint64_t count;
+    uint64_t sum;
+    uint32_t min;
+    uint32_t max;
+};
+
+static void usage(const char *prog) {
+    printf("Usage: %s [-S slot] arm [-e evmask] [-a addr] [-M mask] [-T trig_addr] [-s]\n", prog);
+    printf("       %s [-S slot] stop\n", prog);
+    printf("       %s [-S slot] dump\n", prog);
+}
+
+static void gap_add(struct gap_stats *g, uint32_t v) {
+    if (g->count == 0 || v < g->min) g->min = v;
+    if (g->count == 0 || v > g->max) g->max = v;
+    g->count++;
+    g->sum += v;
+}
+
+static void gap_print(const char *name, const struct gap_stats *g) {
+    if (g->count == 0) {
+        printf("  %-24s none\n", name);
+        return;
+    }
+    printf("  %-24s n=%-6llu min=%-6u avg=%-8.1f max=%-6u cycles (avg %.0f ns)\n",
+           name, (unsigned long long)g->count, g->min, (double)g->sum / (double)g->count, g->max,
+           (double)g->sum / (double)g->count * 1000.0 / CLK_MAIN_A0_MHZ);
+}
+
+static int trace_arm(pci_bar_handle_t bar, uint32_t evmask, uint32_t amatch, uint32_t amask,
+                     int trig_addr, bool stop_full) {
+    uint32_t ctrl = OCL_TRACE_CTRL_ENABLE;
+    int rc;
+
+    // Stop and clear first so the filters apply to a fresh buffer
+    rc = fpga_pci_poke(bar, OCL_TRACE_CTRL_ADDR, OCL_TRACE_CTRL_CLEAR);
+    rc = rc ? rc : fpga_pci_poke(bar, OCL_TRACE_EVMASK_ADDR, evmask);
+    rc = rc ? rc : fpga_pci_poke(bar, OCL_TRACE_AMATCH_ADDR, amatch);
+    rc = rc ? rc : fpga_pci_poke(bar, OCL_TRACE_AMASK_ADDR, amask);
+    if (trig_addr >= 0) {
+        rc = rc ? rc : fpga_pci_poke(bar, OCL_TRACE_TRIG_ADDR, (uint32_t)trig_addr);
+        ctrl |= OCL_TRACE_CTRL_TRIGGER;
+    }
+    if (stop_full) {
+        ctrl |= OCL_TRACE_CTRL_STOP_FULL;
+    }
+    rc = rc ? rc : fpga_pci_poke(bar, OCL_TRACE_CTRL_ADDR, ctrl);
+    if (rc != 0) {
+        printf("ERROR: Failed to arm OCL trace\n");
+        return rc;
+    }
+    printf("OCL trace armed: ctrl=0x%x evmask=0x%02x match=0x%03x mask=0x%03x\n",
+           ctrl, evmask, amatch, amask);
+    return 0;
+}
+
+static int trace_dump(pci_bar_handle_t bar) {
+    static const char *const chan[5] = { "AW", "W", "B", "AR", "R" };
+    struct ocl_trace_entry *e;
+    struct gap_stats gaps = {0};
+    struct gap_stats wr_lat = {0};
+    struct gap_stats rd_lat = {0};
+    uint32_t status = 0;
+    uint32_t count;
+    uint32_t start;
+    uint32_t last_end = 0;
+    uint32_t aw_ts = 0;
+    uint32_t ar_ts = 0;
+    bool have_end = false;
+    int rc;
+
+    rc = fpga_pci_peek(bar, OCL_TRACE_STATUS_ADDR, &status);
+    if (rc != 0) {
+        printf("ERROR: Failed to read OCL trace status\n");
+        return rc;
+    }
+    count = OCL_TRACE_STATUS_COUNT(status);
+    start = (status & OCL_TRACE_STATUS_WRAPPED) ? OCL_TRACE_STATUS_WRPTR(status) : 0;
+    printf("OCL trace: %u entries%s%s\n", count,
+           (status & OCL_TRACE_STATUS_WRAPPED) ? ", wrapped" : "",
+           (status & OCL_TRACE_STATUS_TRIGGERED) ? ", triggered" : "");
+    if (count == 0) {
+        return 0;
+    }
+
+    e = calloc(count, sizeof(*e));
+    if (e == NULL) {
+        printf("ERROR: Out of memory\n");
+        return 1;
+    }
+
+    // Drain: set the read pointer once, then DATA3 reads auto-advance it
+    rc = fpga_pci_poke(bar, OCL_TRACE_RD_PTR_ADDR, start);
+    for (uint32_t i = 0; i < count && rc == 0; i++) {
+        uint32_t d1 = 0;
+        rc = fpga_pci_peek(bar, OCL_TRACE_DATA0_ADDR, &e[i].ts);
+        rc = rc ? rc : fpga_pci_peek(bar, OCL_TRACE_DATA1_ADDR, &d1);
+        rc = rc ? rc : fpga_pci_peek(bar, OCL_TRACE_DATA2_ADDR, &e[i].wdata);
+        rc = rc ? rc : fpga_pci_peek(bar, OCL_TRACE_DATA3_ADDR, &e[i].rdata);
+        e[i].ev = (d1 >> 24) & OCL_TRACE_EV_ALL;
+        e[i].waddr = (d1 >> 12) & 0xFFF;
+        e[i].raddr = d1 & 0xFFF;
+    }
+    if (rc != 0) {
+        printf("ERROR: Failed to drain OCL trace\n");
+        free(e);
+        return rc;
+    }
+
+    printf("\n%10s %8s  %-4s %-6s %-10s %s\n", "cycle", "+delta", "chan", "addr", "data", "note");
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t rel = e[i].ts - e[0].ts;
+        uint32_t delta = i ? e[i].ts - e[i - 1].ts : 0;
+
+        for (int c = 0; c < 5; c++) {
+            bool is_write = c < 3;
+            uint32_t addr = is_write ? e[i].waddr : e[i].raddr;
+            char note[48] = "";
+
+            if (!(e[i].ev & (1u << c))) {
+                continue;
+            }
+            if ((c == 0 || c == 3) && have_end) {
+                uint32_t gap = e[i].ts - last_end;
+                gap_add(&gaps, gap);
+                snprintf(note, sizeof(note), "gap %u", gap);
+            }
+            if (c == 0) aw_ts = e[i].ts;
+            if (c == 3) ar_ts = e[i].ts;
+            if (c == 2) {
+                gap_add(&wr_lat, e[i].ts - aw_ts);
+                snprintf(note, sizeof(note), "write %u cycles", e[i].ts - aw_ts);
+            }
+            if (c == 4) {
+                gap_add(&rd_lat, e[i].ts - ar_ts);
+                snprintf(note, sizeof(note), "read %u cycles", e[i].ts - ar_ts);
+            }
+            if (c == 2 || c == 4) {
+                last_end = e[i].ts;
+                have_end = true;
+            }
+
+            if (c == 1) {
+                printf("%10u %8u  %-4s 0x%03x  0x%08x %s\n", rel, delta, chan[c], addr, e[i].wdata, note);
+            } else if (c == 4) {
+                printf("%10u %8u  %-4s 0x%03x  0x%08x %s\n", rel, delta, chan[c], addr, e[i].rdata, note);
+            } else {
+                printf("%10u %8u  %-4s 0x%03x  %-10s %s\n", rel, delta, chan[c], addr, "", note);
+            }
+            delta = 0;
+        }
+    }
+
+    printf("\nSUMMARY (clk_main_a0 %d MHz):\n", CLK_MAIN_A0_MHZ);
+    gap_print("Gap between transactions", &gaps);
+    gap_print("Write AW->B", &wr_lat);
+    gap_print("Read AR->R", &rd_lat);
+
+    free(e);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    pci_bar_handle_t bar = PCI_BAR_HANDLE_INIT;
+    int slot_id = 0;
+    uint32_t evmask = OCL_TRACE_EV_ALL;
+    uint32_t amatch = 0;
+    uint32_t amask = 0;
+    int trig_addr = -1;
+    bool stop_full = false;
+    const char *cmd;
+    int opt;
+    int rc;
+
+    while ((opt = getopt(argc, argv, "S:e:a:M:T:s")) != -1) {
+        switch (opt) {
+        case 'S':
+            slot_id = atoi(optarg);
+            break;
+        case 'e':
+            evmask = (uint32_t)strtoul(optarg, NULL, 0) & OCL_TRACE_EV_ALL;
+            break;
+        case 'a':
+            amatch = (uint32_t)strtoul(optarg, NULL, 0) & 0xFFF;
+            break;
+        case 'M':
+            amask = (uint32_t)strtoul(optarg, NULL, 0) & 0xFFF;
+            break;
+        case 'T':
+            trig_addr = (int)(strtoul(optarg, NULL, 0) & 0xFFF);
+            break;
+        case 's':
+            stop_full = true;
+            break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (optind >= argc) {
+        usage(argv[0]);
+        return 1;
+    }
+    cmd = argv[optind];
+
+    rc = fpga_mgmt_init();
+    if (rc != 0) {
+        printf("ERROR: Unable to initialize the FPGA management library\n");
+        return 1;
+    }
+    rc = fpga_pci_attach(slot_id, FPGA_APP_PF, APP_PF_BAR0, 0, &bar);
+    if (rc != 0) {
+        printf("ERROR: Unable to attach to the AFI on slot id %d\n", slot_id);
+        return rc;
+    }
+
+    if (strcmp(cmd, "arm") == 0) {
+        rc = trace_arm(bar, evmask, amatch, amask, trig_addr, stop_full);
+    } else if (strcmp(cmd, "stop") == 0) {
+        rc = fpga_pci_poke(bar, OCL_TRACE_CTRL_ADDR, 0);
+    } else if (strcmp(cmd, "dump") == 0) {
+        rc = trace_dump(bar);
+    } else {
+        usage(argv[0]);
+        rc = 1;
+    }
+
+    fpga_pci_detach(bar);
+    return rc;
+}
@@ -0,0 +1,225 @@
+/*
+ * Copyright 2015-2024 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// perf_event counters around each stage of the Add-One protocol.
+//
+// Cycles, instructions, cache misses and context switches are opened as one
+// counter group on the calling thread, so a stage boundary costs a single
+// read() of the group. Deltas are attributed to the stage that just closed,
+// which tells MMIO stall cycles apart from cache misses and from the
+// context switches caused by usleep() in the poll loop. Events the
+// PMU/kernel refuses (common on VMs) are reported as n/a.
+
+#ifndef CL_TOP_PERF_EVENT_H
+#define CL_TOP_PERF_EVENT_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#include "cl_top_stats.h"
+
+enum cl_top_perf_ev {
+    PERF_EV_CYCLES = 0,
+    PERF_EV_INSTRUCTIONS,
+    PERF_EV_CACHE_MISSES,
+    PERF_EV_CTX_SWITCHES,
+    PERF_EV_COUNT
+};
+
+struct cl_top_perf {
+    bool enabled;
+    int leader;                         // group leader fd
+    int nr;                             // events in the group
+    int fd[PERF_EV_COUNT];              // -1 if the event could not be opened
+    int pos[PERF_EV_COUNT];             // position in the group read, -1 if absent
+    uint64_t last[PERF_EV_COUNT];
+    uint64_t job_base[PERF_EV_COUNT];
+    uint64_t sum[STAGE_COUNT][PERF_EV_COUNT];
+    uint64_t samples[STAGE_COUNT];
+};
+
+static inline int cl_top_perf_open_event(uint32_t type, uint64_t config, int group_fd) {
+    struct perf_event_attr attr;
+    int fd;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = group_fd == -1;     // leader starts disabled, enabled once complete
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP;
+
+    fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0);
+    if (fd < 0 && errno == EACCES) {
+        // perf_event_paranoid forbids kernel counting; count user space only
+        attr.exclude_kernel = 1;
+        fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0);
+    }
+    return fd;
+}
+
+// Open the counter group on the calling thread. Returns 0 if at least one
+// event is available.
+static inline int cl_top_perf_open(struct cl_top_perf *p) {
+    static const struct {
+        uint32_t type;
+        uint64_t config;
+    } events[PERF_EV_COUNT] = {
+        [PERF_EV_CYCLES]       = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+        [PERF_EV_INSTRUCTIONS] = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+        [PERF_EV_CACHE_MISSES] = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+        [PERF_EV_CTX_SWITCHES] = { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES },
+    };
+
+    memset(p, 0, sizeof(*p));
+    p->leader = -1;
+    for (int e = 0; e < PERF_EV_COUNT; e++) {
+        p->fd[e] = cl_top_perf_open_event(events[e].type, events[e].config, p->leader);
+        p->pos[e] = -1;
+        if (p->fd[e] < 0) {
+            continue;
+        }
+        if (p->leader < 0) {
+            p->leader = p->fd[e];
+        }
+        p->pos[e] = p->nr++;
+    }
+    if (p->leader < 0) {
+        return -1;
+    }
+
+    ioctl(p->leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(p->leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    p->enabled = true;
+    return 0;
+}
+
+static inline void cl_top_perf_close(struct cl_top_perf *p) {
+    for (int e = 0; e < PERF_EV_COUNT; e++) {
+        if (p->fd[e] >= 0) {
+            close(p->fd[e]);
+            p->fd[e] = -1;
+        }
+    }
+    p->enabled = false;
+}
+
+static inline void cl_top_perf_read(struct cl_top_perf *p, uint64_t now[PERF_EV_COUNT]) {
+    uint64_t buf[1 + PERF_EV_COUNT];
+
+    if (read(p->leader, buf, sizeof(buf)) < (ssize_t)sizeof(uint64_t)) {
+        memcpy(now, p->last, sizeof(p->last));
+        return;
+    }
+    for (int e = 0; e < PERF_EV_COUNT; e++) {
+        now[e] = p->pos[e] >= 0 && (uint64_t)p->pos[e] < buf[0] ? buf[1 + p->pos[e]] : 0;
+    }
+}
+
+static inline void cl_top_perf_job_begin(struct cl_top_perf *p) {
+    if (__builtin_expect(!p->enabled, 1)) {
+        return;
+    }
+    cl_top_perf_read(p, p->last);
+    memcpy(p->job_base, p->last, sizeof(p->last));
+}
+
+// Attribute everything counted since the previous boundary to 'stage'
+static inline void cl_top_perf_stage(struct cl_top_perf *p, enum cl_top_stage stage) {
+    uint64_t now[PERF_EV_COUNT];
+
+    if (__builtin_expect(!p->enabled, 1)) {
+        return;
+    }
+    cl_top_perf_read(p, now);
+    for (int e = 0; e < PERF_EV_COUNT; e++) {
+        p->sum[stage][e] += now[e] - p->last[e];
+        p->last[e] = now[e];
+    }
+    p->samples[stage]++;
+}
+
+static inline void cl_top_perf_job_end(struct cl_top_perf *p) {
+    if (__builtin_expect(!p->enabled, 1)) {
+        return;
+    }
+    for (int e = 0; e < PERF_EV_COUNT; e++) {
+        p->sum[STAGE_JOB_TOTAL][e] += p->last[e] - p->job_base[e];
+    }
+    p->samples[STAGE_JOB_TOTAL]++;
+}
+
+// Per-job averages for every stage, plus per-word figures for whole jobs
+static inline void cl_top_perf_report(const struct cl_top_perf *p, FILE *out, unsigned words_per_job) {
+    static const char *const names[PERF_EV_COUNT] = {
+        "cycles", "instr", "cache-miss", "ctx-sw",
+    };
+
+    if (!p->enabled) {
+        return;
+    }
+    fprintf(out, "\n=== perf_event counters per job ===\n");
+    fprintf(out, "%-14s", "stage");
+    for (int e = 0; e < PERF_EV_COUNT; e++) {
+        fprintf(out, " %12s", names[e]);
+    }
+    fprintf(out, " %8s\n", "IPC");
+
+    for (int s = 0; s < STAGE_COUNT; s++) {
+        uint64_t n = p->samples[s];
+        if (n == 0) {
+            continue;
+        }
+        fprintf(out, "%-14s", cl_top_stage_names[s]);
+        for (int e = 0; e < PERF_EV_COUNT; e++) {
+            if (p->pos[e] < 0) {
+                fprintf(out, " %12s", "n/a");
+            } else {
+                fprintf(out, " %12.1f", (double)p->sum[s][e] / (double)n);
+            }
+        }
+        if (p->pos[PERF_EV_CYCLES] >= 0 && p->pos[PERF_EV_INSTRUCTIONS] >= 0 &&
+            p->sum[s][PERF_EV_CYCLES] != 0) {
+            fprintf(out, " %8.2f\n",
+                    (double)p->sum[s][PERF_EV_INSTRUCTIONS] / (double)p->sum[s][PERF_EV_CYCLES]);
+        } else {
+            fprintf(out, " %8s\n", "n/a");
+        }
+    }
+
+    if (p->samples[STAGE_JOB_TOTAL] != 0 && words_per_job != 0) {
+        double words = (double)p->samples[STAGE_JOB_TOTAL] * words_per_job;
+        fprintf(out, "%-14s", "per word");
+        for (int e = 0; e < PERF_EV_COUNT; e++) {
+            if (p->pos[e] < 0) {
+                fprintf(out, " %12s", "n/a");
+            } else {
+                fprintf(out, " %12.2f", (double)p->sum[STAGE_JOB_TOTAL][e] / words);
+            }
+        }
+        fprintf(out, "\n");
+    }
+    fflush(out);
+}
+
+#endif // CL_TOP_PERF_EVENT_H
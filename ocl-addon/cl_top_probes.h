@@ -0,0 +1,64 @@
+/*
+ * Copyright 2015-2024 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// USDT static tracepoints for the Add-One host protocol (provider "cl_top").
+//
+// Each probe site compiles to a single nop plus an ELF note, so they cost
+// nothing until bpftrace/perf attaches. Latency arguments are TSC ticks
+// (see cl_top_tsc()); the calibration is printed with the stage table.
+//
+//   job_submit(job, slot)
+//   job_poll(job, slot, poll_count, status)
+//   job_complete(job, slot, latency_ticks, poll_count)
+//   job_timeout(job, slot, poll_count)
+//   job_readback(job, slot, words, latency_ticks)
+//
+// Without <sys/sdt.h> (systemtap-sdt-devel) the probes compile away.
+
+#ifndef CL_TOP_PROBES_H
+#define CL_TOP_PROBES_H
+
+#if defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define CL_TOP_HAVE_USDT 1
+#endif
+#endif
+
+#ifdef CL_TOP_HAVE_USDT
+#define CL_TOP_PROBE_SUBMIT(job, slot) \
+    DTRACE_PROBE2(cl_top, job_submit, job, slot)
+#define CL_TOP_PROBE_POLL(job, slot, polls, status) \
+    DTRACE_PROBE4(cl_top, job_poll, job, slot, polls, status)
+#define CL_TOP_PROBE_COMPLETE(job, slot, ticks, polls) \
+    DTRACE_PROBE4(cl_top, job_complete, job, slot, ticks, polls)
+#define CL_TOP_PROBE_TIMEOUT(job, slot, polls) \
+    DTRACE_PROBE3(cl_top, job_timeout, job, slot, polls)
+#define CL_TOP_PROBE_READBACK(job, slot, words, ticks) \
+    DTRACE_PROBE4(cl_top, job_readback, job, slot, words, ticks)
+#else
+#define CL_TOP_PROBE_SUBMIT(job, slot) \
+    do { (void)(job); (void)(slot); } while (0)
+#define CL_TOP_PROBE_POLL(job, slot, polls, status) \
+    do { (void)(job); (void)(slot); (void)(polls); (void)(status); } while (0)
+#define CL_TOP_PROBE_COMPLETE(job, slot, ticks, polls) \
+    do { (void)(job); (void)(slot); (void)(ticks); (void)(polls); } while (0)
+#define CL_TOP_PROBE_TIMEOUT(job, slot, polls) \
+    do { (void)(job); (void)(slot); (void)(polls); } while (0)
+#define CL_TOP_PROBE_READBACK(job, slot, words, ticks) \
+    do { (void)(job); (void)(slot); (void)(words); (void)(ticks); } while (0)
+#endif
+
+#endif // CL_TOP_PROBES_H
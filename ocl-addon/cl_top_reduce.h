@@ -0,0 +1,143 @@
+/*
+ * Copyright 2015-2024 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Reference semantics of cl_top's word predicate, reduction engine and
+// stream compaction.
+//
+// cl_top_reduce_add() folds words into a result exactly as the RTL folds a
+// job's lanes into RED_SUM/MIN/MAX/COUNT/WORDS, and cl_top_compact_n() packs
+// the matching words the way a compacting job fills the output bank, so the
+// model uses them to produce the registers and the host uses them as the CPU
+// baseline. Plain C with no SDK dependency, like cl_top_alu.h.
+
+#ifndef CL_TOP_REDUCE_H
+#define CL_TOP_REDUCE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "cl_top_regs.h"
+
+struct cl_top_reduce {
+    uint64_t sum;           // sign-extended words when PRED_CTRL_SIGNED
+    uint32_t min;
+    uint32_t max;
+    uint32_t count;         // words matching the predicate
+    uint32_t words;
+};
+
+static const char *const cl_top_pred_op_names[PRED_NUM_OPS] = {
+    "always", "eq", "ne", "lt", "le", "gt", "ge", "never",
+};
+
+static inline bool cl_top_pred_less(uint32_t ctrl, uint32_t a, uint32_t b) {
+    return (ctrl & PRED_CTRL_SIGNED) ? (int32_t)a < (int32_t)b : a < b;
+}
+
+static inline bool cl_top_pred_match(uint32_t ctrl, uint32_t value, uint32_t x) {
+    switch (ctrl & 0x7) {
+    case PRED_OP_ALWAYS:    return true;
+    case PRED_OP_EQ:        return x == value;
+    case PRED_OP_NE:        return x != value;
+    case PRED_OP_LT:        return cl_top_pred_less(ctrl, x, value);
+    case PRED_OP_LE:        return !cl_top_pred_less(ctrl, value, x);
+    case PRED_OP_GT:        return cl_top_pred_less(ctrl, value, x);
+    case PRED_OP_GE:        return !cl_top_pred_less(ctrl, x, value);
+    default:                return false;
+    }
+}
+
+// Fold n words into r. Signed words are biased by 2^31 so both orders
+// compare unsigned, and the predicate switch is hoisted out of the count
+// loop, so every loop here compiles to vector code.
+static inline void cl_top_reduce_add(struct cl_top_reduce *r, uint32_t pred_ctrl,
+                                     uint32_t pred_value, const uint32_t *x, size_t n) {
+    uint32_t bias = (pred_ctrl & PRED_CTRL_SIGNED) ? 0x80000000u : 0;
+    uint32_t k = pred_value ^ bias;
+    uint32_t lo = r->words ? r->min ^ bias : UINT32_MAX;
+    uint32_t hi = r->words ? r->max ^ bias : 0;
+    uint64_t sum = 0;
+    uint32_t count = 0;
+
+    if (n == 0) {
+        return;
+    }
+    for (size_t i = 0; i < n; i++) {
+        uint32_t v = x[i] ^ bias;
+        sum += v;
+        lo = v < lo ? v : lo;
+        hi = v > hi ? v : hi;
+    }
+
+#define CL_TOP_PRED_COUNT(expr)                 \
+    for (size_t i = 0; i < n; i++) {            \
+        uint32_t v = x[i] ^ bias;               \
+        count += (expr);                        \
+    }                                           \
+    break
+
+    switch (pred_ctrl & 0x7) {
+    case PRED_OP_ALWAYS:    count = (uint32_t)n; break;
+    case PRED_OP_EQ:        CL_TOP_PRED_COUNT(v == k);
+    case PRED_OP_NE:        CL_TOP_PRED_COUNT(v != k);
+    case PRED_OP_LT:        CL_TOP_PRED_COUNT(v < k);
+    case PRED_OP_LE:        CL_TOP_PRED_COUNT(v <= k);
+    case PRED_OP_GT:        CL_TOP_PRED_COUNT(v > k);
+    case PRED_OP_GE:        CL_TOP_PRED_COUNT(v >= k);
+    default:                break;
+    }
+#undef CL_TOP_PRED_COUNT
+
+    // Each biased word is the signed word plus 2^31
+    r->sum += sum - (uint64_t)n * bias;
+    r->min = lo ^ bias;
+    r->max = hi ^ bias;
+    r->count += count;
+    r->words += (uint32_t)n;
+}
+
+// Copy the words of x[0..n-1] matching the predicate to out, in order;
+// returns how many. out has room for n words and may be x. The store is
+// unconditional and the index advances by the match, so the loop has no
+// data-dependent branch.
+static inline size_t cl_top_compact_n(uint32_t pred_ctrl, uint32_t pred_value, const uint32_t *x,
+                                      uint32_t *out, size_t n) {
+    size_t m = 0;
+
+    for (size_t i = 0; i < n; i++) {
+        uint32_t v = x[i];
+        out[m] = v;
+        m += cl_top_pred_match(pred_ctrl, pred_value, v);
+    }
+    return m;
+}
+
+static inline const char *cl_top_pred_op_name(uint32_t op) {
+    return cl_top_pred_op_names[op & 0x7];
+}
+
+// Predicate opcode for a name from cl_top_pred_op_names, or -1
+static inline int cl_top_pred_op_parse(const char *name) {
+    for (int i = 0; i < PRED_NUM_OPS; i++) {
+        if (strcmp(name, cl_top_pred_op_names[i]) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+#endif // CL_TOP_REDUCE_H
@@ -0,0 +1,146 @@
+/*
+ * Copyright 2015-2024 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// On-card reduction against readback and a CPU reduce.
+//
+//   cl_top_reduce_bench [-n words] [-p pred] [-V value] [-s] [-S slot] [-E]
+//
+// Pushes the same array through the kernel twice and reduces what the
+// kernel makes of it (sum, min, max, count of words matching the predicate
+// -p/-V, signed with -s):
+//
+//   readback  every batch's 8 output registers are read back and reduced
+//             on the CPU with cl_top_reduce.h
+//   on-card   the reduction engine accumulates across batches and its six
+//             result registers are read once (cl_top_reduce_array)
+//
+// Both results must agree. Reports OCL transactions per word and time per
+// word for each, and the CPU reduce alone for scale. With -E the card is
+// the transaction-level model and time is reported in clk_main_a0 cycles
+// instead of wall time, which would only measure the model.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "cl_top_bench.h"
+#include "cl_top_jobs.h"
+#include "cl_top_mmio.h"
+#include "cl_top_reduce.h"
+#include "cl_top_regs.h"
+
+static int reduce_readback(pci_bar_handle_t bar, uint32_t pred_ctrl, uint32_t pred_value,
+                           const uint32_t *x, size_t n, struct cl_top_reduce *r) {
+    uint32_t out[NUM_REGISTERS];
+    int rc = 0;
+
+    for (size_t i = 0; i < n && rc == 0; i += NUM_REGISTERS) {
+        int m = n - i < NUM_REGISTERS ? (int)(n - i) : NUM_REGISTERS;
+        rc = cl_top_job_run(bar, &x[i], m);
+        for (int j = 0; j < m && rc == 0; j++) {
+            rc = cl_top_mmio_peek(bar, OUTPUT_BASE_ADDR + (j * 4), &out[j]);
+        }
+        cl_top_mmio_job_end(m);
+        cl_top_reduce_add(r, pred_ctrl, pred_value, out, m);
+    }
+    return rc;
+}
+
+static void reduce_print(const char *name, const struct cl_top_reduce *r) {
+    printf("  %-10s sum 0x%016llx min 0x%08x max 0x%08x count %u words %u\n", name,
+           (unsigned long long)r->sum, r->min, r->max, r->count, r->words);
+}
+
+int main(int argc, char **argv) {
+    static struct bench_card card;
+    struct bench_opts opts = {
+        .n = 1 << 16,
+        .pred_ctrl = PRED_OP_GT,
+        .pred_value = 0x80000000u,
+    };
+    struct cl_top_reduce on_card = {0};
+    struct cl_top_reduce host = {0};
+    struct cl_top_reduce cpu = {0};
+    struct bench_run runs[2] = {{0}};
+    size_t n;
+    uint32_t *x;
+    double t;
+    int opt;
+    int rc;
+
+    while ((opt = getopt(argc, argv, "n:p:V:sS:E")) != -1) {
+        rc = bench_opt(&opts, opt, optarg);
+        if (rc == 0) {
+            printf("Usage: %s [-n words] [-p pred] [-V value] [-s] [-S slot] [-E]\n", argv[0]);
+        }
+        if (rc <= 0) {
+            return 1;
+        }
+    }
+    n = opts.n;
+    if (n == 0 || n > UINT32_MAX) {
+        printf("ERROR: Word count must be between 1 and %u\n", UINT32_MAX);
+        return 1;
+    }
+
+    x = bench_input(n);
+    if (x == NULL) {
+        return 1;
+    }
+    rc = bench_card_open(&card, &opts);
+    if (rc != 0) {
+        free(x);
+        return rc;
+    }
+
+    // The kernel's results are reduced, so both paths see the same words
+    rc = cl_top_reduce_setup(card.bar, opts.pred_ctrl, opts.pred_value, RED_CTRL_MASK_ALL);
+    for (int k = 0; k < 2 && rc == 0; k++) {
+        bench_run_begin(&card, &runs[k]);
+        if (k == 0) {
+            rc = reduce_readback(card.bar, opts.pred_ctrl, opts.pred_value, x, n, &host);
+        } else {
+            rc = cl_top_reduce_array(card.bar, opts.pred_ctrl, opts.pred_value, RED_CTRL_RESULTS,
+                                     x, n, &on_card);
+        }
+        bench_run_end(&card, &runs[k]);
+    }
+    t = bench_now_ns();
+    cl_top_reduce_add(&cpu, opts.pred_ctrl, opts.pred_value, x, n);
+    t = bench_now_ns() - t;
+
+    if (rc == 0) {
+        printf("=== cl_top reduction: %zu words, predicate %s%s 0x%x ===\n", n,
+               (opts.pred_ctrl & PRED_CTRL_SIGNED) ? "signed " : "",
+               cl_top_pred_op_name(opts.pred_ctrl), opts.pred_value);
+        bench_print("readback", &runs[0], n, opts.emulate);
+        bench_print("on-card", &runs[1], n, opts.emulate);
+        printf("  %-10s %8.2f ns/word reducing the inputs already in host memory (count %u)\n",
+               "CPU only", t / (double)n, cpu.count);
+        reduce_print("readback", &host);
+        reduce_print("on-card", &on_card);
+        if (host.sum != on_card.sum || host.min != on_card.min || host.max != on_card.max ||
+            host.count != on_card.count || host.words != on_card.words) {
+            printf("ERROR: On-card reduction does not match the readback\n");
+            rc = 1;
+        }
+    }
+
+    bench_card_close(&card);
+    free(x);
+    return rc ? 1 : 0;
+}
@@ -0,0 +1,174 @@
+#!/usr/bin/env python3
+#
+# Copyright 2024 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+#
+# Licensed under the Amazon Software License (the "License"). You may not use
+# this file except in compliance with the License. A copy of the License is
+# located at
+#
+#    http://aws.amazon.com/asl/
+#
+# or in the "license" file accompanying this file. This file is distributed on
+# an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, express or
+# implied. See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Parallel regression runner for cl_top_base_test.
+
+The testbench is compiled once; every run reuses the same snapshot and picks
+its scenario with +TEST=<name> and its random seed with +SEED=<n>. Runs go to
+their own directory under --out so per-run files (perf JSON, hex dumps) do not
+collide. Pass/fail comes from the testbench's TEST PASSED/FAILED line; PERF
+lines and the perf_budget JSON summary are collected into one summary file.
+
+Example (VCS snapshot built by the HDK flow):
+
+    ./cl_top_regress.py --sim "/path/to/simv" -t add_one -t ocl_stress -s 8 -j 16
+
+With --restore, shell power-up is simulated once: the runner first runs the
+snapshot with +CHECKPOINT_SAVE=<file>, then starts every test from that
+checkpoint with the restore command, where {ckpt} names the file:
+
+    ./cl_top_regress.py --sim "/path/to/simv" --restore "/path/to/simv -r {ckpt}" -s 64
+"""
+
+import argparse
+import json
+import os
+import re
+import shlex
+import subprocess
+import sys
+import time
+from concurrent.futures import ThreadPoolExecutor, as_completed
+
+TESTS = ["add_one", "alu", "reduce", "scan", "compact", "perf_budget", "ocl_stress", "bulk_dataset", "backdoor", "log_throughput"]
+
+
+def abs_sim(sim):
+    # Runs execute in their own directory; anchor a relative simulator path
+    argv = shlex.split(sim)
+    if os.path.exists(argv[0]):
+        argv[0] = os.path.abspath(argv[0])
+    return " ".join(shlex.quote(a) for a in argv)
+
+
+def call_logged(cmd, run_dir, timeout):
+    log_path = os.path.join(run_dir, "sim.log")
+    start = time.monotonic()
+    with open(log_path, "w") as log:
+        try:
+            rc = subprocess.call(cmd, cwd=run_dir, stdout=log, stderr=subprocess.STDOUT,
+                                 timeout=timeout)
+        except subprocess.TimeoutExpired:
+            rc = "timeout"
+    wall = time.monotonic() - start
+    with open(log_path, errors="replace") as log:
+        text = log.read()
+    return rc, wall, log_path, text
+
+
+def save_checkpoint(sim, out_dir, extra, timeout):
+    run_dir = os.path.join(out_dir, "checkpoint")
+    os.makedirs(run_dir, exist_ok=True)
+    ckpt = os.path.join(run_dir, "cl_top_powerup.ckpt")
+    cmd = shlex.split(sim) + ["+CHECKPOINT_SAVE=%s" % ckpt] + extra
+    rc, wall, log_path, text = call_logged(cmd, run_dir, timeout)
+    if "CHECKPOINT saved" not in text:
+        print("ERROR: checkpoint run failed (rc %s), see %s" % (rc, log_path))
+        return None
+    print("Checkpoint saved in %.1f s: %s" % (wall, ckpt))
+    return ckpt
+
+
+def run_one(sim, test, seed, out_dir, extra, timeout):
+    run_dir = os.path.join(out_dir, "%s_s%d" % (test, seed))
+    os.makedirs(run_dir, exist_ok=True)
+    cmd = shlex.split(sim) + ["+TEST=%s" % test, "+SEED=%d" % seed] + extra
+    rc, wall, log_path, text = call_logged(cmd, run_dir, timeout)
+    passed = "TEST PASSED" in text and "TEST FAILED" not in text and rc == 0
+    result = {
+        "test": test,
+        "seed": seed,
+        "pass": passed,
+        "rc": rc,
+        "wall_s": round(wall, 3),
+        "log": log_path,
+        "perf": re.findall(r"PERF (.*)", text),
+    }
+    perf_json = os.path.join(run_dir, "cl_top_perf.json")
+    if os.path.exists(perf_json):
+        with open(perf_json) as f:
+            result["perf_budget"] = json.load(f)
+    return result
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__,
+                                 formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("--sim", required=True,
+                    help="command that runs the compiled snapshot (plusargs are appended)")
+    ap.add_argument("-t", "--test", action="append", choices=TESTS,
+                    help="test to run, repeatable (default: all)")
+    ap.add_argument("-s", "--seeds", type=int, default=1, help="seeds per test")
+    ap.add_argument("--seed-base", type=int, default=1)
+    ap.add_argument("-j", "--jobs", type=int, default=os.cpu_count(),
+                    help="parallel simulations (default: host cores)")
+    ap.add_argument("--restore", metavar="CMD",
+                    help="restore command with {ckpt} for the checkpoint file; power-up "
+                         "is then simulated once and every run starts from the checkpoint")
+    ap.add_argument("--timeout", type=int, default=3600, help="seconds per run")
+    ap.add_argument("--out", default="regress", help="output directory")
+    ap.add_argument("extra", nargs="*", help="extra plusargs for every run")
+    args = ap.parse_args()
+
+    args.sim = abs_sim(args.sim)
+
+    tests = args.test or TESTS
+    out_dir = os.path.abspath(args.out)
+    os.makedirs(out_dir, exist_ok=True)
+    runs = [(t, args.seed_base + i) for t in tests for i in range(args.seeds)]
+
+    start = time.monotonic()
+    run_sim = args.sim
+    if args.restore:
+        ckpt = save_checkpoint(args.sim, out_dir, args.extra, args.timeout)
+        if ckpt is None:
+            return 1
+        run_sim = abs_sim(args.restore.replace("{ckpt}", shlex.quote(ckpt)))
+
+    results = []
+    with ThreadPoolExecutor(max_workers=max(1, args.jobs)) as pool:
+        futures = [pool.submit(run_one, run_sim, t, s, out_dir, args.extra, args.timeout)
+                   for t, s in runs]
+        for fut in as_completed(futures):
+            r = fut.result()
+            results.append(r)
+            print("%-5s %-14s seed %-6d %8.1f s  %s" % (
+                "PASS" if r["pass"] else "FAIL", r["test"], r["seed"], r["wall_s"], r["log"]))
+            sys.stdout.flush()
+    total = time.monotonic() - start
+
+    results.sort(key=lambda r: (r["test"], r["seed"]))
+    failed = [r for r in results if not r["pass"]]
+    summary = {
+        "runs": len(results),
+        "passed": len(results) - len(failed),
+        "failed": len(failed),
+        "jobs": args.jobs,
+        "checkpoint": bool(args.restore),
+        "total_wall_s": round(total, 3),
+        "serial_wall_s": round(sum(r["wall_s"] for r in results), 3),
+        "results": results,
+    }
+    with open(os.path.join(out_dir, "summary.json"), "w") as f:
+        json.dump(summary, f, indent=2)
+
+    print("\n%d/%d passed, regression wall time %.1f s (%.1f s of simulation, %d jobs)" % (
+        summary["passed"], summary["runs"], total, summary["serial_wall_s"], args.jobs))
+    print("Summary written to %s" % os.path.join(out_dir, "summary.json"))
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,200 @@
+/*
+ * Copyright 2015-2024 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// OCL register map of cl_top, shared by the host program and its tools
+
+#ifndef CL_TOP_REGS_H
+#define CL_TOP_REGS_H
+
+// Register addresses for Simple Add-One
+#define INPUT_BASE_ADDR     0x00    // Input registers 0x00-0x1C (8 regs)
+#define OUTPUT_BASE_ADDR    0x20    // Output registers 0x20-0x3C (8 regs)
+#define CONTROL_REG_ADDR    0x40    // Control register
+#define STATUS_REG_ADDR     0x44    // Status register
+
+// Kernel slot discovery (read-only). The ID register holds the kernel ID
+// in [15:0] and its version in [31:16]; the capabilities register holds the
+// lane count, the input-to-result latency in cycles and feature flags.
+#define KERNEL_ID_ADDR          0x48
+#define KERNEL_CAPS_ADDR        0x4C
+#define KERNEL_ID(v)            ((v) & 0xFFFF)
+#define KERNEL_VERSION(v)       (((v) >> 16) & 0xFFFF)
+#define KERNEL_CAPS_LANES(c)    ((c) & 0xFF)
+#define KERNEL_CAPS_LATENCY(c)  (((c) >> 8) & 0xFF)
+#define KERNEL_CAPS_FLAGS(c)    (((c) >> 16) & 0xFFFF)
+
+#define KERNEL_CAPS_FLAG_ALU    0x0001  // Honors JOB_OPCODE/JOB_OPERAND
+#define KERNEL_CAPS_FLAG_SCAN   0x0002  // Prefix sum with a carry kept across jobs
+
+#define KERNEL_ADD_ONE          0x0001  // Reference kernel: every lane + 1
+#define KERNEL_ALU              0x0002  // Opcode-selected ALU, every lane op operand
+#define KERNEL_SCAN             0x0003  // Prefix sum over the lanes plus a running carry
+
+// Job arguments, sampled with the inputs when start is accepted and passed
+// to the kernel. Reset to ALU_OP_ADD with operand 1, i.e. add-one.
+#define JOB_OPCODE_ADDR         0x50    // ALU_OP_* in [3:0]
+#define JOB_OPERAND_ADDR        0x54    // Scalar operand K for every lane
+
+#define ALU_OP_ADD              0x0     // x + K
+#define ALU_OP_SUB              0x1     // x - K
+#define ALU_OP_AND              0x2     // x & K
+#define ALU_OP_OR               0x3     // x | K
+#define ALU_OP_XOR              0x4     // x ^ K
+#define ALU_OP_SHL              0x5     // x << K[4:0]
+#define ALU_OP_SHR              0x6     // x >> K[4:0], logical
+#define ALU_OP_SRA              0x7     // x >> K[4:0], arithmetic
+#define ALU_OP_ADD_SAT          0x8     // x + K, clamped to 0xFFFFFFFF (unsigned)
+#define ALU_OP_ADD_SAT_S        0x9     // x + K, clamped to INT32_MIN/MAX (signed)
+#define ALU_NUM_OPS             10      // Opcodes 10-15 pass x through unchanged
+
+// Scan kernel job opcode bits; the carry to load is JOB_OPERAND
+#define SCAN_OP_INCLUSIVE       0x0     // y[i] = carry + x[0] + ... + x[i]
+#define SCAN_OP_EXCLUSIVE       0x1     // y[i] = carry + x[0] + ... + x[i-1]
+#define SCAN_OP_LOAD            0x2     // Load the carry before this job
+
+// Word predicate, x compared with PRED_VALUE. PRED_CTRL_SIGNED makes the
+// comparisons two's complement; it also applies to the reduction's min, max
+// and sum.
+#define PRED_CTRL_ADDR          0x58    // PRED_OP_* in [2:0], PRED_CTRL_SIGNED
+#define PRED_VALUE_ADDR         0x5C
+
+#define PRED_OP_ALWAYS          0x0
+#define PRED_OP_EQ              0x1     // x == value
+#define PRED_OP_NE              0x2     // x != value
+#define PRED_OP_LT              0x3     // x < value
+#define PRED_OP_LE              0x4     // x <= value
+#define PRED_OP_GT              0x5     // x > value
+#define PRED_OP_GE              0x6     // x >= value
+#define PRED_OP_NEVER           0x7
+#define PRED_NUM_OPS            8
+#define PRED_CTRL_SIGNED        0x00000008
+
+// Reduction engine. Every job folds the lanes selected by the mask into a
+// 64-bit sum, a min, a max, the count of words matching the predicate and
+// the count of words seen. The results are stable while the engine is idle.
+#define RED_CTRL_ADDR           0x60
+#define RED_SUM_LO_ADDR         0x64
+#define RED_SUM_HI_ADDR         0x68
+#define RED_MIN_ADDR            0x6C    // 0 before the first word
+#define RED_MAX_ADDR            0x70    // 0 before the first word
+#define RED_COUNT_ADDR          0x74    // Words matching the predicate
+#define RED_WORDS_ADDR          0x78    // Words reduced
+
+#define RED_CTRL_ACCUMULATE     0x00000001  // Fold into the previous results
+#define RED_CTRL_CLEAR          0x00000002  // Self-clearing: zero the results
+#define RED_CTRL_RESULTS        0x00000004  // Reduce the result beat, not the inputs
+#define RED_CTRL_MASK(m)        (((m) & 0xFF) << 8)     // Lanes to reduce
+#define RED_CTRL_MASK_GET(c)    (((c) >> 8) & 0xFF)
+#define RED_CTRL_MASK_ALL       RED_CTRL_MASK(0xFF)
+
+// Stream compaction. With it enabled a job writes only the masked lanes
+// matching the predicate to the output bank, packed from OUTPUT_BASE_ADDR
+// up in lane order and followed by zeros, and COMPACT_COUNT says how many.
+#define COMPACT_CTRL_ADDR       0x7C
+#define COMPACT_COUNT_ADDR      0x90    // Words in the output bank; 8 when disabled
+
+#define COMPACT_CTRL_ENABLE     0x00000001
+#define COMPACT_CTRL_RESULTS    0x00000002  // Compact the result beat, not the inputs
+#define COMPACT_CTRL_MASK(m)    (((m) & 0xFF) << 8)     // Lanes to consider
+#define COMPACT_CTRL_MASK_GET(c) (((c) >> 8) & 0xFF)
+#define COMPACT_CTRL_MASK_ALL   COMPACT_CTRL_MASK(0xFF)
+
+// Hardware performance counters (read-only, write PERF_JOBS_ADDR to clear)
+#define PERF_JOBS_ADDR          0x80    // Jobs completed
+#define PERF_BUSY_CYCLES_ADDR   0x84    // Cycles the kernel engine was busy
+#define PERF_OCL_WRITES_ADDR    0x88    // OCL write transactions
+#define PERF_OCL_READS_ADDR     0x8C    // OCL read transactions
+
+// 64-bit clk_main_a0 cycle timestamps, low word first. Reading
+// HWTS_CYCLE_LO_ADDR snapshots the whole counter for HWTS_CYCLE_HI_ADDR.
+#define HWTS_CYCLE_LO_ADDR      0xC0    // Free-running cycle counter
+#define HWTS_CYCLE_HI_ADDR      0xC4
+#define HWTS_START_LO_ADDR      0xC8    // Cycle the last job started
+#define HWTS_START_HI_ADDR      0xCC
+#define HWTS_DONE_LO_ADDR       0xD0    // Cycle the last job completed
+#define HWTS_DONE_HI_ADDR       0xD4
+#define HWTS_DOORBELL_LO_ADDR   0xD8    // Last OCL write before the job started
+#define HWTS_DOORBELL_HI_ADDR   0xDC
+
+// On-card latency histograms, in clk_main_a0 cycles. Bin k counts
+// latencies of 2^k to 2^(k+1)-1 cycles; the last bin is open-ended.
+#define HIST_SVC_BASE_ADDR      0x100   // Job start -> done (16 bins)
+#define HIST_REACT_BASE_ADDR    0x140   // Done -> next status read (16 bins)
+#define HIST_CTRL_ADDR          0x180   // Histogram control
+#define HIST_CLEAR_BIT          0x00000001
+#define HIST_BINS               16
+
+// OCL transaction trace buffer. Each entry is four words read at
+// OCL_TRACE_DATA0..3; reading DATA3 advances the read pointer.
+#define OCL_TRACE_CTRL_ADDR     0x200
+#define OCL_TRACE_EVMASK_ADDR   0x204   // Events to record (OCL_TRACE_EV_*)
+#define OCL_TRACE_AMATCH_ADDR   0x208   // Address match value
+#define OCL_TRACE_AMASK_ADDR    0x20C   // Address bits to compare (0 = any)
+#define OCL_TRACE_TRIG_ADDR     0x210   // AW/AR to this address starts recording
+#define OCL_TRACE_STATUS_ADDR   0x214
+#define OCL_TRACE_RD_PTR_ADDR   0x218
+#define OCL_TRACE_DATA0_ADDR    0x21C   // Low word of the HWTS cycle counter
+#define OCL_TRACE_DATA1_ADDR    0x220   // [28:24] events, [23:12] write addr, [11:0] read addr
+#define OCL_TRACE_DATA2_ADDR    0x224   // Write data
+#define OCL_TRACE_DATA3_ADDR    0x228   // Read data
+
+#define OCL_TRACE_CTRL_ENABLE       0x00000001
+#define OCL_TRACE_CTRL_CLEAR        0x00000002
+#define OCL_TRACE_CTRL_STOP_FULL    0x00000004
+#define OCL_TRACE_CTRL_TRIGGER      0x00000008
+
+#define OCL_TRACE_EV_AW         0x01
+#define OCL_TRACE_EV_W          0x02
+#define OCL_TRACE_EV_B          0x04
+#define OCL_TRACE_EV_AR         0x08
+#define OCL_TRACE_EV_R          0x10
+#define OCL_TRACE_EV_ALL        0x1F
+
+#define OCL_TRACE_STATUS_COUNT(s)   ((s) & 0x7FF)
+#define OCL_TRACE_STATUS_WRPTR(s)   (((s) >> 16) & 0x3FF)
+#define OCL_TRACE_STATUS_WRAPPED    0x40000000
+#define OCL_TRACE_STATUS_TRIGGERED  0x80000000
+#define OCL_TRACE_DEPTH             1024
+
+// Out-of-band monitor on the SDA slave, management PF BAR4. The same
+// status word and job counters drive cl_sh_status0/1/2.
+#define SDA_STATUS_ADDR         0x00    // SDA_STATUS_* bits, errors in [10:8]
+#define SDA_JOBS_STARTED_ADDR   0x04
+#define SDA_JOBS_DONE_ADDR      0x08
+#define SDA_ERRORS_ADDR         0x0C    // SDA_ERR_* bits, write 1 to clear
+#define SDA_CYCLE_LO_ADDR       0x10    // Reading snapshots SDA_CYCLE_HI_ADDR
+#define SDA_CYCLE_HI_ADDR       0x14
+#define SDA_BUSY_CYCLES_ADDR    0x18
+#define SDA_OCL_WRITES_ADDR     0x1C
+#define SDA_OCL_READS_ADDR      0x20
+
+#define SDA_STATUS_BUSY         0x00000001
+#define SDA_STATUS_DONE         0x00000002
+#define SDA_STATUS_START        0x00000004
+#define SDA_STATUS_TRACE        0x00000008
+#define SDA_STATUS_ERRORS(s)    (((s) >> 8) & 0x7)
+
+#define SDA_ERR_RD_UNMAPPED     0x1     // OCL read of an unmapped address
+#define SDA_ERR_WR_UNMAPPED     0x2     // OCL write to an unmapped address
+#define SDA_ERR_START_BUSY      0x4     // Start written while busy or done
+
+#define CLK_MAIN_A0_MHZ         250     // Default clk_main_a0 recipe
+
+#define START_BIT           0x00000001
+#define DONE_BIT            0x00000001
+
+#define NUM_REGISTERS       8
+
+#endif // CL_TOP_REGS_H
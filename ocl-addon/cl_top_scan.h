@@ -0,0 +1,50 @@
+/*
+ * Copyright 2015-2024 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Reference semantics of the scan kernel (cl_kernel_scan.sv).
+//
+// cl_top_scan_apply_n() scans words exactly as consecutive scan jobs do,
+// carrying *carry from one call to the next; the model uses it to produce
+// each job's result and the host checks card results against it. Plain C
+// with no SDK dependency, like cl_top_alu.h.
+
+#ifndef CL_TOP_SCAN_H
+#define CL_TOP_SCAN_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "cl_top_regs.h"
+
+static inline void cl_top_scan_apply_n(uint32_t op, uint32_t k, uint32_t *carry,
+                                       const uint32_t *in, uint32_t *out, size_t n) {
+    uint32_t c = (op & SCAN_OP_LOAD) ? k : *carry;
+
+    if (op & SCAN_OP_EXCLUSIVE) {
+        for (size_t i = 0; i < n; i++) {
+            uint32_t x = in[i];
+            out[i] = c;
+            c += x;
+        }
+    } else {
+        for (size_t i = 0; i < n; i++) {
+            c += in[i];
+            out[i] = c;
+        }
+    }
+    *carry = c;
+}
+
+#endif // CL_TOP_SCAN_H
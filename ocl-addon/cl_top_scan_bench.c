@@ -0,0 +1,212 @@
+/*
+ * Copyright 2015-2024 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Prefix sums on the scan kernel against the CPU.
+//
+//   cl_top_scan_bench [-n words] [-c chunk] [-x] [-r reps] [-S slot] [-E]
+//
+// Scans an n-word array on a card built with the scan kernel
+// (cl_top_scan_array), in chunks of -c words that each resume from the
+// previous chunk's carry, as a host streaming a larger array would. The
+// same array is scanned on the CPU with the scalar reference (cl_top_scan.h)
+// and with SSE2, 4 words per step (scalar when the compiler has no SSE2),
+// each -r times. All three must agree. -x scans exclusive instead of
+// inclusive. Reports OCL transactions and time per word for the card and
+// time per word for each CPU scan. With -E the card is the transaction-level
+// model with the scan kernel in the slot, and card time is reported in
+// clk_main_a0 cycles, plus the word rate one serial master reaches at the
+// card's clock.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "cl_top_bench.h"
+#include "cl_top_jobs.h"
+#include "cl_top_kernel.h"
+#include "cl_top_mmio.h"
+#include "cl_top_model.h"
+#include "cl_top_regs.h"
+#include "cl_top_scan.h"
+
+// In-register prefix sum of 4 lanes in two shifted adds, plus the carry
+// broadcast from the last lane of the previous step
+static void scan_simd(uint32_t op, const uint32_t *x, uint32_t *y, size_t n) {
+    uint32_t carry = 0;
+    size_t i = 0;
+
+#ifdef __SSE2__
+    __m128i c = _mm_setzero_si128();
+    for (; i + 4 <= n; i += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i *)&x[i]);
+        __m128i s = _mm_add_epi32(v, _mm_slli_si128(v, 4));
+        s = _mm_add_epi32(s, _mm_slli_si128(s, 8));
+        s = _mm_add_epi32(s, c);
+        _mm_storeu_si128((__m128i *)&y[i], (op & SCAN_OP_EXCLUSIVE) ? _mm_sub_epi32(s, v) : s);
+        c = _mm_shuffle_epi32(s, _MM_SHUFFLE(3, 3, 3, 3));
+    }
+    carry = (uint32_t)_mm_cvtsi128_si32(c);
+#endif
+    cl_top_scan_apply_n(op & SCAN_OP_EXCLUSIVE, 0, &carry, &x[i], &y[i], n - i);
+}
+
+static void scan_scalar(uint32_t op, const uint32_t *x, uint32_t *y, size_t n) {
+    uint32_t carry = 0;
+    cl_top_scan_apply_n(op & SCAN_OP_EXCLUSIVE, 0, &carry, x, y, n);
+}
+
+static int scan_check(const char *name, const uint32_t *want, const uint32_t *got, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        if (got[i] != want[i]) {
+            printf("ERROR: %s scan word %zu is 0x%08x, expected 0x%08x\n", name, i, got[i],
+                   want[i]);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    static struct bench_card card;
+    struct bench_opts opts = { .n = 1 << 16 };
+    struct cl_top_kernel_info kernel;
+    struct bench_run run = {0};
+    size_t n;
+    size_t chunk = 4096;
+    uint32_t op = SCAN_OP_INCLUSIVE;
+    int reps = 100;
+    uint32_t *x;
+    uint32_t *y_card;
+    uint32_t *y_ref;
+    uint32_t *y_simd;
+    uint32_t carry = 0;
+    double t_ref;
+    double t_simd;
+    int opt;
+    int rc;
+
+    while ((opt = getopt(argc, argv, "n:c:xr:S:E")) != -1) {
+        rc = bench_opt(&opts, opt, optarg);
+        if (rc < 0) {
+            return 1;
+        }
+        if (rc > 0) {
+            continue;
+        }
+        switch (opt) {
+        case 'c':
+            chunk = strtoull(optarg, NULL, 0);
+            break;
+        case 'x':
+            op = SCAN_OP_EXCLUSIVE;
+            break;
+        case 'r':
+            reps = atoi(optarg);
+            break;
+        default:
+            printf("Usage: %s [-n words] [-c chunk] [-x] [-r reps] [-S slot] [-E]\n", argv[0]);
+            return 1;
+        }
+    }
+    n = opts.n;
+    if (n == 0 || chunk == 0 || reps < 1) {
+        printf("ERROR: Word count, chunk size and repetitions must be at least 1\n");
+        return 1;
+    }
+
+    x = bench_input(n);
+    if (x == NULL) {
+        return 1;
+    }
+    y_card = malloc(n * sizeof(*y_card));
+    y_ref = malloc(n * sizeof(*y_ref));
+    y_simd = malloc(n * sizeof(*y_simd));
+    if (y_card == NULL || y_ref == NULL || y_simd == NULL) {
+        printf("ERROR: Unable to allocate %zu words\n", n);
+        return 1;
+    }
+
+    rc = bench_card_open(&card, &opts);
+    if (rc != 0) {
+        return rc;
+    }
+    if (card.emulate) {
+        cl_top_model_set_kernel(&card.model, KERNEL_SCAN);
+    }
+    rc = cl_top_kernel_probe(card.bar, &kernel);
+    if (rc == 0 && !(kernel.flags & KERNEL_CAPS_FLAG_SCAN)) {
+        cl_top_kernel_print(&kernel);
+        printf("ERROR: The kernel in slot %d cannot scan\n", opts.slot_id);
+        rc = 1;
+    }
+
+    bench_run_begin(&card, &run);
+    for (size_t i = 0; i < n && rc == 0; i += chunk) {
+        size_t m = n - i < chunk ? n - i : chunk;
+        rc = cl_top_scan_array(card.bar, op, carry, &x[i], &y_card[i], m, &carry);
+    }
+    bench_run_end(&card, &run);
+    t_ref = bench_now_ns();
+    for (int r = 0; r < reps; r++) {
+        scan_scalar(op, x, y_ref, n);
+    }
+    t_ref = (bench_now_ns() - t_ref) / reps;
+    t_simd = bench_now_ns();
+    for (int r = 0; r < reps; r++) {
+        scan_simd(op, x, y_simd, n);
+    }
+    t_simd = (bench_now_ns() - t_simd) / reps;
+
+    if (rc == 0) {
+        rc = scan_check("SIMD", y_ref, y_simd, n);
+    }
+    if (rc == 0) {
+        rc = scan_check("Card", y_ref, y_card, n);
+    }
+    if (rc == 0) {
+        printf("=== cl_top scan: %zu words, %s, chunks of %zu words ===\n", n,
+               (op & SCAN_OP_EXCLUSIVE) ? "exclusive" : "inclusive", chunk);
+        printf("  %-11s %6.3f OCL transactions/word, ", "card", (double)run.xacts / (double)n);
+        if (opts.emulate) {
+            printf("%.2f cycles/word (%.1f M words/s at %d MHz)\n",
+                   (double)run.cycles / (double)n,
+                   CLK_MAIN_A0_MHZ / ((double)run.cycles / (double)n), CLK_MAIN_A0_MHZ);
+        } else {
+            printf("%.1f ns/word\n", run.ns / (double)n);
+        }
+        printf("  %-11s %8.3f ns/word (%.2f GB/s in+out)\n", "CPU scalar", t_ref / (double)n,
+               8.0 * (double)n / t_ref);
+#ifdef __SSE2__
+        printf("  %-11s %8.3f ns/word (%.2f GB/s in+out)\n", "CPU SSE2", t_simd / (double)n,
+               8.0 * (double)n / t_simd);
+#else
+        printf("  %-11s %8.3f ns/word (no SSE2, scalar)\n", "CPU SIMD", t_simd / (double)n);
+#endif
+        printf("  final carry 0x%08x\n", carry);
+    }
+
+    bench_card_close(&card);
+    free(x);
+    free(y_card);
+    free(y_ref);
+    free(y_simd);
+    return rc ? 1 : 0;
+}
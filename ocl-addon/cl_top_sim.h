@@ -0,0 +1,48 @@
+/*
+ * Copyright 2015-2024 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Host code inside the HDK simulation (SV_TEST builds).
+//
+// cl_top_host.c is compiled into the simulator with -DSV_TEST, as the HDK
+// C test flow does, and cl_top_host_test.sv calls its cl_top_host_main()
+// entry point over DPI-C. The test exports these tasks and functions back:
+// OCL accesses go through tb.peek_ocl/tb.poke_ocl to the RTL, delays
+// advance simulated time, and the time stamp counter reads simulated time
+// in nanoseconds, so every per-stage latency the host reports is
+// simulated time. In normal builds CL_TOP_SIM is 0 and nothing here is
+// referenced.
+
+#ifndef CL_TOP_SIM_H
+#define CL_TOP_SIM_H
+
+#include <stdint.h>
+
+#ifdef SV_TEST
+
+#define CL_TOP_SIM 1
+
+// Exported from cl_top_host_test.sv
+extern int cl_top_sim_peek(unsigned long long offset, unsigned int *value);
+extern int cl_top_sim_poke(unsigned long long offset, unsigned int value);
+extern int cl_top_sim_wait_ns(unsigned int ns);
+extern unsigned long long cl_top_sim_now_ns(void);
+
+#else
+
+#define CL_TOP_SIM 0
+
+#endif
+
+#endif // CL_TOP_SIM_H
@@ -0,0 +1,212 @@
+/*
+ * Copyright 2015-2024 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Per-stage TSC timing for the Add-One host protocol.
+//
+// Each stage of test_add_one_operation() is bracketed with rdtsc and the
+// elapsed ticks go into a log-bucketed (HDR-style) histogram: 8 linear
+// sub-buckets per power of two, so every recorded value keeps ~12% relative
+// precision from 1 tick up to 2^64. Recording is a clz, a shift and an
+// increment; tick-to-nanosecond conversion only happens when dumping.
+
+#ifndef CL_TOP_STATS_H
+#define CL_TOP_STATS_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "cl_top_sim.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#define STATS_SUB_BITS      3
+#define STATS_SUB_BUCKETS   (1 << STATS_SUB_BITS)
+#define STATS_NUM_BUCKETS   ((64 - STATS_SUB_BITS + 1) * STATS_SUB_BUCKETS)
+
+// Stages of one Add-One job, in protocol order
+enum cl_top_stage {
+    STAGE_CTRL_CLEAR = 0,   // Step 2: clear control register
+    STAGE_INPUT_WRITE,      // Step 3: write input registers
+    STAGE_INPUT_VERIFY,     // Step 4: read back input registers
+    STAGE_STATUS_CHECK,     // Step 5: initial status read
+    STAGE_START,            // Step 6: set start bit
+    STAGE_POLL,             // Step 7: poll for done
+    STAGE_START_CLEAR,      // Step 8: clear start bit
+    STAGE_READBACK,         // Step 9: read output registers
+    STAGE_RESULT_VERIFY,    // Step 10: compare against expected
+    STAGE_JOB_TOTAL,        // Steps 2-10 end to end
+    STAGE_COUNT
+};
+
+static const char *const cl_top_stage_names[STAGE_COUNT] = {
+    "ctrl_clear",
+    "input_write",
+    "input_verify",
+    "status_check",
+    "start",
+    "poll",
+    "start_clear",
+    "readback",
+    "result_verify",
+    "job_total",
+};
+
+struct cl_top_hist {
+    uint64_t count;
+    uint64_t sum;
+    uint64_t min;
+    uint64_t max;
+    uint64_t buckets[STATS_NUM_BUCKETS];
+};
+
+struct cl_top_stats {
+    struct cl_top_hist stage[STAGE_COUNT];
+    uint64_t tsc_origin;            // TSC and wall clock at init, used to
+    struct timespec ts_origin;      // calibrate ticks/ns when dumping
+};
+
+// In simulation (SV_TEST) the counter is simulated time, one tick per ns
+static inline uint64_t cl_top_tsc(void) {
+#if defined(SV_TEST)
+    return cl_top_sim_now_ns();
+#elif defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+static inline unsigned cl_top_hist_index(uint64_t v) {
+    if (v < STATS_SUB_BUCKETS) {
+        return (unsigned)v;
+    }
+    unsigned msb = 63 - __builtin_clzll(v);
+    unsigned sub = (unsigned)(v >> (msb - STATS_SUB_BITS)) & (STATS_SUB_BUCKETS - 1);
+    return (msb - STATS_SUB_BITS + 1) * STATS_SUB_BUCKETS + sub;
+}
+
+// Smallest value that lands in bucket idx
+static inline uint64_t cl_top_hist_lower(unsigned idx) {
+    if (idx < STATS_SUB_BUCKETS) {
+        return idx;
+    }
+    unsigned msb = idx / STATS_SUB_BUCKETS + STATS_SUB_BITS - 1;
+    uint64_t sub = idx % STATS_SUB_BUCKETS;
+    return (STATS_SUB_BUCKETS + sub) << (msb - STATS_SUB_BITS);
+}
+
+static inline void cl_top_hist_record(struct cl_top_hist *h, uint64_t v) {
+    h->buckets[cl_top_hist_index(v)]++;
+    h->count++;
+    h->sum += v;
+    if (v < h->min) h->min = v;
+    if (v > h->max) h->max = v;
+}
+
+// Value at quantile q (0.0-1.0), reported as the lower bound of its bucket
+static inline uint64_t cl_top_hist_quantile(const struct cl_top_hist *h, double q) {
+    if (h->count == 0) {
+        return 0;
+    }
+    // Nearest rank, ceil(q * count), so p99 of 2 samples is the larger one
+    double r = q * (double)h->count;
+    uint64_t rank = (uint64_t)r;
+    if ((double)rank < r) {
+        rank++;
+    }
+    if (rank < 1) {
+        rank = 1;
+    }
+    uint64_t seen = 0;
+    for (unsigned i = 0; i < STATS_NUM_BUCKETS; i++) {
+        seen += h->buckets[i];
+        if (seen >= rank) {
+            uint64_t lower = cl_top_hist_lower(i);
+            return lower < h->min ? h->min : lower;
+        }
+    }
+    return h->max;
+}
+
+static inline void cl_top_stats_init(struct cl_top_stats *s) {
+    for (int i = 0; i < STAGE_COUNT; i++) {
+        struct cl_top_hist *h = &s->stage[i];
+        h->count = 0;
+        h->sum = 0;
+        h->min = UINT64_MAX;
+        h->max = 0;
+        for (int b = 0; b < STATS_NUM_BUCKETS; b++) {
+            h->buckets[b] = 0;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &s->ts_origin);
+    s->tsc_origin = cl_top_tsc();
+}
+
+// Close a stage that began at tsc 'start'. Returns the end timestamp so
+// consecutive stages can be chained without a second rdtsc.
+static inline uint64_t cl_top_stage_end(struct cl_top_stats *s, enum cl_top_stage stage,
+                                        uint64_t start) {
+    uint64_t now = cl_top_tsc();
+    cl_top_hist_record(&s->stage[stage], now - start);
+    return now;
+}
+
+// Ticks per nanosecond, measured over the whole lifetime of the stats block
+static inline double cl_top_stats_ticks_per_ns(const struct cl_top_stats *s) {
+    if (CL_TOP_SIM) {
+        return 1.0;
+    }
+    struct timespec now;
+    uint64_t tsc = cl_top_tsc();
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    double ns = (double)(now.tv_sec - s->ts_origin.tv_sec) * 1e9 +
+                (double)(now.tv_nsec - s->ts_origin.tv_nsec);
+    if (ns <= 0.0 || tsc <= s->tsc_origin) {
+        return 1.0;
+    }
+    return (double)(tsc - s->tsc_origin) / ns;
+}
+
+static inline void cl_top_stats_dump(const struct cl_top_stats *s, FILE *out) {
+    double tpn = cl_top_stats_ticks_per_ns(s);
+
+    fprintf(out, "\n=== Per-stage latency (ns, TSC %.3f ticks/ns) ===\n", tpn);
+    fprintf(out, "%-14s %10s %10s %10s %10s %10s %10s %10s\n",
+            "stage", "count", "min", "mean", "p50", "p99", "p99.9", "max");
+    for (int i = 0; i < STAGE_COUNT; i++) {
+        const struct cl_top_hist *h = &s->stage[i];
+        if (h->count == 0) {
+            continue;
+        }
+        fprintf(out, "%-14s %10llu %10.0f %10.0f %10.0f %10.0f %10.0f %10.0f\n",
+                cl_top_stage_names[i],
+                (unsigned long long)h->count,
+                (double)h->min / tpn,
+                ((double)h->sum / (double)h->count) / tpn,
+                (double)cl_top_hist_quantile(h, 0.50) / tpn,
+                (double)cl_top_hist_quantile(h, 0.99) / tpn,
+                (double)cl_top_hist_quantile(h, 0.999) / tpn,
+                (double)h->max / tpn);
+    }
+    fflush(out);
+}
+
+#endif // CL_TOP_STATS_H
@@ -0,0 +1,363 @@
+/*
+ * Copyright 2015-2024 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Binary event tracer for the host job protocol.
+//
+// The hot path records fixed-size events (type, register address, value,
+// TSC) into a per-thread ring instead of calling printf. Each ring has a
+// single producer, so an event is a few stores plus a release store of the
+// head index. The human-readable report is rendered from the records
+// afterwards, either in-process between jobs or offline by
+// cl_top_trace_decode from a dumped trace file.
+//
+// When tracing is disabled CL_TOP_TRACE() is a single predicted-not-taken
+// branch on a global flag.
+
+#ifndef CL_TOP_TRACE_H
+#define CL_TOP_TRACE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#include "cl_top_alu.h"
+#include "cl_top_regs.h"
+#include "cl_top_stats.h"
+
+#define TRACE_RING_RECORDS  65536   // per thread, must be a power of two
+#define TRACE_FILE_MAGIC    0x45434152544f4c43ull  // "CLOTRACE"
+#define TRACE_FILE_VERSION  1
+
+enum cl_top_trace_event {
+    TRACE_EV_JOB_BEGIN = 1, // value: job id
+    TRACE_EV_STEP,          // arg: protocol step number
+    TRACE_EV_DATA,          // arg: register index, value: test input
+    TRACE_EV_POKE,          // addr/value of an MMIO write
+    TRACE_EV_PEEK,          // addr/value of an MMIO read
+    TRACE_EV_POLL_DONE,     // value: number of status polls
+    TRACE_EV_VERIFY,        // value: number of correct outputs
+    TRACE_EV_ARGS,          // arg: ALU opcode, value: operand the outputs are checked against
+};
+
+struct cl_top_trace_rec {
+    uint64_t tsc;
+    uint16_t type;
+    uint16_t arg;
+    uint32_t addr;
+    uint32_t value;
+    uint32_t job;
+};
+
+struct cl_top_trace_ring {
+    struct cl_top_trace_ring *next;
+    uint64_t head;              // records ever written; published with release
+    uint32_t tid;
+    uint32_t job;               // current job id, stamped into each record
+    struct cl_top_trace_rec rec[TRACE_RING_RECORDS];
+};
+
+// File layout: header, then per ring a cl_top_trace_thread followed by
+// 'count' records, oldest first.
+struct cl_top_trace_file_hdr {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t rec_size;
+    double   ticks_per_ns;
+    uint32_t num_threads;
+    uint32_t reserved;
+};
+
+struct cl_top_trace_thread {
+    uint32_t tid;
+    uint32_t reserved;
+    uint64_t count;
+};
+
+static bool cl_top_trace_enabled __attribute__((unused)) = false;
+static struct cl_top_trace_ring *cl_top_trace_rings __attribute__((unused)) = NULL;
+static __thread struct cl_top_trace_ring *cl_top_trace_self __attribute__((unused)) = NULL;
+
+#define CL_TOP_TRACE(type, arg, addr, value)                                \
+    do {                                                                    \
+        if (__builtin_expect(cl_top_trace_enabled, 0)) {                    \
+            cl_top_trace_emit((type), (arg), (addr), (value));              \
+        }                                                                   \
+    } while (0)
+
+// Allocate this thread's ring and link it into the global list
+static inline struct cl_top_trace_ring *cl_top_trace_ring_create(void) {
+    struct cl_top_trace_ring *ring = calloc(1, sizeof(*ring));
+    if (ring == NULL) {
+        return NULL;
+    }
+    ring->tid = (uint32_t)syscall(SYS_gettid);
+    ring->next = __atomic_load_n(&cl_top_trace_rings, __ATOMIC_RELAXED);
+    while (!__atomic_compare_exchange_n(&cl_top_trace_rings, &ring->next, ring, true,
+                                        __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+    }
+    cl_top_trace_self = ring;
+    return ring;
+}
+
+static inline void cl_top_trace_emit(uint16_t type, uint16_t arg, uint32_t addr, uint32_t value) {
+    struct cl_top_trace_ring *ring = cl_top_trace_self;
+    if (__builtin_expect(ring == NULL, 0)) {
+        ring = cl_top_trace_ring_create();
+        if (ring == NULL) {
+            return;
+        }
+    }
+    if (type == TRACE_EV_JOB_BEGIN) {
+        ring->job = value;
+    }
+    uint64_t head = ring->head;
+    struct cl_top_trace_rec *r = &ring->rec[head & (TRACE_RING_RECORDS - 1)];
+    r->tsc = cl_top_tsc();
+    r->type = type;
+    r->arg = arg;
+    r->addr = addr;
+    r->value = value;
+    r->job = ring->job;
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+}
+
+// Position of the calling thread's ring, to render a job once it completes
+static inline uint64_t cl_top_trace_mark(void) {
+    return cl_top_trace_self ? cl_top_trace_self->head : 0;
+}
+
+//-----------------------------------------------------------------------------
+// Rendering
+//-----------------------------------------------------------------------------
+
+struct cl_top_trace_render {
+    uint32_t input[NUM_REGISTERS];
+    uint32_t output[NUM_REGISTERS];
+    uint32_t alu_op;            // from TRACE_EV_ARGS; traces without one are add-one
+    uint32_t alu_operand;
+    int step;
+    int poll_count;
+    bool timestamps;            // prefix each line with ns since the first record
+    bool have_base;
+    uint64_t tsc_base;
+    double ticks_per_ns;
+};
+
+static const char *const cl_top_trace_step_text[] = {
+    "",
+    "Step 1: Initializing test data",
+    "Step 2: Clearing control register",
+    "Step 3: Writing input data to FPGA",
+    "Step 4: Verifying input data readback",
+    "Step 5: Checking initial status",
+    "Step 6: Starting computation",
+    "Step 7: Waiting for computation to complete",
+    "Step 8: Clearing start bit",
+    "Step 9: Reading output data",
+    "Step 10: Verifying results",
+};
+
+static inline void cl_top_trace_render_init(struct cl_top_trace_render *st, double ticks_per_ns,
+                                            bool timestamps) {
+    memset(st, 0, sizeof(*st));
+    st->ticks_per_ns = ticks_per_ns > 0.0 ? ticks_per_ns : 1.0;
+    st->timestamps = timestamps;
+    st->alu_op = ALU_OP_ADD;
+    st->alu_operand = 1;
+}
+
+static inline void cl_top_trace_prefix(FILE *out, struct cl_top_trace_render *st,
+                                       const struct cl_top_trace_rec *r) {
+    if (!st->timestamps) {
+        return;
+    }
+    if (!st->have_base) {
+        st->tsc_base = r->tsc;
+        st->have_base = true;
+    }
+    fprintf(out, "[%12.0f] ", (double)(r->tsc - st->tsc_base) / st->ticks_per_ns);
+}
+
+static inline void cl_top_trace_render_rec(FILE *out, struct cl_top_trace_render *st,
+                                           const struct cl_top_trace_rec *r) {
+    uint32_t addr = r->addr;
+
+    switch (r->type) {
+    case TRACE_EV_JOB_BEGIN:
+        st->step = 0;
+        st->poll_count = 0;
+        st->alu_op = ALU_OP_ADD;
+        st->alu_operand = 1;
+        cl_top_trace_prefix(out, st, r);
+        fprintf(out, "\n=== Testing Kernel Operation ===\n");
+        break;
+
+    case TRACE_EV_ARGS:
+        st->alu_op = r->arg;
+        st->alu_operand = r->value;
+        cl_top_trace_prefix(out, st, r);
+        fprintf(out, "  ALU %s, operand 0x%08x\n", cl_top_alu_op_name(r->arg), r->value);
+        break;
+
+    case TRACE_EV_STEP:
+        st->step = r->arg;
+        if (r->arg < sizeof(cl_top_trace_step_text) / sizeof(cl_top_trace_step_text[0])) {
+            cl_top_trace_prefix(out, st, r);
+            fprintf(out, "%s\n", cl_top_trace_step_text[r->arg]);
+        }
+        break;
+
+    case TRACE_EV_DATA:
+        if (r->arg < NUM_REGISTERS) {
+            st->input[r->arg] = r->value;
+        }
+        cl_top_trace_prefix(out, st, r);
+        fprintf(out, "  Input[%d] = 0x%08x\n", r->arg, r->value);
+        break;
+
+    case TRACE_EV_POKE:
+        cl_top_trace_prefix(out, st, r);
+        if (addr - INPUT_BASE_ADDR < NUM_REGISTERS * 4) {
+            fprintf(out, "  Wrote 0x%08x to address 0x%02x\n", r->value, addr);
+        } else if (addr == CONTROL_REG_ADDR && (r->value & START_BIT)) {
+            fprintf(out, "Computation started\n");
+        } else {
+            fprintf(out, "  Poke 0x%08x to address 0x%02x\n", r->value, addr);
+        }
+        break;
+
+    case TRACE_EV_PEEK:
+        if (addr - INPUT_BASE_ADDR < NUM_REGISTERS * 4) {
+            int i = (addr - INPUT_BASE_ADDR) / 4;
+            cl_top_trace_prefix(out, st, r);
+            fprintf(out, "  %s Input[%d] readback: 0x%08x\n",
+                    r->value == st->input[i] ? "✅" : "❌", i, r->value);
+        } else if (addr - OUTPUT_BASE_ADDR < NUM_REGISTERS * 4) {
+            int i = (addr - OUTPUT_BASE_ADDR) / 4;
+            st->output[i] = r->value;
+            cl_top_trace_prefix(out, st, r);
+            fprintf(out, "  Output[%d] = 0x%08x\n", i, r->value);
+        } else if (addr == STATUS_REG_ADDR && st->step == 7) {
+            st->poll_count++;
+            if (st->poll_count % 100 == 0) {
+                cl_top_trace_prefix(out, st, r);
+                fprintf(out, "  Polling... count=%d, status=0x%08x\n", st->poll_count, r->value);
+            }
+        } else if (addr == STATUS_REG_ADDR) {
+            cl_top_trace_prefix(out, st, r);
+            fprintf(out, "Initial status: 0x%08x\n", r->value);
+        } else {
+            cl_top_trace_prefix(out, st, r);
+            fprintf(out, "  Peek 0x%08x from address 0x%02x\n", r->value, addr);
+        }
+        break;
+
+    case TRACE_EV_POLL_DONE:
+        cl_top_trace_prefix(out, st, r);
+        fprintf(out, "✅ Computation completed after %u polls\n", r->value);
+        break;
+
+    case TRACE_EV_VERIFY:
+        cl_top_trace_prefix(out, st, r);
+        fprintf(out, "\nRESULTS COMPARISON:\n");
+        fprintf(out, "Reg# | Input      | Output     | Expected   | Status\n");
+        fprintf(out, "-----|------------|------------|------------|-------\n");
+        for (int i = 0; i < NUM_REGISTERS; i++) {
+            uint32_t expected = cl_top_alu_apply(st->alu_op, st->alu_operand, st->input[i]);
+            fprintf(out, "%2d   | 0x%08x | 0x%08x | 0x%08x | %s\n",
+                    i, st->input[i], st->output[i], expected,
+                    st->output[i] == expected ? "✅ PASS" : "❌ FAIL");
+        }
+        fprintf(out, "\nSUMMARY:\n");
+        fprintf(out, "  Correct results: %u/%d\n", r->value, NUM_REGISTERS);
+        fprintf(out, "  Accuracy: %u%%\n", (r->value * 100) / NUM_REGISTERS);
+        if (r->value == NUM_REGISTERS) {
+            fprintf(out, "🎉 ALL OUTPUTS CORRECT! Kernel operation working perfectly!\n");
+        } else {
+            fprintf(out, "💥 SOME OUTPUTS INCORRECT! Kernel operation has issues.\n");
+        }
+        break;
+
+    default:
+        cl_top_trace_prefix(out, st, r);
+        fprintf(out, "  Unknown event %u addr=0x%02x value=0x%08x\n", r->type, addr, r->value);
+        break;
+    }
+}
+
+// Render this thread's records from 'mark' up to the current head
+static inline void cl_top_trace_render_since(FILE *out, struct cl_top_trace_render *st,
+                                             uint64_t mark) {
+    struct cl_top_trace_ring *ring = cl_top_trace_self;
+    if (ring == NULL) {
+        return;
+    }
+    uint64_t head = ring->head;
+    if (head - mark > TRACE_RING_RECORDS) {
+        mark = head - TRACE_RING_RECORDS;
+    }
+    for (uint64_t i = mark; i < head; i++) {
+        cl_top_trace_render_rec(out, st, &ring->rec[i & (TRACE_RING_RECORDS - 1)]);
+    }
+}
+
+//-----------------------------------------------------------------------------
+// Trace file
+//-----------------------------------------------------------------------------
+
+// Write every ring to 'path'. Call once producers are quiescent.
+static inline int cl_top_trace_write_file(const char *path, double ticks_per_ns) {
+    struct cl_top_trace_file_hdr hdr = {0};
+    struct cl_top_trace_ring *ring;
+    FILE *fp = fopen(path, "wb");
+    if (fp == NULL) {
+        return -1;
+    }
+
+    hdr.magic = TRACE_FILE_MAGIC;
+    hdr.version = TRACE_FILE_VERSION;
+    hdr.rec_size = sizeof(struct cl_top_trace_rec);
+    hdr.ticks_per_ns = ticks_per_ns;
+    for (ring = __atomic_load_n(&cl_top_trace_rings, __ATOMIC_ACQUIRE); ring; ring = ring->next) {
+        hdr.num_threads++;
+    }
+    fwrite(&hdr, sizeof(hdr), 1, fp);
+
+    for (ring = __atomic_load_n(&cl_top_trace_rings, __ATOMIC_ACQUIRE); ring; ring = ring->next) {
+        struct cl_top_trace_thread th = {0};
+        uint64_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+        uint64_t first = head > TRACE_RING_RECORDS ? head - TRACE_RING_RECORDS : 0;
+
+        th.tid = ring->tid;
+        th.count = head - first;
+        fwrite(&th, sizeof(th), 1, fp);
+        for (uint64_t i = first; i < head; i++) {
+            fwrite(&ring->rec[i & (TRACE_RING_RECORDS - 1)], sizeof(struct cl_top_trace_rec), 1, fp);
+        }
+    }
+
+    // A short fwrite (e.g. ENOSPC) sets the error flag; report it on close
+    int err = ferror(fp);
+    if (fclose(fp) != 0 || err) {
+        return -1;
+    }
+    return 0;
+}
+
+#endif // CL_TOP_TRACE_H
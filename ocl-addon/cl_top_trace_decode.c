@@ -0,0 +1,93 @@
+/*
+ * Copyright 2015-2024 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Offline decoder for trace files written by cl_top_host -t <file>.
+// Prints the same step report the host prints at verbosity 1, per thread.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "cl_top_trace.h"
+
+int main(int argc, char **argv) {
+    struct cl_top_trace_file_hdr hdr;
+    bool timestamps = false;
+    FILE *fp;
+    int opt;
+    int rc = 0;
+
+    while ((opt = getopt(argc, argv, "T")) != -1) {
+        switch (opt) {
+        case 'T':
+            timestamps = true;
+            break;
+        default:
+            printf("Usage: %s [-T] trace_file\n", argv[0]);
+            return 1;
+        }
+    }
+    if (optind >= argc) {
+        printf("Usage: %s [-T] trace_file\n", argv[0]);
+        return 1;
+    }
+
+    fp = fopen(argv[optind], "rb");
+    if (fp == NULL) {
+        printf("ERROR: Unable to open %s\n", argv[optind]);
+        return 1;
+    }
+
+    if (fread(&hdr, sizeof(hdr), 1, fp) != 1 || hdr.magic != TRACE_FILE_MAGIC) {
+        printf("ERROR: %s is not a cl_top trace file\n", argv[optind]);
+        rc = 1;
+        goto cleanup;
+    }
+    if (hdr.version != TRACE_FILE_VERSION || hdr.rec_size != sizeof(struct cl_top_trace_rec)) {
+        printf("ERROR: Unsupported trace version %u (record size %u)\n", hdr.version, hdr.rec_size);
+        rc = 1;
+        goto cleanup;
+    }
+
+    for (uint32_t t = 0; t < hdr.num_threads; t++) {
+        struct cl_top_trace_thread th;
+        struct cl_top_trace_render render;
+
+        if (fread(&th, sizeof(th), 1, fp) != 1) {
+            printf("ERROR: Truncated trace file (thread %u header)\n", t);
+            rc = 1;
+            goto cleanup;
+        }
+
+        printf("\n##### Thread %u: %llu events #####\n", th.tid, (unsigned long long)th.count);
+        cl_top_trace_render_init(&render, hdr.ticks_per_ns, timestamps);
+        for (uint64_t i = 0; i < th.count; i++) {
+            struct cl_top_trace_rec rec;
+            if (fread(&rec, sizeof(rec), 1, fp) != 1) {
+                printf("ERROR: Truncated trace file (thread %u record %llu)\n",
+                       t, (unsigned long long)i);
+                rc = 1;
+                goto cleanup;
+            }
+            cl_top_trace_render_rec(stdout, &render, &rec);
+        }
+    }
+
+cleanup:
+    fclose(fp);
+    return rc;
+}